@@ -0,0 +1,520 @@
+/* Python module giving direct access to the threshold calculators.
+ *
+ * The input array is not copied: any object exporting a C contiguous
+ * buffer (NumPy arrays, array.array, memoryviews ...) is imported into
+ * an itk::Image in place, and the global interpreter lock is released
+ * while the histogram is built and the threshold computed, so several
+ * Python threads can threshold different images at the same time.
+ *
+ *   import histthresh
+ *   t = histthresh.threshold(a, "Li", bins=256)
+ *   m, t = histthresh.mask(a, "Otsu")
+ *
+ * mask() returns a uint8 array of the shape of the input, 1 above the
+ * threshold and 0 at or below it, as a NumPy view of the output buffer
+ * when NumPy is available and as a memoryview otherwise.
+ *
+ * Signed and unsigned integers of 1, 2, 4 and 8 bytes, float32 and
+ * float64 are accepted, in the byte order of the host only.
+ */
+#include <Python.h>
+
+#include "itkImportImageFilter.h"
+
+#include "itkHuangThresholdImageCalculator.h"
+#include "itkIntermodesThresholdImageCalculator.h"
+#include "itkIsoDataThresholdImageCalculator.h"
+#include "itkKittlerIllingworthThresholdImageCalculator.h"
+#include "itkLiThresholdImageCalculator.h"
+#include "itkMaxEntropyThresholdImageCalculator.h"
+#include "itkMomentsThresholdImageCalculator.h"
+#include "itkRenyiEntropyThresholdImageCalculator.h"
+#include "itkShanbhagThresholdImageCalculator.h"
+#include "itkTriangleThresholdImageCalculator.h"
+#include "itkYenThresholdImageCalculator.h"
+#include "itkMeanThresholdImageCalculator.h"
+#include "itkIJOtsuThresholdImageCalculator.h"
+#include "itkPercentileThresholdImageCalculator.h"
+#include "itkIJIsoDataThresholdImageCalculator.h"
+
+#include <cstring>
+#include <new>
+
+namespace
+{
+
+typedef enum { Huang, Intermodes, Minimum, IsoData, KittlerIllingworth, Li,
+               MaxEntropy, Moments, RenyiEntropy, Shanbhag, Triangle, Yen,
+               Mean, Otsu, Percentile, IJIsoData, NumberOfMethods } MethodType;
+
+const char * const MethodNames[] = {
+  "Huang", "Intermodes", "Minimum", "IsoData", "KittlerIllingworth", "Li",
+  "MaxEntropy", "Moments", "RenyiEntropy", "Shanbhag", "Triangle", "Yen",
+  "Mean", "Otsu", "Percentile", "IJIsoData" };
+
+struct Options
+{
+  MethodType    Method;
+  unsigned long NumberOfHistogramBins;
+  bool          UseExactHistogram;
+  bool          UseSparseHistogram;
+};
+
+/** Why ThresholdBuffer failed. Exceptions are caught without the GIL
+ * and only turned into Python exceptions once it is held again. The
+ * message is copied into a fixed buffer, which can't throw. */
+typedef enum { NoError, ITKError, MemoryError, OtherError } ErrorCodeType;
+
+struct ErrorType
+{
+  ErrorCodeType Code;
+  char          Message[256];
+
+  void Set(ErrorCodeType code, const char * message)
+  {
+    Code = code;
+    std::strncpy( Message, message, sizeof( Message ) - 1 );
+    Message[sizeof( Message ) - 1] = '\0';
+  }
+};
+
+template <class TCalculator>
+double RunCalculator(TCalculator * calculator,
+                     const typename TCalculator::ImageType * image,
+                     const Options & options)
+{
+  calculator->SetImage( image );
+  calculator->SetNumberOfHistogramBins( options.NumberOfHistogramBins );
+  calculator->SetUseExactHistogram( options.UseExactHistogram );
+  calculator->SetUseSparseHistogram( options.UseSparseHistogram );
+  calculator->Compute();
+  return calculator->GetThreshold();
+}
+
+#define histthreshCalculatorCase(method, name)                          \
+  case method:                                                          \
+    {                                                                   \
+    typename itk::name##ThresholdImageCalculator<TImage>::Pointer c =   \
+      itk::name##ThresholdImageCalculator<TImage>::New();               \
+    return RunCalculator( c.GetPointer(), image, options );             \
+    }
+
+template <class TImage>
+double ComputeThreshold(const TImage * image, const Options & options)
+{
+  switch ( options.Method )
+    {
+    histthreshCalculatorCase(Huang, Huang)
+    histthreshCalculatorCase(Intermodes, Intermodes)
+    case Minimum:
+      {
+      typename itk::IntermodesThresholdImageCalculator<TImage>::Pointer c =
+        itk::IntermodesThresholdImageCalculator<TImage>::New();
+      c->SetUseInterMode( false );
+      return RunCalculator( c.GetPointer(), image, options );
+      }
+    histthreshCalculatorCase(IsoData, IsoData)
+    histthreshCalculatorCase(KittlerIllingworth, KittlerIllingworth)
+    histthreshCalculatorCase(Li, Li)
+    histthreshCalculatorCase(MaxEntropy, MaxEntropy)
+    histthreshCalculatorCase(Moments, Moments)
+    histthreshCalculatorCase(RenyiEntropy, RenyiEntropy)
+    histthreshCalculatorCase(Shanbhag, Shanbhag)
+    histthreshCalculatorCase(Triangle, Triangle)
+    histthreshCalculatorCase(Yen, Yen)
+    histthreshCalculatorCase(Mean, Mean)
+    histthreshCalculatorCase(Otsu, IJOtsu)
+    histthreshCalculatorCase(Percentile, Percentile)
+    histthreshCalculatorCase(IJIsoData, IJIsoData)
+    default:
+      return 0;
+    }
+}
+
+#undef histthreshCalculatorCase
+
+/** Wrap the buffer in an image without copying it, compute the
+ * threshold and optionally write the mask, all without the GIL. No
+ * exception may leave this function: it is called between
+ * Py_BEGIN_ALLOW_THREADS and Py_END_ALLOW_THREADS. */
+template <class TPixel, unsigned int VDimension>
+bool ThresholdBuffer(const Py_buffer & view, const Options & options,
+                     unsigned char * mask, double & threshold,
+                     ErrorType & error)
+{
+  typedef itk::Image<TPixel, VDimension>             ImageType;
+  typedef itk::ImportImageFilter<TPixel, VDimension> ImporterType;
+
+  typename ImporterType::SizeType size;
+  typename ImporterType::IndexType start;
+  start.Fill( 0 );
+  unsigned long numberOfPixels = 1;
+  for ( unsigned int d = 0; d < VDimension; d++ )
+    {
+    // NumPy's last axis is the fastest varying, i.e. ITK's x
+    size[d] = view.shape[VDimension - 1 - d];
+    numberOfPixels *= size[d];
+    }
+  typename ImporterType::RegionType region;
+  region.SetIndex( start );
+  region.SetSize( size );
+
+  TPixel * buffer = static_cast<TPixel *>( view.buf );
+  try
+    {
+    typename ImporterType::Pointer importer = ImporterType::New();
+    importer->SetRegion( region );
+    importer->SetImportPointer( buffer, numberOfPixels, false );
+    importer->Update();
+
+    TPixel t = static_cast<TPixel>(
+      ComputeThreshold<ImageType>( importer->GetOutput(), options ) );
+    threshold = t;
+
+    if ( mask )
+      {
+      for ( unsigned long i = 0; i < numberOfPixels; i++ )
+        {
+        mask[i] = ( buffer[i] <= t ) ? 0 : 1;
+        }
+      }
+    }
+  catch ( itk::ExceptionObject & ex )
+    {
+    error.Set( ITKError, ex.GetDescription() );
+    return false;
+    }
+  catch ( std::bad_alloc & )
+    {
+    error.Set( MemoryError, "out of memory" );
+    return false;
+    }
+  catch ( std::exception & ex )
+    {
+    error.Set( OtherError, ex.what() );
+    return false;
+    }
+  catch ( ... )
+    {
+    error.Set( OtherError, "unknown exception" );
+    return false;
+    }
+  return true;
+}
+
+template <class TPixel>
+bool ThresholdBuffer(const Py_buffer & view, const Options & options,
+                     unsigned char * mask, double & threshold,
+                     ErrorType & error)
+{
+  switch ( view.ndim )
+    {
+    case 2:
+      return ThresholdBuffer<TPixel, 2>( view, options, mask, threshold, error );
+    case 3:
+      return ThresholdBuffer<TPixel, 3>( view, options, mask, threshold, error );
+    default:
+      error.Set( OtherError, "image must have 2 or 3 dimensions" );
+      return false;
+    }
+}
+
+typedef bool (*ThresholdFunctionType)(const Py_buffer &, const Options &,
+                                      unsigned char *, double &, ErrorType &);
+
+/** Skip the byte order prefix of a buffer format, and tell whether it
+ * is that of the host. */
+bool SkipNativeByteOrder(const char * & format)
+{
+  const unsigned short one = 1;
+  const bool littleEndian = *reinterpret_cast<const unsigned char *>( &one ) == 1;
+  switch ( *format )
+    {
+    case '@':
+    case '=':
+      format++;
+      return true;
+    case '<':
+      format++;
+      return littleEndian;
+    case '>':
+    case '!':
+      format++;
+      return !littleEndian;
+    default:
+      return true;
+    }
+}
+
+/** Pick the instantiation matching the buffer's item type. Integers are
+ * picked by their size rather than their letter: the size of 'l' is 4
+ * or 8 bytes depending on the platform and on the prefix. */
+ThresholdFunctionType GetThresholdFunction(const Py_buffer & view)
+{
+  const char * format = view.format ? view.format : "B";
+  if ( !SkipNativeByteOrder( format ) || std::strlen( format ) != 1 )
+    {
+    return 0;
+    }
+  const char code = *format;
+  if ( code == 'f' && view.itemsize == 4 )
+    {
+    return &ThresholdBuffer<float>;
+    }
+  if ( code == 'd' && view.itemsize == 8 )
+    {
+    return &ThresholdBuffer<double>;
+    }
+  if ( !std::strchr( "bBhHiIlLqQ", code ) )
+    {
+    return 0;
+    }
+  const bool isSigned = ( code >= 'a' && code <= 'z' );
+  switch ( view.itemsize )
+    {
+    case 1:
+      return isSigned ? &ThresholdBuffer<signed char> : &ThresholdBuffer<unsigned char>;
+    case 2:
+      return isSigned ? &ThresholdBuffer<short> : &ThresholdBuffer<unsigned short>;
+    case 4:
+      return isSigned ? &ThresholdBuffer<int> : &ThresholdBuffer<unsigned int>;
+    case 8:
+      return isSigned ? &ThresholdBuffer<long long> : &ThresholdBuffer<unsigned long long>;
+    default:
+      return 0;
+    }
+}
+
+/** Raise the Python exception of a failed ThresholdBuffer. The GIL
+ * must be held. */
+void SetError(const ErrorType & error)
+{
+  switch ( error.Code )
+    {
+    case MemoryError:
+      PyErr_NoMemory();
+      break;
+    case ITKError:
+    case OtherError:
+      PyErr_Format( PyExc_RuntimeError, "threshold computation failed: %s",
+                    error.Message );
+      break;
+    default:
+      PyErr_SetString( PyExc_RuntimeError, "threshold computation failed" );
+      break;
+    }
+}
+
+bool ParseArguments(PyObject * args, PyObject * kwds, Py_buffer & view,
+                    Options & options)
+{
+  static const char * keywords[] = { "image", "method", "bins", "exact",
+                                     "sparse", NULL };
+  PyObject * image = NULL;
+  const char * method = "Otsu";
+  unsigned long bins = 128;
+  int exact = 0, sparse = 0;
+
+  if ( !PyArg_ParseTupleAndKeywords( args, kwds, "O|skii",
+                                     const_cast<char **>( keywords ),
+                                     &image, &method, &bins, &exact, &sparse ) )
+    {
+    return false;
+    }
+
+  options.Method = NumberOfMethods;
+  for ( int m = 0; m < NumberOfMethods; m++ )
+    {
+    if ( std::strcmp( method, MethodNames[m] ) == 0 )
+      {
+      options.Method = static_cast<MethodType>( m );
+      }
+    }
+  if ( options.Method == NumberOfMethods )
+    {
+    PyErr_Format( PyExc_ValueError, "unknown threshold method '%s'", method );
+    return false;
+    }
+  if ( bins < 1 )
+    {
+    PyErr_SetString( PyExc_ValueError, "bins must be at least 1" );
+    return false;
+    }
+  options.NumberOfHistogramBins = bins;
+  options.UseExactHistogram = ( exact != 0 );
+  options.UseSparseHistogram = ( sparse != 0 );
+
+  if ( PyObject_GetBuffer( image, &view,
+                           PyBUF_C_CONTIGUOUS | PyBUF_FORMAT ) < 0 )
+    {
+    return false;
+    }
+  if ( view.ndim != 2 && view.ndim != 3 )
+    {
+    PyErr_SetString( PyExc_ValueError, "image must have 2 or 3 dimensions" );
+    PyBuffer_Release( &view );
+    return false;
+    }
+  const char * format = view.format ? view.format : "B";
+  if ( !SkipNativeByteOrder( format ) )
+    {
+    PyErr_Format( PyExc_ValueError,
+                  "pixel format '%s' is not in the byte order of the host",
+                  view.format );
+    PyBuffer_Release( &view );
+    return false;
+    }
+  if ( !GetThresholdFunction( view ) )
+    {
+    PyErr_Format( PyExc_TypeError, "unsupported pixel format '%s'",
+                  view.format ? view.format : "B" );
+    PyBuffer_Release( &view );
+    return false;
+    }
+  return true;
+}
+
+/** A uint8 array of the given shape over the bytes of the bytearray,
+ * without copying them. */
+PyObject * MakeMaskView(PyObject * bytes, const Py_buffer & view)
+{
+  PyObject * shape = PyTuple_New( view.ndim );
+  for ( int d = 0; d < view.ndim; d++ )
+    {
+    PyTuple_SET_ITEM( shape, d, PyLong_FromSsize_t( view.shape[d] ) );
+    }
+
+  PyObject * result = NULL;
+  PyObject * numpy = PyImport_ImportModule( "numpy" );
+  if ( numpy )
+    {
+    PyObject * flat = PyObject_CallMethod( numpy, "frombuffer", "Os",
+                                           bytes, "uint8" );
+    if ( flat )
+      {
+      result = PyObject_CallMethod( flat, "reshape", "O", shape );
+      Py_DECREF( flat );
+      }
+    Py_DECREF( numpy );
+    }
+  else
+    {
+    PyErr_Clear();
+    PyObject * memory = PyMemoryView_FromObject( bytes );
+    if ( memory )
+      {
+      result = PyObject_CallMethod( memory, "cast", "sO", "B", shape );
+      Py_DECREF( memory );
+      }
+    }
+  Py_DECREF( shape );
+  return result;
+}
+
+PyObject * histthresh_threshold(PyObject *, PyObject * args, PyObject * kwds)
+{
+  Py_buffer view;
+  Options options;
+  if ( !ParseArguments( args, kwds, view, options ) )
+    {
+    return NULL;
+    }
+
+  ThresholdFunctionType function = GetThresholdFunction( view );
+  double threshold = 0;
+  ErrorType error;
+  error.Set( NoError, "" );
+  bool ok;
+  Py_BEGIN_ALLOW_THREADS
+  ok = function( view, options, NULL, threshold, error );
+  Py_END_ALLOW_THREADS
+  PyBuffer_Release( &view );
+
+  if ( !ok )
+    {
+    SetError( error );
+    return NULL;
+    }
+  return PyFloat_FromDouble( threshold );
+}
+
+PyObject * histthresh_mask(PyObject *, PyObject * args, PyObject * kwds)
+{
+  Py_buffer view;
+  Options options;
+  if ( !ParseArguments( args, kwds, view, options ) )
+    {
+    return NULL;
+    }
+
+  Py_ssize_t numberOfPixels = view.len / view.itemsize;
+  PyObject * bytes = PyByteArray_FromStringAndSize( NULL, numberOfPixels );
+  if ( !bytes )
+    {
+    PyBuffer_Release( &view );
+    return NULL;
+    }
+  unsigned char * mask =
+    reinterpret_cast<unsigned char *>( PyByteArray_AS_STRING( bytes ) );
+
+  ThresholdFunctionType function = GetThresholdFunction( view );
+  double threshold = 0;
+  ErrorType error;
+  error.Set( NoError, "" );
+  bool ok;
+  Py_BEGIN_ALLOW_THREADS
+  ok = function( view, options, mask, threshold, error );
+  Py_END_ALLOW_THREADS
+
+  PyObject * result = NULL;
+  if ( !ok )
+    {
+    SetError( error );
+    }
+  else
+    {
+    PyObject * maskView = MakeMaskView( bytes, view );
+    if ( maskView )
+      {
+      result = Py_BuildValue( "(Nd)", maskView, threshold );
+      }
+    }
+  Py_DECREF( bytes );
+  PyBuffer_Release( &view );
+  return result;
+}
+
+PyObject * histthresh_methods(PyObject *, PyObject *)
+{
+  PyObject * names = PyTuple_New( NumberOfMethods );
+  for ( int m = 0; m < NumberOfMethods; m++ )
+    {
+    PyTuple_SET_ITEM( names, m, PyUnicode_FromString( MethodNames[m] ) );
+    }
+  return names;
+}
+
+PyMethodDef HistThreshMethods[] = {
+  { "threshold", (PyCFunction) histthresh_threshold, METH_VARARGS | METH_KEYWORDS,
+    "threshold(image, method='Otsu', bins=128, exact=0, sparse=0) -> float\n\n"
+    "Compute the threshold of a 2D or 3D array without copying it." },
+  { "mask", (PyCFunction) histthresh_mask, METH_VARARGS | METH_KEYWORDS,
+    "mask(image, method='Otsu', bins=128, exact=0, sparse=0) -> (mask, threshold)\n\n"
+    "Threshold a 2D or 3D array. The mask is 1 above the threshold." },
+  { "methods", (PyCFunction) histthresh_methods, METH_NOARGS,
+    "methods() -> tuple of the method names" },
+  { NULL, NULL, 0, NULL }
+};
+
+struct PyModuleDef HistThreshModule = {
+  PyModuleDef_HEAD_INIT, "histthresh",
+  "Histogram threshold calculators for arrays.", -1, HistThreshMethods,
+  NULL, NULL, NULL, NULL
+};
+
+} // end anonymous namespace
+
+PyMODINIT_FUNC PyInit_histthresh(void)
+{
+  return PyModule_Create( &HistThreshModule );
+}
@@ -0,0 +1,98 @@
+# Threshold NumPy arrays of several dtypes with the histthresh module
+# and compare with thresholdImage, i.e. the C++ filters, on the same
+# pixels written as MetaImage files.
+#
+#   python testHistThresh.py moduledir thresholdImage workdir
+
+import os
+import subprocess
+import sys
+
+import numpy
+
+sys.path.insert(0, sys.argv[1])
+import histthresh
+
+thresholdImage = sys.argv[2]
+workdir = sys.argv[3]
+if not os.path.isdir(workdir):
+    os.makedirs(workdir)
+
+metaTypes = {'uint8': 'MET_UCHAR', 'int16': 'MET_SHORT',
+             'uint16': 'MET_USHORT', 'float32': 'MET_FLOAT'}
+
+
+def writeMeta(array, name):
+    """Write the array as a little endian MetaImage, x being the last axis."""
+    header = os.path.join(workdir, name + '.mhd')
+    with open(header, 'w') as out:
+        out.write('ObjectType = Image\n')
+        out.write('NDims = %d\n' % array.ndim)
+        out.write('DimSize = %s\n' % ' '.join(str(n) for n in reversed(array.shape)))
+        out.write('ElementType = %s\n' % metaTypes[array.dtype.name])
+        out.write('ElementByteOrderMSB = False\n')
+        out.write('ElementDataFile = %s.raw\n' % name)
+    array.astype(array.dtype.newbyteorder('<')).tofile(os.path.join(workdir, name + '.raw'))
+    return header
+
+
+def cxxThreshold(array, method, name):
+    """The threshold printed by thresholdImage on the array."""
+    header = writeMeta(array, name)
+    output = subprocess.check_output(
+        [thresholdImage, header, os.path.join(workdir, name + '-mask.mha'), method])
+    return float(output.decode().strip().rsplit(':', 1)[1])
+
+
+# two populations of integer values, some of them below 0 when signed
+random = numpy.random.RandomState(12345)
+shape = (40, 64)
+pixels = numpy.where(random.rand(*shape) < 0.4,
+                     random.normal(800, 120, shape),
+                     random.normal(2400, 300, shape))
+pixels = numpy.clip(numpy.round(pixels), 0, 4000)
+
+ok = True
+for method in ['Li', 'Otsu', 'Huang']:
+    cxxMethod = 'IJOtsu' if method == 'Otsu' else method
+    # the types thresholdImage reads as they are
+    expected = {}
+    for dtype in ['uint16', 'int16', 'float32']:
+        array = pixels.astype(dtype)
+        expected[dtype] = cxxThreshold(array, cxxMethod, dtype)
+        found = histthresh.threshold(array, method)
+        if abs(found - expected[dtype]) > 1e-4 * (1 + abs(expected[dtype])):
+            print('%s %s: %g, thresholdImage %g' % (method, dtype, found, expected[dtype]))
+            ok = False
+    byte = (pixels / 16).astype('uint8')
+    expected['uint8'] = cxxThreshold(byte, cxxMethod, 'uint8')
+    if histthresh.threshold(byte, method) != expected['uint8']:
+        print('%s uint8: %g, thresholdImage %g'
+              % (method, histthresh.threshold(byte, method), expected['uint8']))
+        ok = False
+
+    # the other integer types, NumPy's default among them, histogram
+    # the same values as int16
+    for dtype in ['int8', 'int32', 'uint32', 'int64', 'uint64', int]:
+        array = (byte // 2).astype(dtype) if dtype == 'int8' else pixels.astype(dtype)
+        reference = histthresh.threshold((byte // 2).astype('int16'), method) \
+            if dtype == 'int8' else expected['int16']
+        found = histthresh.threshold(array, method)
+        mask, threshold = histthresh.mask(array, method)
+        if found != reference or threshold != found or \
+           not numpy.array_equal(mask, (array > found).astype('uint8')):
+            print('%s %s: %g, int16 %g' % (method, numpy.dtype(dtype).name, found, reference))
+            ok = False
+
+# arrays in the other byte order are refused
+swapped = pixels.astype('int16')
+swapped = swapped.astype(swapped.dtype.newbyteorder('S'))
+try:
+    histthresh.threshold(swapped, 'Li')
+    print('byte swapped array accepted')
+    ok = False
+except ValueError:
+    pass
+
+print('histthresh agrees with thresholdImage' if ok else 'histthresh differs from thresholdImage')
+sys.exit(0 if ok else 1)
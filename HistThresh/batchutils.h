@@ -0,0 +1,357 @@
+#ifndef __batchutils_h_
+#define __batchutils_h_
+
+// Pipelined batch processing of image files. Reader, compute and
+// writer threads are connected by bounded queues, so that the next
+// images are read and the previous results written while the current
+// ones are processed. Each stage has its own pool of threads.
+
+#include "ioutils.h"
+
+#include <itkMultiThreader.h>
+#include <itkSimpleFastMutexLock.h>
+#include <itkConditionVariable.h>
+#include <itkRealTimeClock.h>
+#include <itkObjectFactoryBase.h>
+
+#include <deque>
+#include <vector>
+#include <string>
+#include <iostream>
+
+// A fixed capacity queue shared by a set of producer and consumer
+// threads. Push blocks while the queue is full, Pop while it is
+// empty. Once the last producer has called Close, Pop returns false
+// when the queue has been drained.
+template <class T>
+class BatchQueue
+{
+public:
+  BatchQueue(unsigned capacity, unsigned producers) :
+    m_Capacity(capacity), m_Producers(producers)
+  {
+    m_NotEmpty = itk::ConditionVariable::New();
+    m_NotFull = itk::ConditionVariable::New();
+  }
+
+  void Push(const T & item)
+  {
+    m_Lock.Lock();
+    while (m_Items.size() >= m_Capacity)
+      {
+      m_NotFull->Wait(&m_Lock);
+      }
+    m_Items.push_back(item);
+    m_NotEmpty->Signal();
+    m_Lock.Unlock();
+  }
+
+  bool Pop(T & item)
+  {
+    m_Lock.Lock();
+    while (m_Items.empty() && m_Producers > 0)
+      {
+      m_NotEmpty->Wait(&m_Lock);
+      }
+    bool ok = !m_Items.empty();
+    if (ok)
+      {
+      item = m_Items.front();
+      m_Items.pop_front();
+      m_NotFull->Signal();
+      }
+    m_Lock.Unlock();
+    return ok;
+  }
+
+  void Close()
+  {
+    m_Lock.Lock();
+    if (m_Producers > 0 && --m_Producers == 0)
+      {
+      m_NotEmpty->Broadcast();
+      }
+    m_Lock.Unlock();
+  }
+
+private:
+  BatchQueue(const BatchQueue &); //purposely not implemented
+  void operator=(const BatchQueue &); //purposely not implemented
+
+  itk::SimpleMutexLock               m_Lock;
+  itk::ConditionVariable::Pointer    m_NotEmpty;
+  itk::ConditionVariable::Pointer    m_NotFull;
+  std::deque<T>                      m_Items;
+  unsigned                           m_Capacity;
+  unsigned                           m_Producers;
+};
+
+// Thread counts and queue depth of a batch run. A queue depth of 0
+// uses twice the number of compute threads.
+struct BatchOptions
+{
+  BatchOptions() : Readers(1), Computers(1), Writers(1), QueueDepth(0) {}
+  unsigned Readers;
+  unsigned Computers;
+  unsigned Writers;
+  unsigned QueueDepth;
+};
+
+// Work done by one stage of a batch run. Busy is the time summed over
+// the threads of the stage, so Items/Busy is the rate of one thread.
+struct BatchStageStatistics
+{
+  BatchStageStatistics() : Items(0), Failures(0), Busy(0.0) {}
+  unsigned long Items;
+  unsigned long Failures;
+  double        Busy;
+};
+
+struct BatchStatistics
+{
+  BatchStageStatistics Read;
+  BatchStageStatistics Compute;
+  BatchStageStatistics Write;
+  double               Elapsed;
+};
+
+void printBatchStatistics(const BatchStatistics & stats, std::ostream & os)
+{
+  const char * names[3] = { "read", "compute", "write" };
+  const BatchStageStatistics * stages[3] = { &stats.Read, &stats.Compute, &stats.Write };
+  os << "elapsed " << stats.Elapsed << " s" << std::endl;
+  for (int s = 0; s < 3; s++)
+    {
+    os << names[s] << ": " << stages[s]->Items << " images, "
+       << stages[s]->Failures << " failed, busy " << stages[s]->Busy << " s";
+    if (stats.Elapsed > 0)
+      {
+      os << ", " << stages[s]->Items / stats.Elapsed << " images/s";
+      }
+    if (stages[s]->Busy > 0)
+      {
+      os << ", " << stages[s]->Items / stages[s]->Busy << " images/s per thread";
+      }
+    os << std::endl;
+    }
+}
+
+// Shared state of a run. TCompute is a functor turning an input image
+// into an output image; it must be safe to call from several threads.
+template <class TInputImage, class TOutputImage, class TCompute>
+class BatchPipeline
+{
+public:
+  typedef typename TInputImage::Pointer  InputPointer;
+  typedef typename TOutputImage::Pointer OutputPointer;
+
+  struct InputItem  { unsigned long Index; InputPointer Image; };
+  struct OutputItem { unsigned long Index; OutputPointer Image; };
+
+  BatchPipeline(const std::vector<std::string> & inputs,
+                const std::vector<std::string> & outputs,
+                const TCompute & compute, const BatchOptions & options,
+                unsigned queueDepth) :
+    m_Inputs(inputs), m_Outputs(outputs), m_Compute(compute),
+    m_Options(options), m_Next(0),
+    m_ReadQueue(queueDepth, options.Readers),
+    m_WriteQueue(queueDepth, options.Computers)
+  {
+    m_Clock = itk::RealTimeClock::New();
+  }
+
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback(void * arg)
+  {
+    itk::MultiThreader::ThreadInfoStruct * info =
+      static_cast<itk::MultiThreader::ThreadInfoStruct *>(arg);
+    BatchPipeline * self = static_cast<BatchPipeline *>(info->UserData);
+    unsigned id = info->ThreadID;
+    if (id < self->m_Options.Readers)
+      {
+      self->ReadStage();
+      }
+    else if (id < self->m_Options.Readers + self->m_Options.Computers)
+      {
+      self->ComputeStage();
+      }
+    else
+      {
+      self->WriteStage();
+      }
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+  BatchStatistics m_Stats;
+
+private:
+  void Account(BatchStageStatistics & stage, bool ok, double start)
+  {
+    double busy = m_Clock->GetTimeStamp() - start;
+    m_StatsLock.Lock();
+    if (ok)
+      {
+      stage.Items++;
+      }
+    else
+      {
+      stage.Failures++;
+      }
+    stage.Busy += busy;
+    m_StatsLock.Unlock();
+  }
+
+  // As readIm(), but reporting under the lock, as the other stages do.
+  InputPointer ReadInput(unsigned long index)
+  {
+    typedef itk::ImageFileReader<TInputImage> ReaderType;
+    typename ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName(m_Inputs[index].c_str());
+    InputPointer image = reader->GetOutput();
+    try
+      {
+      image->Update();
+      }
+    catch(itk::ExceptionObject &ex)
+      {
+      m_StatsLock.Lock();
+      std::cout << ex << std::endl;
+      std::cout << m_Inputs[index] << std::endl;
+      m_StatsLock.Unlock();
+      return 0;
+      }
+    image->DisconnectPipeline();
+    return image;
+  }
+
+  void ReadStage()
+  {
+    for (;;)
+      {
+      m_StatsLock.Lock();
+      unsigned long index = m_Next++;
+      m_StatsLock.Unlock();
+      if (index >= m_Inputs.size())
+        {
+        break;
+        }
+      double start = m_Clock->GetTimeStamp();
+      InputItem item;
+      item.Index = index;
+      item.Image = ReadInput(index);
+      Account(m_Stats.Read, item.Image.IsNotNull(), start);
+      if (item.Image.IsNotNull())
+        {
+        m_ReadQueue.Push(item);
+        }
+      }
+    m_ReadQueue.Close();
+  }
+
+  void ComputeStage()
+  {
+    InputItem in;
+    while (m_ReadQueue.Pop(in))
+      {
+      double start = m_Clock->GetTimeStamp();
+      OutputItem out;
+      out.Index = in.Index;
+      try
+        {
+        out.Image = m_Compute(in.Image);
+        }
+      catch(itk::ExceptionObject &ex)
+        {
+        m_StatsLock.Lock();
+        std::cout << ex << std::endl;
+        std::cout << m_Inputs[in.Index] << std::endl;
+        m_StatsLock.Unlock();
+        }
+      in.Image = 0;
+      Account(m_Stats.Compute, out.Image.IsNotNull(), start);
+      if (out.Image.IsNotNull())
+        {
+        m_WriteQueue.Push(out);
+        }
+      }
+    m_WriteQueue.Close();
+  }
+
+  void WriteStage()
+  {
+    OutputItem out;
+    while (m_WriteQueue.Pop(out))
+      {
+      double start = m_Clock->GetTimeStamp();
+      bool ok = true;
+      try
+        {
+        writeIm<TOutputImage>(out.Image, m_Outputs[out.Index]);
+        }
+      catch(itk::ExceptionObject &ex)
+        {
+        m_StatsLock.Lock();
+        std::cout << ex << std::endl;
+        std::cout << m_Outputs[out.Index] << std::endl;
+        m_StatsLock.Unlock();
+        ok = false;
+        }
+      out.Image = 0;
+      Account(m_Stats.Write, ok, start);
+      }
+  }
+
+  const std::vector<std::string> & m_Inputs;
+  const std::vector<std::string> & m_Outputs;
+  const TCompute &                 m_Compute;
+  BatchOptions                     m_Options;
+  unsigned long                    m_Next;
+  itk::SimpleFastMutexLock         m_StatsLock;
+  itk::RealTimeClock::Pointer      m_Clock;
+  BatchQueue<InputItem>            m_ReadQueue;
+  BatchQueue<OutputItem>           m_WriteQueue;
+};
+
+// Read each of the inputs, apply compute to it and write the result
+// to the matching output, overlapping the three stages. Images that
+// fail to read, compute or write are reported and skipped.
+template <class TInputImage, class TOutputImage, class TCompute>
+BatchStatistics batchProcess(const std::vector<std::string> & inputs,
+                             const std::vector<std::string> & outputs,
+                             const TCompute & compute,
+                             BatchOptions options = BatchOptions())
+{
+  if (options.Readers < 1) options.Readers = 1;
+  if (options.Computers < 1) options.Computers = 1;
+  if (options.Writers < 1) options.Writers = 1;
+  unsigned queueDepth = options.QueueDepth;
+  if (queueDepth < 1)
+    {
+    queueDepth = 2 * options.Computers;
+    }
+
+  // the factories are loaded lazily, which is not thread safe
+  itk::ObjectFactoryBase::GetRegisteredFactories();
+
+  typedef BatchPipeline<TInputImage, TOutputImage, TCompute> PipelineType;
+  PipelineType pipeline(inputs, outputs, compute, options, queueDepth);
+
+  itk::RealTimeClock::Pointer clock = itk::RealTimeClock::New();
+  double start = clock->GetTimeStamp();
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  const unsigned threads = options.Readers + options.Computers + options.Writers;
+  threader->SetNumberOfThreads(threads);
+  if (static_cast<unsigned>(threader->GetNumberOfThreads()) != threads)
+    {
+    // every stage needs its threads, or the queues would never drain
+    itkGenericExceptionMacro(<< "Can't run " << threads << " threads, the maximum is "
+                             << threader->GetNumberOfThreads());
+    }
+  threader->SetSingleMethod(PipelineType::ThreaderCallback, &pipeline);
+  threader->SingleMethodExecute();
+
+  pipeline.m_Stats.Elapsed = clock->GetTimeStamp() - start;
+  return pipeline.m_Stats;
+}
+
+#endif
@@ -0,0 +1,31 @@
+// The global vector of filters used by the lazy helpers in
+// morphutils.h and rjbutilities.h.
+//
+// The lazy helpers return the output of a filter without updating it,
+// so that several of them can be chained and the whole chain updated,
+// streamed or threaded in one go. An output only holds a weak pointer
+// to its source, so the filters are kept here until the chain has been
+// updated, after which clearStack() releases them.
+#ifndef __filterstack_h
+#define __filterstack_h
+
+#include <itkProcessObject.h>
+#include <vector>
+
+inline std::vector<itk::ProcessObject::Pointer> & filterStack()
+{
+  static std::vector<itk::ProcessObject::Pointer> stack;
+  return stack;
+}
+
+inline void AddToStack(itk::ProcessObject * filt)
+{
+  filterStack().push_back(filt);
+}
+
+inline void clearStack()
+{
+  filterStack().clear();
+}
+
+#endif
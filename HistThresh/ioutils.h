@@ -8,6 +8,7 @@
 #include <itkNumericTraits.h>
 #include <itkOrientImageFilter.h>
 #include <itkSpatialOrientation.h>
+#include <cstdlib>
 
 int readImageInfo(std::string filename, itk::ImageIOBase::IOComponentType *ComponentType, int *dim)
 {
@@ -24,6 +25,54 @@ int readImageInfo(std::string filename, itk::ImageIOBase::IOComponentType *Compo
   return(1);
 }
 
+// Call processor.Run<TImage>(filename) with the image type matching
+// the pixels of the file, so that they are processed without being
+// converted to float first. 2, 3 and 4 dimensional images of unsigned
+// char, short, unsigned short and float are handled as they are, the
+// other component types are read as float. Returns EXIT_FAILURE when
+// the file can't be read or has another dimension, and what Run()
+// returns otherwise.
+template <class TProcessor, unsigned VDimension>
+int dispatchComponent(itk::ImageIOBase::IOComponentType ComponentType,
+                      std::string filename, TProcessor &processor)
+{
+  switch (ComponentType)
+    {
+    case itk::ImageIOBase::UCHAR:
+      return processor.template Run<itk::Image<unsigned char, VDimension> >(filename);
+    case itk::ImageIOBase::SHORT:
+      return processor.template Run<itk::Image<short, VDimension> >(filename);
+    case itk::ImageIOBase::USHORT:
+      return processor.template Run<itk::Image<unsigned short, VDimension> >(filename);
+    default:
+      return processor.template Run<itk::Image<float, VDimension> >(filename);
+    }
+}
+
+template <class TProcessor>
+int dispatchImage(std::string filename, TProcessor &processor)
+{
+  itk::ImageIOBase::IOComponentType ComponentType;
+  int dim;
+  if (!readImageInfo(filename, &ComponentType, &dim))
+    {
+    std::cerr << "Can't read " << filename << std::endl;
+    return EXIT_FAILURE;
+    }
+  switch (dim)
+    {
+    case 2:
+      return dispatchComponent<TProcessor, 2>(ComponentType, filename, processor);
+    case 3:
+      return dispatchComponent<TProcessor, 3>(ComponentType, filename, processor);
+    case 4:
+      return dispatchComponent<TProcessor, 4>(ComponentType, filename, processor);
+    default:
+      std::cerr << "Unsupported dimension " << dim << " in " << filename << std::endl;
+      return EXIT_FAILURE;
+    }
+}
+
 
 template <class TImage>
 void writeIm(typename TImage::Pointer Im, std::string filename)
@@ -35,6 +84,22 @@ void writeIm(typename TImage::Pointer Im, std::string filename)
   writer->Update();
 }
 
+// Write an image in divisions pieces. Im is usually the output of a
+// chain of Lazy helpers, which is then updated one piece at a time
+// when the file format supports it. Filters needing the whole input,
+// such as the histogram threshold filters, still read all of it, but
+// those compute their threshold once and reuse it for the other pieces.
+template <class TImage>
+void streamIm(typename TImage::Pointer Im, std::string filename, unsigned divisions)
+{
+  typedef typename itk::ImageFileWriter<TImage> WriterType;
+  typename WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(Im);
+  writer->SetFileName(filename.c_str());
+  writer->SetNumberOfStreamDivisions(divisions);
+  writer->Update();
+}
+
 template <class TImage, class PixType>
 void writeImScale(typename TImage::Pointer Im, std::string filename)
 {
@@ -87,6 +152,9 @@ typename TImage::Pointer readIm(std::string filename)
     return(result);
 }
 
+// Read the image and permute and flip its axes to the given
+// orientation. To threshold an image in some orientation, use
+// thresholdImOriented() instead.
 template <class TImage>
 typename TImage::Pointer readImOriented(std::string filename, itk::SpatialOrientation::ValidCoordinateOrientationFlags direction)
 {
@@ -114,5 +182,65 @@ typename TImage::Pointer readImOriented(std::string filename, itk::SpatialOrient
     return(result);
 }
 
+// Permute and flip the axes of an image in memory to the given
+// orientation.
+template <class TImage>
+typename TImage::Pointer orientIm(typename TImage::Pointer image, itk::SpatialOrientation::ValidCoordinateOrientationFlags direction)
+{
+  typedef typename itk::OrientImageFilter<TImage, TImage> ReorientType;
+  typename ReorientType::Pointer reorient = ReorientType::New();
+  reorient->SetInput(image);
+  reorient->UseImageDirectionOn();
+  reorient->SetDesiredCoordinateOrientation(direction);
+  typename TImage::Pointer result = reorient->GetOutput();
+
+  try
+    {
+    result->Update();
+    }
+  catch(itk::ExceptionObject &ex)
+    {
+    std::cout << ex << std::endl;
+    return 0;
+    }
+    result->DisconnectPipeline();
+    return(result);
+}
+
+// Threshold the image of the file with the filter, and return the mask
+// in the given orientation. The image is thresholded as it lies in the
+// file and only the mask is reoriented, without a permuted copy of the
+// image. The histogram doesn't depend on the order of the axes, so this
+// is the same mask as thresholding readImOriented(), except with
+// AutomaticBackgroundValue or ClipHistogramRange on: both sample the
+// pixels in memory order, and may pick another background or range,
+// hence another threshold. The threshold is left in the filter.
+template <class TFilter>
+typename TFilter::OutputImageType::Pointer thresholdImOriented(std::string filename, itk::SpatialOrientation::ValidCoordinateOrientationFlags direction, TFilter *filter)
+{
+  typedef typename TFilter::InputImageType InputImageType;
+  typedef typename TFilter::OutputImageType OutputImageType;
+  typename InputImageType::Pointer raw = readIm<InputImageType>(filename);
+  if (!raw)
+    {
+    return 0;
+    }
+  filter->SetInput(raw);
+  typename OutputImageType::Pointer mask = filter->GetOutput();
+
+  try
+    {
+    mask->Update();
+    }
+  catch(itk::ExceptionObject &ex)
+    {
+    std::cout << ex << std::endl;
+    std::cout << filename << std::endl;
+    return 0;
+    }
+    mask->DisconnectPipeline();
+    return orientIm<OutputImageType>(mask, direction);
+}
+
 
 #endif
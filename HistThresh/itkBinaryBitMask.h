@@ -0,0 +1,147 @@
+#ifndef __itkBinaryBitMask_h
+#define __itkBinaryBitMask_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkImage.h"
+#include <vector>
+
+namespace itk
+{
+
+/** \class BinaryBitMask
+ * \brief Binary mask storing one bit per voxel.
+ *
+ * A mask over a region, packed in 32 bit words. Each row along the
+ * first axis starts on a new word, so that rows can be written a word
+ * at a time. Bit k of word w of a row is the voxel at position
+ * 32 * w + k along the row.
+ *
+ * The mask takes an eighth of the memory of an unsigned char image,
+ * which is what matters for the very large masks of steps that only
+ * test membership. GetImage() converts the mask to a standard image,
+ * with OnValue where the bit is set and OffValue elsewhere, when
+ * another filter needs one. The image is made on the first call and
+ * kept until the mask is modified. Writers going through GetRow()
+ * must call Modified() when they are done.
+ *
+ * \sa HistogramThresholdImageFilter
+ * \ingroup DataRepresentation
+ */
+template <unsigned int VDimension>
+class ITK_EXPORT BinaryBitMask : public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef BinaryBitMask             Self;
+  typedef Object                    Superclass;
+  typedef SmartPointer<Self>        Pointer;
+  typedef SmartPointer<const Self>  ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(BinaryBitMask, Object);
+
+  itkStaticConstMacro(ImageDimension, unsigned int, VDimension);
+
+  /** Word the bits are packed in. */
+  typedef unsigned int WordType;
+  itkStaticConstMacro(BitsPerWord, unsigned int, 32);
+
+  /** Image the mask converts to. */
+  typedef Image<unsigned char, VDimension>  ImageType;
+  typedef typename ImageType::Pointer       ImagePointer;
+  typedef typename ImageType::RegionType    RegionType;
+  typedef typename ImageType::IndexType     IndexType;
+  typedef typename ImageType::SizeType      SizeType;
+  typedef typename ImageType::SpacingType   SpacingType;
+  typedef typename ImageType::PointType     PointType;
+  typedef typename ImageType::DirectionType DirectionType;
+
+  /** Set/Get the region covered by the mask. Allocate() must be
+   * called after changing it. */
+  itkSetMacro(Region, RegionType);
+  itkGetConstReferenceMacro(Region, RegionType);
+
+  /** Get the geometry passed on to the converted image. */
+  itkGetConstReferenceMacro(Spacing, SpacingType);
+  itkGetConstReferenceMacro(Origin, PointType);
+  itkGetConstReferenceMacro(Direction, DirectionType);
+
+  /** Take the requested region and the geometry of an image. */
+  template <class TImage>
+  void CopyInformation(const TImage * image)
+    {
+    m_Region = image->GetRequestedRegion();
+    m_Spacing = image->GetSpacing();
+    m_Origin = image->GetOrigin();
+    m_Direction = image->GetDirection();
+    this->Modified();
+    }
+
+  /** Set/Get the values of the converted image. Defaults are 1 for set
+   * bits and 0 for the others. */
+  itkSetMacro(OnValue, unsigned char);
+  itkGetConstMacro(OnValue, unsigned char);
+  itkSetMacro(OffValue, unsigned char);
+  itkGetConstMacro(OffValue, unsigned char);
+
+  /** Allocate the words of the region, with every bit cleared. */
+  void Allocate();
+
+  /** Number of words of a row. */
+  unsigned long GetWordsPerRow() const
+    { return ( m_Region.GetSize()[0] + BitsPerWord - 1 ) / BitsPerWord; }
+
+  /** Words of the row holding index. index[0] is ignored. */
+  WordType * GetRow(const IndexType & index)
+    { return &m_Buffer[this->ComputeRowOffset(index)]; }
+  const WordType * GetRow(const IndexType & index) const
+    { return &m_Buffer[this->ComputeRowOffset(index)]; }
+
+  /** Get/Set the bit of a voxel. */
+  bool GetBit(const IndexType & index) const;
+  void SetBit(const IndexType & index, bool value);
+
+  /** Number of set bits. */
+  unsigned long GetNumberOfSetBits() const;
+
+  /** Size of the packed words in bytes. */
+  unsigned long GetBufferSize() const
+    { return m_Buffer.size() * sizeof(WordType); }
+
+  /** The mask as a standard image, converted when the mask has
+   * changed since the last call. */
+  ImageType * GetImage();
+
+protected:
+  BinaryBitMask();
+  virtual ~BinaryBitMask() {};
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  unsigned long ComputeRowOffset(const IndexType & index) const;
+
+private:
+  BinaryBitMask(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  RegionType              m_Region;
+  SpacingType             m_Spacing;
+  PointType               m_Origin;
+  DirectionType           m_Direction;
+  unsigned char           m_OnValue;
+  unsigned char           m_OffValue;
+  std::vector<WordType>   m_Buffer;
+  ImagePointer            m_Image;
+  unsigned long           m_ImageMTime;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkBinaryBitMask.txx"
+#endif
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef __itkBinaryBitMask_txx
+#define __itkBinaryBitMask_txx
+
+#include "itkBinaryBitMask.h"
+#include "itkImageLinearIteratorWithIndex.h"
+
+namespace itk
+{
+
+template <unsigned int VDimension>
+BinaryBitMask<VDimension>
+::BinaryBitMask()
+{
+  m_Spacing.Fill( 1.0 );
+  m_Origin.Fill( 0.0 );
+  m_Direction.SetIdentity();
+  m_OnValue = 1;
+  m_OffValue = 0;
+  m_ImageMTime = 0;
+}
+
+template <unsigned int VDimension>
+void
+BinaryBitMask<VDimension>
+::Allocate()
+{
+  const unsigned long rows = m_Region.GetSize()[0] > 0 ?
+    m_Region.GetNumberOfPixels() / m_Region.GetSize()[0] : 0;
+  m_Buffer.assign( rows * this->GetWordsPerRow(), 0 );
+  this->Modified();
+}
+
+template <unsigned int VDimension>
+unsigned long
+BinaryBitMask<VDimension>
+::ComputeRowOffset(const IndexType & index) const
+{
+  unsigned long row = 0;
+  unsigned long stride = 1;
+  for ( unsigned int d = 1; d < VDimension; d++ )
+    {
+    row += ( index[d] - m_Region.GetIndex()[d] ) * stride;
+    stride *= m_Region.GetSize()[d];
+    }
+  return row * this->GetWordsPerRow();
+}
+
+template <unsigned int VDimension>
+bool
+BinaryBitMask<VDimension>
+::GetBit(const IndexType & index) const
+{
+  const unsigned long x = index[0] - m_Region.GetIndex()[0];
+  return ( this->GetRow( index )[x / BitsPerWord] >> ( x % BitsPerWord ) ) & 1;
+}
+
+template <unsigned int VDimension>
+void
+BinaryBitMask<VDimension>
+::SetBit(const IndexType & index, bool value)
+{
+  const unsigned long x = index[0] - m_Region.GetIndex()[0];
+  WordType & word = this->GetRow( index )[x / BitsPerWord];
+  const WordType bit = WordType( 1 ) << ( x % BitsPerWord );
+  word = value ? ( word | bit ) : ( word & ~bit );
+  this->Modified();
+}
+
+template <unsigned int VDimension>
+unsigned long
+BinaryBitMask<VDimension>
+::GetNumberOfSetBits() const
+{
+  // the bits past the end of the rows are never set
+  unsigned long count = 0;
+  for ( unsigned long w = 0; w < m_Buffer.size(); w++ )
+    {
+    WordType word = m_Buffer[w];
+    while ( word )
+      {
+      word &= word - 1;
+      count++;
+      }
+    }
+  return count;
+}
+
+template <unsigned int VDimension>
+typename BinaryBitMask<VDimension>::ImageType *
+BinaryBitMask<VDimension>
+::GetImage()
+{
+  if ( m_Image && m_ImageMTime >= this->GetMTime() )
+    {
+    return m_Image.GetPointer();
+    }
+
+  m_Image = ImageType::New();
+  m_Image->SetRegions( m_Region );
+  m_Image->SetSpacing( m_Spacing );
+  m_Image->SetOrigin( m_Origin );
+  m_Image->SetDirection( m_Direction );
+  m_Image->Allocate();
+
+  const unsigned long rowLength = m_Region.GetSize()[0];
+  ImageLinearIteratorWithIndex<ImageType> it( m_Image, m_Region );
+  it.SetDirection( 0 );
+  it.GoToBegin();
+  while ( !it.IsAtEnd() )
+    {
+    const WordType * row = this->GetRow( it.GetIndex() );
+    unsigned char * out =
+      m_Image->GetBufferPointer() + m_Image->ComputeOffset( it.GetIndex() );
+    for ( unsigned long x = 0; x < rowLength; x++ )
+      {
+      out[x] = ( ( row[x / BitsPerWord] >> ( x % BitsPerWord ) ) & 1 ) ?
+        m_OnValue : m_OffValue;
+      }
+    it.NextLine();
+    }
+
+  m_ImageMTime = this->GetMTime();
+  return m_Image.GetPointer();
+}
+
+template <unsigned int VDimension>
+void
+BinaryBitMask<VDimension>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf(os,indent);
+
+  os << indent << "Region: " << m_Region << std::endl;
+  os << indent << "OnValue: " << static_cast<int>(m_OnValue) << std::endl;
+  os << indent << "OffValue: " << static_cast<int>(m_OffValue) << std::endl;
+  os << indent << "BufferSize: " << this->GetBufferSize() << std::endl;
+  os << indent << "Image: " << m_Image.GetPointer() << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,311 @@
+#ifndef __itkHistogramThresholdImageCalculator_h
+#define __itkHistogramThresholdImageCalculator_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkNumericTraits.h"
+#include "itkThresholdHistogram.h"
+#include "itkThresholdScratchArray.h"
+#include "itkThresholdHistogramFill.h"
+#include <vector>
+
+namespace itk
+{
+
+/** \class HistogramThresholdImageCalculator
+ * \brief Base class for the calculators that compute a threshold from
+ * the intensity histogram of an image.
+ *
+ * This class builds the histogram over the requested region and
+ * passes it to ComputeThresholdFromHistogram(), which subclasses
+ * implement with their threshold criterion.
+ *
+ * By default the histogram has NumberOfHistogramBins equal width bins
+ * spanning the image range. With UseExactHistogram on, each distinct
+ * pixel value gets its own entry, so images with few distinct values
+ * (quantized or label-like data) are thresholded on their true values
+ * without binning losses. If the region holds more than
+ * MaximumNumberOfExactValues distinct values the calculator falls back
+ * to the binned histogram.
+ *
+ * With UseSparseHistogram on, the binned histogram only stores the
+ * occupied bins. This saves memory and time when NumberOfHistogramBins
+ * is much larger than the number of distinct values in the image.
+ *
+ * Images that are mostly background, such as the air around a CT
+ * volume, are histogrammed faster when the background value is known:
+ * blocks of pixels made only of it are then counted in one go. The
+ * value is either set with BackgroundValue and UseBackgroundValue, or
+ * estimated from a sample of the image with AutomaticBackgroundValue.
+ *
+ * The binned histogram spans the range of the region, so that a few
+ * outliers, such as hot pixels or metal artifacts, crowd the rest of
+ * the pixels into a few bins. With ClipHistogramRange on, the range
+ * spans the LowerRangePercentile and UpperRangePercentile of the
+ * pixels instead, estimated from a sample taken while the range is
+ * computed. The pixels outside it are counted in the first and last
+ * bins.
+ *
+ * When the range of the pixels is known beforehand, as for calibrated
+ * modalities, it can be given with SetHistogramRange(). The pass over
+ * the pixels computing the range is then skipped. The pixels outside a
+ * fixed or clipped range are counted in the edge bins, or left out of
+ * the histogram with ClampToHistogramRange off.
+ *
+ * Compute() stores its result in the calculator. ComputeThreshold()
+ * instead takes the image and region as arguments and returns the
+ * result, leaving the calculator untouched. One configured calculator
+ * can then be shared by several threads, for instance to threshold
+ * many regions of interest concurrently, as long as its settings are
+ * not changed while they run.
+ *
+ * \author Richard Beare
+ * \warning This method assumes that the input image consists of scalar pixel
+ * types.
+ *
+ * \ingroup Operators
+ */
+template <class TInputImage>
+class ITK_EXPORT HistogramThresholdImageCalculator : public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef HistogramThresholdImageCalculator Self;
+  typedef Object                            Superclass;
+  typedef SmartPointer<Self>                Pointer;
+  typedef SmartPointer<const Self>          ConstPointer;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(HistogramThresholdImageCalculator, Object);
+
+  /** Type definition for the input image. */
+  typedef TInputImage  ImageType;
+
+  /** Pointer type for the image. */
+  typedef typename TInputImage::Pointer  ImagePointer;
+
+  /** Const Pointer type for the image. */
+  typedef typename TInputImage::ConstPointer ImageConstPointer;
+
+  /** Type definition for the input image pixel type. */
+  typedef typename TInputImage::PixelType PixelType;
+
+  /** Type definition for the input image region type. */
+  typedef typename TInputImage::RegionType RegionType;
+
+  /** Histogram passed to the threshold criterion. */
+  typedef ThresholdHistogram<PixelType> HistogramType;
+
+  /** Working array of the threshold criteria. Histograms of up to
+   * 256 entries, the 8 bit case, are solved without heap allocation. */
+  typedef ThresholdScratchArray<double, 256> ScratchArrayType;
+
+  /** Result of ComputeThreshold(). Valid is false if the region is
+   * empty or the criterion found no threshold. */
+  struct ResultType
+    {
+    PixelType Threshold;
+    bool      Valid;
+    };
+
+  /** Set/Get the input image. */
+  itkSetConstObjectMacro(Image,ImageType);
+  itkGetConstObjectMacro(Image,ImageType);
+
+  /** Compute the threshold for the input image. */
+  virtual void Compute(void);
+
+  /** Compute the threshold of a region of an image. This method does
+   * not modify the calculator and is reentrant. */
+  ResultType ComputeThreshold(const ImageType * image,
+                              const RegionType & region) const;
+
+  /** Compute the threshold of a histogram, for instance one merged
+   * from the histograms of several parts of an image. */
+  ResultType ComputeThreshold(const HistogramType & histogram) const;
+
+  /** Fill the histogram of the region, with the current settings.
+   * Returns false if the region holds a single value, in which case
+   * the histogram has a single exact entry. */
+  bool ComputeHistogram(const ImageType * image, const RegionType & region,
+                        HistogramType & histogram) const;
+
+  /** Return the threshold value. */
+  itkGetConstMacro(Threshold,PixelType);
+
+  /** Set/Get the number of histogram bins. Default is 128. */
+  itkSetClampMacro( NumberOfHistogramBins, unsigned long, 1,
+                    NumericTraits<unsigned long>::max() );
+  itkGetConstMacro( NumberOfHistogramBins, unsigned long );
+
+  /** Set/Get whether the histogram is built from the distinct pixel
+   * values instead of bins. Default is off. */
+  itkSetMacro( UseExactHistogram, bool );
+  itkGetConstMacro( UseExactHistogram, bool );
+  itkBooleanMacro( UseExactHistogram );
+
+  /** Set/Get the number of distinct values above which the exact
+   * histogram falls back to binning. Default is 4096. */
+  itkSetClampMacro( MaximumNumberOfExactValues, unsigned long, 2,
+                    NumericTraits<unsigned long>::max() );
+  itkGetConstMacro( MaximumNumberOfExactValues, unsigned long );
+
+  /** Set/Get whether the binned histogram only stores the occupied
+   * bins. Default is off. */
+  itkSetMacro( UseSparseHistogram, bool );
+  itkGetConstMacro( UseSparseHistogram, bool );
+  itkBooleanMacro( UseSparseHistogram );
+
+  /** Set/Get the background value, used when UseBackgroundValue is
+   * on. Default is 0. */
+  itkSetMacro( BackgroundValue, PixelType );
+  itkGetConstMacro( BackgroundValue, PixelType );
+
+  /** Set/Get whether BackgroundValue is the background of the image.
+   * Default is off. */
+  itkSetMacro( UseBackgroundValue, bool );
+  itkGetConstMacro( UseBackgroundValue, bool );
+  itkBooleanMacro( UseBackgroundValue );
+
+  /** Set/Get whether the background value is estimated from the image,
+   * when UseBackgroundValue is off. A value is taken as the background
+   * if it fills more than half of a sample of the image. Default is
+   * off. */
+  itkSetMacro( AutomaticBackgroundValue, bool );
+  itkGetConstMacro( AutomaticBackgroundValue, bool );
+  itkBooleanMacro( AutomaticBackgroundValue );
+
+  /** Set/Get whether the binned histogram spans the percentiles below
+   * instead of the whole range of the region. Default is off. */
+  itkSetMacro( ClipHistogramRange, bool );
+  itkGetConstMacro( ClipHistogramRange, bool );
+  itkBooleanMacro( ClipHistogramRange );
+
+  /** Set/Get the percentiles, between 0 and 1, of the pixels at the
+   * bounds of a clipped range. Defaults are 0.001 and 0.999. */
+  itkSetClampMacro( LowerRangePercentile, double, 0.0, 1.0 );
+  itkGetConstMacro( LowerRangePercentile, double );
+  itkSetClampMacro( UpperRangePercentile, double, 0.0, 1.0 );
+  itkGetConstMacro( UpperRangePercentile, double );
+
+  /** Set/Get the fixed range of the binned histogram, used when
+   * UseFixedHistogramRange is on and the minimum is below the maximum.
+   * Defaults are 0. */
+  itkSetMacro( HistogramMinimum, PixelType );
+  itkGetConstMacro( HistogramMinimum, PixelType );
+  itkSetMacro( HistogramMaximum, PixelType );
+  itkGetConstMacro( HistogramMaximum, PixelType );
+
+  /** Set/Get whether the binned histogram spans the fixed range
+   * instead of the range of the region. Default is off. */
+  itkSetMacro( UseFixedHistogramRange, bool );
+  itkGetConstMacro( UseFixedHistogramRange, bool );
+  itkBooleanMacro( UseFixedHistogramRange );
+
+  /** Set the fixed range and turn UseFixedHistogramRange on. An empty
+   * range, with the minimum not below the maximum, is warned about and
+   * the range of the region used instead. */
+  void SetHistogramRange( PixelType minimum, PixelType maximum );
+
+  /** Set/Get whether the pixels outside a fixed or clipped range are
+   * counted in the edge bins, instead of being left out. Default is
+   * on. */
+  itkSetMacro( ClampToHistogramRange, bool );
+  itkGetConstMacro( ClampToHistogramRange, bool );
+  itkBooleanMacro( ClampToHistogramRange );
+
+  /** Get the background value of the region, following the settings
+   * above. Returns false if there is none. */
+  bool ComputeBackgroundValue(const ImageType * image, const RegionType & region,
+                              PixelType & background) const;
+
+  /** Set the region over which the values will be computed */
+  void SetRegion( const RegionType & region );
+
+protected:
+  HistogramThresholdImageCalculator();
+  virtual ~HistogramThresholdImageCalculator() {};
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  /** Set the threshold returned by GetThreshold(). */
+  itkSetMacro(Threshold,PixelType);
+
+  /** The region used by Compute(): the one set with SetRegion(), or
+   * the requested region of the image. */
+  RegionType GetComputeRegion() const;
+
+  /** Apply the threshold criterion to the histogram. Returns false if
+   * no threshold could be found, leaving threshold untouched. */
+  virtual bool ComputeThresholdFromHistogram(const HistogramType & histogram,
+                                             PixelType & threshold) const = 0;
+
+private:
+  HistogramThresholdImageCalculator(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  bool ComputeExactHistogram(const ImageType * image,
+                             const RegionType & region,
+                             HistogramType & histogram) const;
+
+  void ComputeSparseHistogram(const ImageType * image,
+                              const RegionType & region,
+                              HistogramType & histogram,
+                              PixelType imageMin, PixelType imageMax,
+                              bool ignoreOutside) const;
+
+  /** Bins of the values from the minimum to the maximum of the range,
+   * for 8 and 16 bit pixels. Empty when the bins are computed. */
+  typedef std::vector<unsigned long> BinTableType;
+
+  /** Add the pixels of a row to the copies of the binned histogram. */
+  void FillRow(const PixelType * row, unsigned long rowLength,
+               PixelType imageMin, double binMultiplier,
+               const BinTableType & binTable,
+               ThresholdHistogramFill::KernelType kernel,
+               double ** copies) const;
+
+  /** Bin of a value in the binned histogram. */
+  unsigned long GetBinNumber(PixelType value, PixelType imageMin,
+                             double binMultiplier) const;
+
+  /** Bin of a value, looked up in the table when there is one. */
+  unsigned long GetBinNumber(PixelType value, PixelType imageMin,
+                             double binMultiplier,
+                             const BinTableType & binTable) const;
+
+  /** Narrow the range to the percentiles of the sample. */
+  void ClipRange(std::vector<PixelType> & sample,
+                 PixelType & imageMin, PixelType & imageMax) const;
+
+  /** Largest number of pixels sampled for the percentiles. */
+  itkStaticConstMacro(MaximumSampleSize, unsigned long, 1 << 18);
+
+  PixelType            m_Threshold;
+  unsigned long        m_NumberOfHistogramBins;
+  ImageConstPointer    m_Image;
+  RegionType           m_Region;
+  bool                 m_RegionSetByUser;
+  bool                 m_UseExactHistogram;
+  unsigned long        m_MaximumNumberOfExactValues;
+  bool                 m_UseSparseHistogram;
+  PixelType            m_BackgroundValue;
+  bool                 m_UseBackgroundValue;
+  bool                 m_AutomaticBackgroundValue;
+  bool                 m_ClipHistogramRange;
+  double               m_LowerRangePercentile;
+  double               m_UpperRangePercentile;
+  PixelType            m_HistogramMinimum;
+  PixelType            m_HistogramMaximum;
+  bool                 m_UseFixedHistogramRange;
+  bool                 m_ClampToHistogramRange;
+
+};
+
+} // end namespace itk
+
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkHistogramThresholdImageCalculator.txx"
+#endif
+
+#endif
@@ -0,0 +1,641 @@
+#ifndef __itkHistogramThresholdImageCalculator_txx
+#define __itkHistogramThresholdImageCalculator_txx
+
+#include "itkHistogramThresholdImageCalculator.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageLinearConstIteratorWithIndex.h"
+
+#include "vnl/vnl_math.h"
+#include <map>
+#include <algorithm>
+
+namespace itk
+{
+
+/**
+ * Constructor
+ */
+template<class TInputImage>
+HistogramThresholdImageCalculator<TInputImage>
+::HistogramThresholdImageCalculator()
+{
+  m_Image = NULL;
+  m_Threshold = NumericTraits<PixelType>::Zero;
+  m_NumberOfHistogramBins = 128;
+  m_RegionSetByUser = false;
+  m_UseExactHistogram = false;
+  m_MaximumNumberOfExactValues = 4096;
+  m_UseSparseHistogram = false;
+  m_BackgroundValue = NumericTraits<PixelType>::Zero;
+  m_UseBackgroundValue = false;
+  m_AutomaticBackgroundValue = false;
+  m_ClipHistogramRange = false;
+  m_LowerRangePercentile = 0.001;
+  m_UpperRangePercentile = 0.999;
+  m_HistogramMinimum = NumericTraits<PixelType>::Zero;
+  m_HistogramMaximum = NumericTraits<PixelType>::Zero;
+  m_UseFixedHistogramRange = false;
+  m_ClampToHistogramRange = true;
+}
+
+
+/*
+ * Compute the threshold
+ */
+template<class TInputImage>
+void
+HistogramThresholdImageCalculator<TInputImage>
+::Compute(void)
+{
+  if ( !m_Image ) { return; }
+
+  ResultType result = this->ComputeThreshold( m_Image, this->GetComputeRegion() );
+  if ( result.Valid )
+    {
+    m_Threshold = result.Threshold;
+    }
+}
+
+template<class TInputImage>
+typename HistogramThresholdImageCalculator<TInputImage>::ResultType
+HistogramThresholdImageCalculator<TInputImage>
+::ComputeThreshold(const ImageType * image, const RegionType & region) const
+{
+  ResultType result;
+  result.Threshold = NumericTraits<PixelType>::Zero;
+  result.Valid = false;
+
+  if ( !image || region.GetNumberOfPixels() == 0 ) { return result; }
+
+  HistogramType histogram;
+  this->ComputeHistogram( image, region, histogram );
+  return this->ComputeThreshold( histogram );
+}
+
+template<class TInputImage>
+typename HistogramThresholdImageCalculator<TInputImage>::ResultType
+HistogramThresholdImageCalculator<TInputImage>
+::ComputeThreshold(const HistogramType & histogram) const
+{
+  ResultType result;
+  result.Threshold = histogram.GetMinimum();
+  result.Valid = false;
+
+  if ( histogram.GetTotalFrequency() == 0 ) { return result; }
+
+  if ( histogram.GetMinimum() >= histogram.GetMaximum() )
+    {
+    result.Valid = true;
+    return result;
+    }
+
+  result.Valid =
+    this->ComputeThresholdFromHistogram( histogram, result.Threshold );
+  return result;
+}
+
+template<class TInputImage>
+typename HistogramThresholdImageCalculator<TInputImage>::RegionType
+HistogramThresholdImageCalculator<TInputImage>
+::GetComputeRegion() const
+{
+  if ( m_RegionSetByUser || !m_Image )
+    {
+    return m_Region;
+    }
+  return m_Image->GetRequestedRegion();
+}
+
+template<class TInputImage>
+bool
+HistogramThresholdImageCalculator<TInputImage>
+::ComputeHistogram(const ImageType * image, const RegionType & region,
+                   HistogramType & histogram) const
+{
+  if ( m_UseExactHistogram &&
+       this->ComputeExactHistogram( image, region, histogram ) )
+    {
+    return ( histogram.GetMinimum() < histogram.GetMaximum() );
+    }
+
+  typedef ImageRegionConstIterator<TInputImage> Iterator;
+  typedef ImageLinearConstIteratorWithIndex<TInputImage> LineIterator;
+
+  // a fixed range saves going over the pixels for it
+  PixelType imageMin = m_HistogramMinimum;
+  PixelType imageMax = m_HistogramMaximum;
+  const bool fixedRange = m_UseFixedHistogramRange && imageMin < imageMax;
+
+  if ( !fixedRange )
+    {
+    // compute the range of the region. When it is clipped, a sample of
+    // the pixels is taken as well, to estimate the percentiles from. The
+    // step between samples is odd, so that it does not follow the rows.
+    const unsigned long sampleStep = m_ClipHistogramRange ?
+      ( region.GetNumberOfPixels() / MaximumSampleSize ) | 1 : 0;
+    std::vector<PixelType> sample;
+    unsigned long untilSample = 1;
+
+    Iterator rangeIter( image, region );
+    imageMin = rangeIter.Get();
+    imageMax = imageMin;
+    while ( !rangeIter.IsAtEnd() )
+      {
+      const PixelType value = rangeIter.Get();
+      if ( value < imageMin )
+        {
+        imageMin = value;
+        }
+      else if ( value > imageMax )
+        {
+        imageMax = value;
+        }
+      if ( sampleStep && --untilSample == 0 )
+        {
+        sample.push_back( value );
+        untilSample = sampleStep;
+        }
+      ++rangeIter;
+      }
+
+    if ( imageMin >= imageMax )
+      {
+      typename HistogramType::ValueContainerType values( 1, imageMin );
+      typename HistogramType::FrequencyContainerType frequency( 1,
+        (double) region.GetNumberOfPixels() );
+      histogram.InitializeExact( values, frequency, m_NumberOfHistogramBins );
+      return false;
+      }
+
+    if ( m_ClipHistogramRange )
+      {
+      this->ClipRange( sample, imageMin, imageMax );
+      }
+    }
+
+  // the pixels outside a narrowed range are counted in the edge bins,
+  // and taken out again when they are to be ignored
+  const bool ignoreOutside = !m_ClampToHistogramRange &&
+    ( fixedRange || m_ClipHistogramRange );
+
+  if ( m_UseSparseHistogram )
+    {
+    this->ComputeSparseHistogram( image, region, histogram, imageMin, imageMax,
+                                  ignoreOutside );
+    return true;
+    }
+
+  // create a histogram
+  histogram.Initialize( imageMin, imageMax, m_NumberOfHistogramBins );
+  typename HistogramType::FrequencyContainerType & relativeFrequency =
+    histogram.GetFrequencies();
+
+  double binMultiplier = histogram.GetBinMultiplier();
+
+  // Consecutive pixels are counted in different copies of the
+  // histogram, so that increments of the same bin don't wait on each
+  // other, and runs of one value are counted in one go. The copies are
+  // only worth it when there are more pixels than bins.
+  const unsigned int numberOfCopies = ThresholdHistogramFill::NumberOfCopies;
+  std::vector<double> copyCounts;
+  double * copies[numberOfCopies];
+  for ( unsigned int c = 0; c < numberOfCopies; c++ )
+    {
+    copies[c] = &relativeFrequency[0];
+    }
+  if ( numberOfCopies * m_NumberOfHistogramBins <= region.GetNumberOfPixels() )
+    {
+    copyCounts.resize( ( numberOfCopies - 1 ) * m_NumberOfHistogramBins, 0.0 );
+    for ( unsigned int c = 1; c < numberOfCopies; c++ )
+      {
+      copies[c] = &copyCounts[( c - 1 ) * m_NumberOfHistogramBins];
+      }
+    }
+
+  // 8 and 16 bit values are binned through a table of the bin of each
+  // value of the range, when the range is smaller than the region
+  BinTableType binTable;
+  if ( NumericTraits<PixelType>::is_integer && sizeof( PixelType ) <= 2 &&
+       (unsigned long) ( imageMax - imageMin ) < region.GetNumberOfPixels() )
+    {
+    binTable.resize( (unsigned long) ( imageMax - imageMin ) + 1 );
+    for ( unsigned long v = 0; v < binTable.size(); v++ )
+      {
+      binTable[v] = this->GetBinNumber( static_cast<PixelType>( imageMin + v ),
+                                        imageMin, binMultiplier );
+      }
+    }
+
+  // fill row by row, so that float rows can be binned with the vector
+  // kernels, several pixels at a time
+  const ThresholdHistogramFill::KernelType kernel =
+    ThresholdHistogramFill::GetKernel();
+  const unsigned long rowLength = region.GetSize()[0];
+  const PixelType * buffer = image->GetBufferPointer();
+
+  // blocks of the rows made only of the background value are counted
+  // in one go
+  PixelType background = NumericTraits<PixelType>::Zero;
+  const bool useBackground =
+    this->ComputeBackgroundValue( image, region, background );
+  const unsigned long backgroundBin = useBackground ?
+    this->GetBinNumber( background, imageMin, binMultiplier ) : 0;
+  const unsigned long blockLength = 64;
+
+  LineIterator iter( image, region );
+  iter.SetDirection( 0 );
+
+  while ( !iter.IsAtEnd() )
+    {
+    const PixelType * row = buffer + image->ComputeOffset( iter.GetIndex() );
+    if ( !useBackground )
+      {
+      this->FillRow( row, rowLength, imageMin, binMultiplier, binTable, kernel,
+                     copies );
+      }
+    else
+      {
+      unsigned long pending = 0;
+      for ( unsigned long b = 0; b < rowLength; b += blockLength )
+        {
+        const unsigned long length = std::min( blockLength, rowLength - b );
+        if ( ThresholdHistogramFill::CountValue( kernel, row + b, length,
+                                                 background ) == length )
+          {
+          this->FillRow( row + pending, b - pending, imageMin, binMultiplier,
+                         binTable, kernel, copies );
+          copies[0][backgroundBin] += length;
+          pending = b + length;
+          }
+        }
+      this->FillRow( row + pending, rowLength - pending, imageMin, binMultiplier,
+                     binTable, kernel, copies );
+      }
+    if ( ignoreOutside )
+      {
+      for ( unsigned long i = 0; i < rowLength; i++ )
+        {
+        if ( row[i] < imageMin )
+          {
+          copies[0][0] -= 1.0;
+          }
+        else if ( row[i] > imageMax )
+          {
+          copies[0][m_NumberOfHistogramBins - 1] -= 1.0;
+          }
+        }
+      }
+    iter.NextLine();
+    }
+
+  for ( unsigned long k = 0; k < copyCounts.size(); k++ )
+    {
+    relativeFrequency[k % m_NumberOfHistogramBins] += copyCounts[k];
+    }
+  return true;
+}
+
+template<class TInputImage>
+bool
+HistogramThresholdImageCalculator<TInputImage>
+::ComputeBackgroundValue(const ImageType * image, const RegionType & region,
+                         PixelType & background) const
+{
+  if ( m_UseBackgroundValue )
+    {
+    background = m_BackgroundValue;
+    return true;
+    }
+  if ( !m_AutomaticBackgroundValue || !image ||
+       region.GetNumberOfPixels() == 0 )
+    {
+    return false;
+    }
+
+  // Sample a few pixels of up to 1024 rows. The background is the
+  // value of more than half of the samples, if there is one.
+  typedef ImageLinearConstIteratorWithIndex<TInputImage> LineIterator;
+  typedef std::map<PixelType, unsigned long> CountMapType;
+  CountMapType counts;
+  unsigned long samples = 0;
+
+  const unsigned long rowLength = region.GetSize()[0];
+  const unsigned long numberOfRows = region.GetNumberOfPixels() / rowLength;
+  const unsigned long rowStep = std::max( 1UL, numberOfRows / 1024 );
+  const unsigned long pixelStep = std::max( 1UL, rowLength / 16 );
+  const PixelType * buffer = image->GetBufferPointer();
+
+  LineIterator iter( image, region );
+  iter.SetDirection( 0 );
+  unsigned long rowNumber = 0;
+  while ( !iter.IsAtEnd() )
+    {
+    if ( rowNumber++ % rowStep == 0 )
+      {
+      const PixelType * row = buffer + image->ComputeOffset( iter.GetIndex() );
+      for ( unsigned long i = 0; i < rowLength; i += pixelStep )
+        {
+        counts[row[i]]++;
+        samples++;
+        }
+      }
+    iter.NextLine();
+    }
+
+  typename CountMapType::const_iterator mode = counts.begin();
+  for ( typename CountMapType::const_iterator it = counts.begin();
+        it != counts.end(); ++it )
+    {
+    if ( it->second > mode->second )
+      {
+      mode = it;
+      }
+    }
+  if ( 2 * mode->second <= samples )
+    {
+    return false;
+    }
+  itkDebugMacro(<< "Background value " << mode->first << " in "
+                << mode->second << " of " << samples << " samples");
+  background = mode->first;
+  return true;
+}
+
+template<class TInputImage>
+void
+HistogramThresholdImageCalculator<TInputImage>
+::FillRow(const PixelType * row, unsigned long rowLength, PixelType imageMin,
+          double binMultiplier, const BinTableType & binTable,
+          ThresholdHistogramFill::KernelType kernel, double ** copies) const
+{
+  const unsigned int numberOfCopies = ThresholdHistogramFill::NumberOfCopies;
+  unsigned long i = 0;
+  if ( binTable.empty() )
+    {
+    i = ThresholdHistogramFill::FillRow( kernel, row, rowLength, imageMin,
+      binMultiplier, m_NumberOfHistogramBins, copies );
+    }
+  while ( i + numberOfCopies <= rowLength )
+    {
+    const PixelType value = row[i];
+    if ( i + 8 <= rowLength && row[i + 7] == value &&
+         std::count( row + i + 1, row + i + 7, value ) == 6 )
+      {
+      // a run of one value, counted in one go
+      unsigned long end = i + 8;
+      while ( end < rowLength && row[end] == value )
+        {
+        end++;
+        }
+      copies[0][this->GetBinNumber( value, imageMin, binMultiplier, binTable )] += end - i;
+      i = end;
+      continue;
+      }
+    for ( unsigned int c = 0; c < numberOfCopies; c++, i++ )
+      {
+      copies[c][this->GetBinNumber( row[i], imageMin, binMultiplier, binTable )] += 1.0;
+      }
+    }
+  for ( ; i < rowLength; i++ )
+    {
+    copies[0][this->GetBinNumber( row[i], imageMin, binMultiplier, binTable )] += 1.0;
+    }
+}
+
+template<class TInputImage>
+unsigned long
+HistogramThresholdImageCalculator<TInputImage>
+::GetBinNumber(PixelType value, PixelType imageMin, double binMultiplier) const
+{
+  // values outside a clipped range go to the edge bins
+  if ( !( value > imageMin ) )
+    {
+    return 0;
+    }
+
+  const double binNumber = vcl_ceil((value - imageMin) * binMultiplier ) - 1;
+  if ( binNumber >= m_NumberOfHistogramBins ) // and in case of rounding errors
+    {
+    return m_NumberOfHistogramBins - 1;
+    }
+  return (unsigned long) binNumber;
+}
+
+template<class TInputImage>
+unsigned long
+HistogramThresholdImageCalculator<TInputImage>
+::GetBinNumber(PixelType value, PixelType imageMin, double binMultiplier,
+               const BinTableType & binTable) const
+{
+  if ( binTable.empty() )
+    {
+    return this->GetBinNumber( value, imageMin, binMultiplier );
+    }
+  // values outside a clipped range go to the edge bins
+  if ( !( value > imageMin ) )
+    {
+    return 0;
+    }
+  const unsigned long offset = (unsigned long) ( value - imageMin );
+  if ( offset >= binTable.size() )
+    {
+    return m_NumberOfHistogramBins - 1;
+    }
+  return binTable[offset];
+}
+
+template<class TInputImage>
+void
+HistogramThresholdImageCalculator<TInputImage>
+::ClipRange(std::vector<PixelType> & sample,
+            PixelType & imageMin, PixelType & imageMax) const
+{
+  if ( sample.empty() )
+    {
+    return;
+    }
+
+  // the percentiles are taken in order, whichever way they were set
+  const double lowerPercentile =
+    std::min( m_LowerRangePercentile, m_UpperRangePercentile );
+  const double upperPercentile =
+    std::max( m_LowerRangePercentile, m_UpperRangePercentile );
+  const double last = sample.size() - 1;
+  const unsigned long lowerRank =
+    (unsigned long) vcl_floor( lowerPercentile * last );
+  const unsigned long upperRank =
+    (unsigned long) vcl_ceil( upperPercentile * last );
+
+  // a range of a single rank is too narrow to bin, and is left alone
+  if ( lowerRank >= upperRank )
+    {
+    return;
+    }
+
+  std::nth_element( sample.begin(), sample.begin() + lowerRank, sample.end() );
+  const PixelType lower = std::max( imageMin, sample[lowerRank] );
+  std::nth_element( sample.begin() + lowerRank, sample.begin() + upperRank,
+                    sample.end() );
+  const PixelType upper = std::min( imageMax, sample[upperRank] );
+
+  // a range too narrow to bin is left alone
+  if ( lower < upper )
+    {
+    itkDebugMacro(<< "Histogram range clipped from [" << imageMin << ", "
+                  << imageMax << "] to [" << lower << ", " << upper << "]");
+    imageMin = lower;
+    imageMax = upper;
+    }
+}
+
+template<class TInputImage>
+void
+HistogramThresholdImageCalculator<TInputImage>
+::ComputeSparseHistogram(const ImageType * image, const RegionType & region,
+                         HistogramType & histogram,
+                         PixelType imageMin, PixelType imageMax,
+                         bool ignoreOutside) const
+{
+  const double binMultiplier =
+    (double) m_NumberOfHistogramBins / (double) ( imageMax - imageMin );
+
+  // count the occupied bins only. The first bin is always kept, as a
+  // criterion may settle on it even when it is empty.
+  typedef std::map<unsigned long, double> CountMapType;
+  CountMapType counts;
+  counts[0] = 0.0;
+
+  typedef ImageRegionConstIterator<TInputImage> Iterator;
+  Iterator iter( image, region );
+
+  while ( !iter.IsAtEnd() )
+    {
+    // count runs of one value in one go
+    const PixelType value = iter.Get();
+    double run = 0.0;
+    while ( !iter.IsAtEnd() && iter.Get() == value )
+      {
+      run += 1.0;
+      ++iter;
+      }
+    if ( ignoreOutside && ( value < imageMin || value > imageMax ) )
+      {
+      continue;
+      }
+    counts[this->GetBinNumber( value, imageMin, binMultiplier )] += run;
+    }
+
+  std::vector<unsigned long> bins;
+  typename HistogramType::FrequencyContainerType frequency;
+  bins.reserve( counts.size() );
+  frequency.reserve( counts.size() );
+  for ( typename CountMapType::const_iterator it = counts.begin();
+        it != counts.end(); ++it )
+    {
+    bins.push_back( it->first );
+    frequency.push_back( it->second );
+    }
+
+  histogram.InitializeSparse( imageMin, imageMax, m_NumberOfHistogramBins,
+                              bins, frequency );
+}
+
+template<class TInputImage>
+bool
+HistogramThresholdImageCalculator<TInputImage>
+::ComputeExactHistogram(const ImageType * image, const RegionType & region,
+                        HistogramType & histogram) const
+{
+  // count the distinct values, giving up as soon as there are too
+  // many for the exact histogram to be worthwhile
+  typedef std::map<PixelType, double> CountMapType;
+  CountMapType counts;
+
+  typedef ImageRegionConstIterator<TInputImage> Iterator;
+  Iterator iter( image, region );
+
+  while ( !iter.IsAtEnd() )
+    {
+    counts[iter.Get()] += 1.0;
+    if ( counts.size() > m_MaximumNumberOfExactValues )
+      {
+      itkDebugMacro(<< "More than " << m_MaximumNumberOfExactValues
+                    << " distinct values, using a binned histogram");
+      return false;
+      }
+    ++iter;
+    }
+
+  typename HistogramType::ValueContainerType values;
+  typename HistogramType::FrequencyContainerType frequency;
+  values.reserve( counts.size() );
+  frequency.reserve( counts.size() );
+  for ( typename CountMapType::const_iterator it = counts.begin();
+        it != counts.end(); ++it )
+    {
+    values.push_back( it->first );
+    frequency.push_back( it->second );
+    }
+
+  histogram.InitializeExact( values, frequency, m_NumberOfHistogramBins );
+  return true;
+}
+
+template<class TInputImage>
+void
+HistogramThresholdImageCalculator<TInputImage>
+::SetHistogramRange( PixelType minimum, PixelType maximum )
+{
+  if ( !( minimum < maximum ) )
+    {
+    itkWarningMacro(<< "Empty histogram range ["
+                    << static_cast<typename NumericTraits<PixelType>::PrintType>(minimum) << ", "
+                    << static_cast<typename NumericTraits<PixelType>::PrintType>(maximum)
+                    << "]: the range of the image is used instead");
+    }
+  this->SetHistogramMinimum( minimum );
+  this->SetHistogramMaximum( maximum );
+  this->SetUseFixedHistogramRange( true );
+}
+
+template<class TInputImage>
+void
+HistogramThresholdImageCalculator<TInputImage>
+::SetRegion( const RegionType & region )
+{
+  m_Region = region;
+  m_RegionSetByUser = true;
+}
+
+
+template<class TInputImage>
+void
+HistogramThresholdImageCalculator<TInputImage>
+::PrintSelf( std::ostream& os, Indent indent ) const
+{
+  Superclass::PrintSelf(os,indent);
+
+  os << indent << "Threshold: " << m_Threshold << std::endl;
+  os << indent << "NumberOfHistogramBins: " << m_NumberOfHistogramBins << std::endl;
+  os << indent << "UseExactHistogram: " << m_UseExactHistogram << std::endl;
+  os << indent << "MaximumNumberOfExactValues: " << m_MaximumNumberOfExactValues << std::endl;
+  os << indent << "UseSparseHistogram: " << m_UseSparseHistogram << std::endl;
+  os << indent << "BackgroundValue: "
+     << static_cast<typename NumericTraits<PixelType>::PrintType>(m_BackgroundValue) << std::endl;
+  os << indent << "UseBackgroundValue: " << m_UseBackgroundValue << std::endl;
+  os << indent << "AutomaticBackgroundValue: " << m_AutomaticBackgroundValue << std::endl;
+  os << indent << "ClipHistogramRange: " << m_ClipHistogramRange << std::endl;
+  os << indent << "LowerRangePercentile: " << m_LowerRangePercentile << std::endl;
+  os << indent << "UpperRangePercentile: " << m_UpperRangePercentile << std::endl;
+  os << indent << "HistogramMinimum: "
+     << static_cast<typename NumericTraits<PixelType>::PrintType>(m_HistogramMinimum) << std::endl;
+  os << indent << "HistogramMaximum: "
+     << static_cast<typename NumericTraits<PixelType>::PrintType>(m_HistogramMaximum) << std::endl;
+  os << indent << "UseFixedHistogramRange: " << m_UseFixedHistogramRange << std::endl;
+  os << indent << "ClampToHistogramRange: " << m_ClampToHistogramRange << std::endl;
+  os << indent << "Image: " << m_Image.GetPointer() << std::endl;
+}
+
+} // end namespace itk
+
+#endif
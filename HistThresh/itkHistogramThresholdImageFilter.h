@@ -0,0 +1,386 @@
+#ifndef __itkHistogramThresholdImageFilter_h
+#define __itkHistogramThresholdImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkBinaryBitMask.h"
+#include "itkRunLengthMask.h"
+#include <vector>
+
+namespace itk {
+
+/** \class HistogramThresholdImageFilter
+ * \brief Threshold an image using a histogram based threshold
+ * calculator
+ *
+ * This filter creates a binary thresholded image that separates an
+ * image into foreground and background components. The filter
+ * computes the threshold using TCalculator, one of the
+ * HistogramThresholdImageCalculator subclasses, and applies that
+ * threshold to the input image using the BinaryThresholdImageFilter.
+ * Pixels at or below the threshold get the InsideValue, the others
+ * the OutsideValue.
+ *
+ * The threshold method is a template parameter, so the code shared
+ * by all the methods lives here once. The per method filters, such
+ * as HuangThresholdImageFilter, derive from this class and only
+ * forward the settings particular to their calculator. Those settings
+ * can also be changed directly on the calculator returned by
+ * GetCalculator(), which is part of the filter's modification time.
+ * The threshold is only computed again when the input, the filter or
+ * the calculator has changed, so that a streamed output doesn't build
+ * the histogram of the whole input for each piece.
+ *
+ * When the calculator has a background value, set or estimated from
+ * the image, the filter binarizes the image itself in a multithreaded
+ * pass: blocks of pixels made only of the background are found by
+ * comparing whole vectors and written in one go.
+ *
+ * With UseBitMaskOutput on, the mask is written to the BinaryBitMask
+ * returned by GetBitMask(), one bit per pixel set where the pixel gets
+ * the InsideValue, and the output image is left unallocated. The bit
+ * mask converts itself to an image when one is needed. Likewise, with
+ * UseRunLengthOutput on, the runs of those pixels along each row are
+ * written to the RunLengthMask returned by GetRunLengthMask(), which
+ * can be opened or closed without going back to an image. Both masks
+ * are written in the multithreaded pass, each thread packing whole
+ * rows.
+ *
+ * With ComputeStatistics on, the filter binarizes the image in its
+ * own multithreaded pass, which also counts the pixels of each class,
+ * sums their values and finds the bounding box of the inside pixels,
+ * so that these need no further pass through the image. The statistics
+ * are gathered as well when writing to a mask. The statistics and the
+ * masks are of the whole image, so the output requested region is then
+ * enlarged to the largest possible region rather than streamed.
+ *
+ * \sa HistogramThresholdImageCalculator
+ * \sa BinaryThresholdImageFilter
+ * \ingroup IntensityImageFilters  Multithreaded
+ */
+
+template<class TInputImage, class TOutputImage, class TCalculator>
+class ITK_EXPORT HistogramThresholdImageFilter :
+    public ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  /** Standard Self typedef */
+  typedef HistogramThresholdImageFilter                 Self;
+  typedef ImageToImageFilter<TInputImage,TOutputImage>  Superclass;
+  typedef SmartPointer<Self>                            Pointer;
+  typedef SmartPointer<const Self>                      ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(HistogramThresholdImageFilter, ImageToImageFilter);
+
+  /** Image pixel value typedef. */
+  typedef typename TInputImage::PixelType   InputPixelType;
+  typedef typename TOutputImage::PixelType  OutputPixelType;
+
+  /** Image related typedefs. */
+  typedef typename TInputImage::Pointer  InputImagePointer;
+  typedef typename TOutputImage::Pointer OutputImagePointer;
+
+  typedef typename TInputImage::SizeType    InputSizeType;
+  typedef typename TInputImage::IndexType   InputIndexType;
+  typedef typename TInputImage::RegionType  InputImageRegionType;
+  typedef typename TOutputImage::SizeType   OutputSizeType;
+  typedef typename TOutputImage::IndexType  OutputIndexType;
+  typedef typename TOutputImage::RegionType OutputImageRegionType;
+
+  /** Calculator related typedefs. */
+  typedef TCalculator                         CalculatorType;
+  typedef typename CalculatorType::Pointer    CalculatorPointer;
+
+  /** Image related typedefs. */
+  itkStaticConstMacro(InputImageDimension, unsigned int,
+                      TInputImage::ImageDimension );
+  itkStaticConstMacro(OutputImageDimension, unsigned int,
+                      TOutputImage::ImageDimension );
+
+  /** Bit mask output typedefs. */
+  typedef BinaryBitMask<itkGetStaticConstMacro(InputImageDimension)> BitMaskType;
+  typedef typename BitMaskType::Pointer                               BitMaskPointer;
+
+  /** Run length mask output typedefs. */
+  typedef RunLengthMask<itkGetStaticConstMacro(InputImageDimension)> RunLengthMaskType;
+  typedef typename RunLengthMaskType::Pointer                         RunLengthMaskPointer;
+
+  /** Set the "outside" pixel value. The default value
+   * NumericTraits<OutputPixelType>::Zero. */
+  itkSetMacro(OutsideValue,OutputPixelType);
+
+  /** Get the "outside" pixel value. */
+  itkGetConstMacro(OutsideValue,OutputPixelType);
+
+  /** Set the "inside" pixel value. The default value
+   * NumericTraits<OutputPixelType>::max() */
+  itkSetMacro(InsideValue,OutputPixelType);
+
+  /** Get the "inside" pixel value. */
+  itkGetConstMacro(InsideValue,OutputPixelType);
+
+  /** Get the calculator computing the threshold. */
+  CalculatorType * GetCalculator()
+    { return m_Calculator.GetPointer(); }
+  const CalculatorType * GetCalculator() const
+    { return m_Calculator.GetPointer(); }
+
+  /** Set/Get the number of histogram bins. Defaults is 128. */
+  virtual void SetNumberOfHistogramBins(unsigned long bins)
+    { m_Calculator->SetNumberOfHistogramBins(bins); }
+  virtual unsigned long GetNumberOfHistogramBins() const
+    { return m_Calculator->GetNumberOfHistogramBins(); }
+
+  /** Set/Get whether the calculator should build its histogram from
+   * the distinct pixel values when there are few enough of them.
+   * Default is false. */
+  virtual void SetUseExactHistogram(bool exact)
+    { m_Calculator->SetUseExactHistogram(exact); }
+  virtual bool GetUseExactHistogram() const
+    { return m_Calculator->GetUseExactHistogram(); }
+  itkBooleanMacro( UseExactHistogram );
+
+  /** Set/Get the largest number of distinct values for which the
+   * exact histogram is used. Default is 4096. */
+  virtual void SetMaximumNumberOfExactValues(unsigned long values)
+    { m_Calculator->SetMaximumNumberOfExactValues(values); }
+  virtual unsigned long GetMaximumNumberOfExactValues() const
+    { return m_Calculator->GetMaximumNumberOfExactValues(); }
+
+  /** Set/Get whether the calculator's binned histogram only stores
+   * the occupied bins. Default is false. */
+  virtual void SetUseSparseHistogram(bool sparse)
+    { m_Calculator->SetUseSparseHistogram(sparse); }
+  virtual bool GetUseSparseHistogram() const
+    { return m_Calculator->GetUseSparseHistogram(); }
+  itkBooleanMacro( UseSparseHistogram );
+
+  /** Set/Get the background value of the calculator, used when
+   * UseBackgroundValue is on. Default is 0. */
+  virtual void SetBackgroundValue(InputPixelType background)
+    { m_Calculator->SetBackgroundValue(background); }
+  virtual InputPixelType GetBackgroundValue() const
+    { return m_Calculator->GetBackgroundValue(); }
+
+  /** Set/Get whether BackgroundValue is the background of the image.
+   * Default is false. */
+  virtual void SetUseBackgroundValue(bool use)
+    { m_Calculator->SetUseBackgroundValue(use); }
+  virtual bool GetUseBackgroundValue() const
+    { return m_Calculator->GetUseBackgroundValue(); }
+  itkBooleanMacro( UseBackgroundValue );
+
+  /** Set/Get whether the background value is estimated from the image.
+   * Default is false. */
+  virtual void SetAutomaticBackgroundValue(bool automatic)
+    { m_Calculator->SetAutomaticBackgroundValue(automatic); }
+  virtual bool GetAutomaticBackgroundValue() const
+    { return m_Calculator->GetAutomaticBackgroundValue(); }
+  itkBooleanMacro( AutomaticBackgroundValue );
+
+  /** Set/Get whether the calculator's binned histogram spans the
+   * range percentiles of the pixels instead of their whole range.
+   * Default is false. */
+  virtual void SetClipHistogramRange(bool clip)
+    { m_Calculator->SetClipHistogramRange(clip); }
+  virtual bool GetClipHistogramRange() const
+    { return m_Calculator->GetClipHistogramRange(); }
+  itkBooleanMacro( ClipHistogramRange );
+
+  /** Set/Get the percentiles at the bounds of the clipped range.
+   * Defaults are 0.001 and 0.999. */
+  virtual void SetLowerRangePercentile(double percentile)
+    { m_Calculator->SetLowerRangePercentile(percentile); }
+  virtual double GetLowerRangePercentile() const
+    { return m_Calculator->GetLowerRangePercentile(); }
+  virtual void SetUpperRangePercentile(double percentile)
+    { m_Calculator->SetUpperRangePercentile(percentile); }
+  virtual double GetUpperRangePercentile() const
+    { return m_Calculator->GetUpperRangePercentile(); }
+
+  /** Set/Get the fixed range of the calculator's binned histogram,
+   * which saves computing the range of the input. */
+  virtual void SetHistogramRange(InputPixelType minimum, InputPixelType maximum)
+    { m_Calculator->SetHistogramRange(minimum, maximum); }
+  virtual InputPixelType GetHistogramMinimum() const
+    { return m_Calculator->GetHistogramMinimum(); }
+  virtual InputPixelType GetHistogramMaximum() const
+    { return m_Calculator->GetHistogramMaximum(); }
+
+  /** Set/Get whether the calculator uses the fixed range. Default is
+   * false. */
+  virtual void SetUseFixedHistogramRange(bool fixed)
+    { m_Calculator->SetUseFixedHistogramRange(fixed); }
+  virtual bool GetUseFixedHistogramRange() const
+    { return m_Calculator->GetUseFixedHistogramRange(); }
+  itkBooleanMacro( UseFixedHistogramRange );
+
+  /** Set/Get whether the pixels outside a fixed or clipped range are
+   * counted in the edge bins rather than left out. Default is true. */
+  virtual void SetClampToHistogramRange(bool clamp)
+    { m_Calculator->SetClampToHistogramRange(clamp); }
+  virtual bool GetClampToHistogramRange() const
+    { return m_Calculator->GetClampToHistogramRange(); }
+  itkBooleanMacro( ClampToHistogramRange );
+
+  /** Set/Get whether the mask is written to the bit mask instead of
+   * the output image. Default is false. */
+  itkSetMacro(UseBitMaskOutput, bool);
+  itkGetConstMacro(UseBitMaskOutput, bool);
+  itkBooleanMacro(UseBitMaskOutput);
+
+  /** Get the bit mask written when UseBitMaskOutput is on. */
+  BitMaskType * GetBitMask()
+    { return m_BitMask.GetPointer(); }
+
+  /** Set/Get whether the mask is written to the run length mask instead
+   * of the output image. Default is false. UseBitMaskOutput comes
+   * first when both are on. */
+  itkSetMacro(UseRunLengthOutput, bool);
+  itkGetConstMacro(UseRunLengthOutput, bool);
+  itkBooleanMacro(UseRunLengthOutput);
+
+  /** Get the run length mask written when UseRunLengthOutput is on. */
+  RunLengthMaskType * GetRunLengthMask()
+    { return m_RunLengthMask.GetPointer(); }
+
+  /** Set/Get whether the statistics of the two classes are computed
+   * while binarizing. Default is false. */
+  itkSetMacro(ComputeStatistics, bool);
+  itkGetConstMacro(ComputeStatistics, bool);
+  itkBooleanMacro(ComputeStatistics);
+
+  /** Number of pixels, mean and variance of the input pixels getting
+   * the InsideValue and the OutsideValue. Computed when
+   * ComputeStatistics is on. */
+  itkGetConstMacro(InsideCount, unsigned long);
+  itkGetConstMacro(InsideMean, double);
+  itkGetConstMacro(InsideVariance, double);
+  itkGetConstMacro(OutsideCount, unsigned long);
+  itkGetConstMacro(OutsideMean, double);
+  itkGetConstMacro(OutsideVariance, double);
+
+  /** Physical volume of the pixels getting the InsideValue. */
+  double GetInsideVolume() const;
+
+  /** Smallest region holding every pixel getting the InsideValue. Its
+   * size is null when there is no such pixel. */
+  itkGetConstReferenceMacro(InsideBoundingBox, OutputImageRegionType);
+
+  /** Get the computed threshold. */
+  itkGetConstMacro(Threshold,InputPixelType);
+
+  /** The modification time includes that of the calculator. */
+  unsigned long GetMTime() const;
+
+#ifdef ITK_USE_CONCEPT_CHECKING
+  /** Begin concept checking */
+  itkConceptMacro(OutputEqualityComparableCheck,
+    (Concept::EqualityComparable<OutputPixelType>));
+  itkConceptMacro(InputOStreamWritableCheck,
+    (Concept::OStreamWritable<InputPixelType>));
+  itkConceptMacro(OutputOStreamWritableCheck,
+    (Concept::OStreamWritable<OutputPixelType>));
+  /** End concept checking */
+#endif
+protected:
+  HistogramThresholdImageFilter();
+  ~HistogramThresholdImageFilter(){};
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  void GenerateInputRequestedRegion();
+  void EnlargeOutputRequestedRegion(DataObject * output);
+  void GenerateData ();
+
+  /** The output image is only allocated when no mask is written. */
+  void AllocateOutputs();
+
+  /** Split the output requested region into whole rows. */
+  int SplitRequestedRegion(int i, int num, OutputImageRegionType& splitRegion);
+
+  /** Binarize the rows of a thread into the bit mask. */
+  void BinarizeToBitMask(const OutputImageRegionType& outputRegionForThread,
+                         int threadId );
+
+  /** Binarize the rows of a thread into its own run length mask. */
+  void BinarizeToRunLength(const OutputImageRegionType& outputRegionForThread,
+                           int threadId );
+
+  /** Binarize the input, skipping the blocks of background, and
+   * gather the statistics of the classes, with one set of sums per
+   * thread. */
+  void BeforeThreadedGenerateData();
+  void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                            int threadId );
+  void AfterThreadedGenerateData();
+
+private:
+  HistogramThresholdImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  InputPixelType      m_Threshold;
+  OutputPixelType     m_InsideValue;
+  OutputPixelType     m_OutsideValue;
+  CalculatorPointer   m_Calculator;
+  bool                m_UseBitMaskOutput;
+  BitMaskPointer      m_BitMask;
+  bool                m_UseRunLengthOutput;
+  RunLengthMaskPointer m_RunLengthMask;
+
+  bool                m_ComputeStatistics;
+  unsigned long       m_InsideCount;
+  double              m_InsideMean;
+  double              m_InsideVariance;
+  unsigned long       m_OutsideCount;
+  double              m_OutsideMean;
+  double              m_OutsideVariance;
+  OutputImageRegionType m_InsideBoundingBox;
+
+  /** Input and time of the last threshold computed. */
+  const TInputImage * m_ThresholdInput;
+  TimeStamp           m_ThresholdTime;
+
+  /** Background of the input found by the calculator, if any. */
+  bool                m_UseBackground;
+  InputPixelType      m_Background;
+
+  /** Sums of a thread. */
+  struct ThreadStatistics
+    {
+    unsigned long   Count;
+    double          Sum;
+    double          SumOfSquares;
+    unsigned long   InsideCount;
+    double          InsideSum;
+    double          InsideSumOfSquares;
+    OutputIndexType InsideMinimum;
+    OutputIndexType InsideMaximum;
+    };
+  std::vector<ThreadStatistics> m_ThreadStatistics;
+  std::vector<RunLengthMaskPointer> m_ThreadRunLengthMasks;
+
+  /** Add the pixels of a row to the sums of a thread. */
+  void AccumulateRow(const InputPixelType * in, unsigned long rowLength,
+                     const InputIndexType & index, ThreadStatistics & stats) const;
+
+}; // end of class
+
+} // end namespace itk
+
+/** Define the Set/Get methods of a filter derived from
+ * HistogramThresholdImageFilter that forward a calculator setting. */
+#define itkSetCalculatorMacro(name,type) \
+  virtual void Set##name (const type _arg) \
+    { this->GetCalculator()->Set##name(_arg); }
+#define itkGetCalculatorMacro(name,type) \
+  virtual type Get##name () const \
+    { return this->GetCalculator()->Get##name(); }
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkHistogramThresholdImageFilter.txx"
+#endif
+
+#endif
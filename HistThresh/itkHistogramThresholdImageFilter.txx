@@ -0,0 +1,579 @@
+#ifndef __itkHistogramThresholdImageFilter_txx
+#define __itkHistogramThresholdImageFilter_txx
+#include "itkHistogramThresholdImageFilter.h"
+
+#include "itkBinaryThresholdImageFilter.h"
+#include "itkProgressAccumulator.h"
+#include "itkProgressReporter.h"
+#include "itkImageLinearConstIteratorWithIndex.h"
+#include "itkThresholdHistogramFill.h"
+
+namespace itk {
+
+template<class TInputImage, class TOutputImage, class TCalculator>
+HistogramThresholdImageFilter<TInputImage, TOutputImage, TCalculator>
+::HistogramThresholdImageFilter()
+{
+  m_OutsideValue   = NumericTraits<OutputPixelType>::Zero;
+  m_InsideValue    = NumericTraits<OutputPixelType>::max();
+  m_Threshold      = NumericTraits<InputPixelType>::Zero;
+  m_Calculator     = CalculatorType::New();
+  m_UseBitMaskOutput = false;
+  m_BitMask        = BitMaskType::New();
+  m_UseRunLengthOutput = false;
+  m_RunLengthMask  = RunLengthMaskType::New();
+  m_ComputeStatistics = false;
+  m_InsideCount    = 0;
+  m_InsideMean     = 0.0;
+  m_InsideVariance = 0.0;
+  m_OutsideCount   = 0;
+  m_OutsideMean    = 0.0;
+  m_OutsideVariance = 0.0;
+  m_UseBackground  = false;
+  m_Background     = NumericTraits<InputPixelType>::Zero;
+  m_ThresholdInput = 0;
+}
+
+template<class TInputImage, class TOutputImage, class TCalculator>
+void
+HistogramThresholdImageFilter<TInputImage, TOutputImage, TCalculator>
+::GenerateData()
+{
+  typename ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
+  progress->SetMiniPipelineFilter(this);
+
+  // Compute the threshold for the input image. The reentrant form
+  // leaves the calculator, and so the filter's MTime, untouched. A
+  // streamed output runs the filter once per piece on the same input,
+  // so the threshold of the last run is kept as long as neither the
+  // input nor the filter and its calculator have changed since.
+  const TInputImage * input = this->GetInput();
+  if ( input != m_ThresholdInput
+       || m_ThresholdTime.GetMTime() < input->GetMTime()
+       || m_ThresholdTime.GetMTime() < this->GetMTime() )
+    {
+    m_Calculator->SetDebug(this->GetDebug());
+    typename CalculatorType::ResultType result =
+      m_Calculator->ComputeThreshold(input, input->GetRequestedRegion());
+    m_Threshold = result.Valid ? result.Threshold
+      : NumericTraits<InputPixelType>::Zero;
+    m_ThresholdInput = input;
+    m_ThresholdTime.Modified();
+    }
+
+  if ( m_UseBitMaskOutput || m_UseRunLengthOutput )
+    {
+    // the threaded pass of the superclass, writing the mask instead of
+    // the output image
+    Superclass::GenerateData();
+    return;
+    }
+
+  // the threaded pass of the superclass, calling ThreadedGenerateData(),
+  // binarizes the image itself when it gathers the statistics or skips
+  // the blocks of background
+  m_UseBackground = m_Calculator->ComputeBackgroundValue( this->GetInput(),
+    this->GetInput()->GetRequestedRegion(), m_Background );
+  if ( m_ComputeStatistics || m_UseBackground )
+    {
+    Superclass::GenerateData();
+    return;
+    }
+
+  typename BinaryThresholdImageFilter<TInputImage,TOutputImage>::Pointer threshold =
+    BinaryThresholdImageFilter<TInputImage,TOutputImage>::New();
+
+  progress->RegisterInternalFilter(threshold,.5f);
+  threshold->GraftOutput (this->GetOutput());
+  threshold->SetInput (this->GetInput());
+  threshold->SetLowerThreshold(NumericTraits<InputPixelType>::NonpositiveMin());
+  threshold->SetUpperThreshold(m_Threshold);
+  threshold->SetInsideValue (m_InsideValue);
+  threshold->SetOutsideValue (m_OutsideValue);
+  threshold->Update();
+
+  this->GraftOutput(threshold->GetOutput());
+}
+
+template<class TInputImage, class TOutputImage, class TCalculator>
+void
+HistogramThresholdImageFilter<TInputImage, TOutputImage, TCalculator>
+::AllocateOutputs()
+{
+  // the masks are written instead of the output image
+  if ( m_UseBitMaskOutput || m_UseRunLengthOutput )
+    {
+    return;
+    }
+  Superclass::AllocateOutputs();
+}
+
+template<class TInputImage, class TOutputImage, class TCalculator>
+int
+HistogramThresholdImageFilter<TInputImage, TOutputImage, TCalculator>
+::SplitRequestedRegion(int i, int num, OutputImageRegionType& splitRegion)
+{
+  // each thread gets whole rows, so that the rows it packs start on
+  // words of their own and the runs of a row are found by one thread
+  const OutputImageRegionType requested = this->GetOutput()->GetRequestedRegion();
+  const int total = Superclass::SplitRequestedRegion( i, num, splitRegion );
+  if ( splitRegion.GetSize()[0] != requested.GetSize()[0] )
+    {
+    splitRegion = requested;
+    return 1;
+    }
+  return total;
+}
+
+template<class TInputImage, class TOutputImage, class TCalculator>
+void
+HistogramThresholdImageFilter<TInputImage, TOutputImage, TCalculator>
+::BinarizeToBitMask(const OutputImageRegionType& outputRegionForThread,
+                    int threadId )
+{
+  const TInputImage * input = this->GetInput();
+  const InputPixelType lower = NumericTraits<InputPixelType>::NonpositiveMin();
+  const ThresholdHistogramFill::KernelType kernel =
+    ThresholdHistogramFill::GetKernel();
+  const unsigned long rowLength = outputRegionForThread.GetSize()[0];
+  const InputPixelType * inputBuffer = input->GetBufferPointer();
+
+  ProgressReporter progress( this, threadId,
+                             outputRegionForThread.GetNumberOfPixels() / rowLength );
+
+  ImageLinearConstIteratorWithIndex<TInputImage> iter( input, outputRegionForThread );
+  iter.SetDirection( 0 );
+
+  while ( !iter.IsAtEnd() )
+    {
+    const InputIndexType index = iter.GetIndex();
+    const InputPixelType * in = inputBuffer + input->ComputeOffset( index );
+    ThresholdHistogramFill::PackRow( kernel, in, rowLength, lower,
+                                     m_Threshold, m_BitMask->GetRow( index ) );
+    if ( m_ComputeStatistics )
+      {
+      this->AccumulateRow( in, rowLength, index, m_ThreadStatistics[threadId] );
+      }
+    iter.NextLine();
+    progress.CompletedPixel();
+    }
+}
+
+template<class TInputImage, class TOutputImage, class TCalculator>
+void
+HistogramThresholdImageFilter<TInputImage, TOutputImage, TCalculator>
+::BinarizeToRunLength(const OutputImageRegionType& outputRegionForThread,
+                      int threadId )
+{
+  const TInputImage * input = this->GetInput();
+  RunLengthMaskType * mask = m_ThreadRunLengthMasks[threadId];
+  const InputPixelType lower = NumericTraits<InputPixelType>::NonpositiveMin();
+  const ThresholdHistogramFill::KernelType kernel =
+    ThresholdHistogramFill::GetKernel();
+  const unsigned long rowLength = outputRegionForThread.GetSize()[0];
+  const InputPixelType * inputBuffer = input->GetBufferPointer();
+
+  // each row is packed into bits as for the bit mask, and the runs are
+  // read from the words, skipping the words with no change
+  std::vector<typename RunLengthMaskType::WordType> words(
+    ( rowLength + RunLengthMaskType::BitsPerWord - 1 )
+    / RunLengthMaskType::BitsPerWord );
+
+  ProgressReporter progress( this, threadId,
+                             outputRegionForThread.GetNumberOfPixels() / rowLength );
+
+  ImageLinearConstIteratorWithIndex<TInputImage> iter( input, outputRegionForThread );
+  iter.SetDirection( 0 );
+
+  while ( !iter.IsAtEnd() )
+    {
+    const InputIndexType index = iter.GetIndex();
+    const InputPixelType * in = inputBuffer + input->ComputeOffset( index );
+    ThresholdHistogramFill::PackRow( kernel, in, rowLength, lower,
+                                     m_Threshold, &words[0] );
+    mask->AppendRow( &words[0], rowLength );
+    if ( m_ComputeStatistics )
+      {
+      this->AccumulateRow( in, rowLength, index, m_ThreadStatistics[threadId] );
+      }
+    iter.NextLine();
+    progress.CompletedPixel();
+    }
+}
+
+template<class TInputImage, class TOutputImage, class TCalculator>
+void
+HistogramThresholdImageFilter<TInputImage, TOutputImage, TCalculator>
+::AccumulateRow(const InputPixelType * in, unsigned long rowLength,
+                const InputIndexType & index, ThreadStatistics & stats) const
+{
+  const InputPixelType lower = NumericTraits<InputPixelType>::NonpositiveMin();
+  double sum = 0.0;
+  double sumOfSquares = 0.0;
+  double insideSum = 0.0;
+  double insideSumOfSquares = 0.0;
+  unsigned long insideCount = 0;
+  long first = -1;
+  long last = -1;
+  for ( unsigned long i = 0; i < rowLength; i++ )
+    {
+    const double value = static_cast<double>( in[i] );
+    sum += value;
+    sumOfSquares += value * value;
+    if ( lower <= in[i] && in[i] <= m_Threshold )
+      {
+      insideSum += value;
+      insideSumOfSquares += value * value;
+      insideCount++;
+      if ( first < 0 )
+        {
+        first = i;
+        }
+      last = i;
+      }
+    }
+
+  stats.Count += rowLength;
+  stats.Sum += sum;
+  stats.SumOfSquares += sumOfSquares;
+  if ( insideCount > 0 )
+    {
+    stats.InsideCount += insideCount;
+    stats.InsideSum += insideSum;
+    stats.InsideSumOfSquares += insideSumOfSquares;
+    stats.InsideMinimum[0] = std::min( stats.InsideMinimum[0], index[0] + first );
+    stats.InsideMaximum[0] = std::max( stats.InsideMaximum[0], index[0] + last );
+    for ( unsigned int d = 1; d < OutputImageDimension; d++ )
+      {
+      stats.InsideMinimum[d] = std::min( stats.InsideMinimum[d], index[d] );
+      stats.InsideMaximum[d] = std::max( stats.InsideMaximum[d], index[d] );
+      }
+    }
+}
+
+template<class TInputImage, class TOutputImage, class TCalculator>
+void
+HistogramThresholdImageFilter<TInputImage, TOutputImage, TCalculator>
+::BeforeThreadedGenerateData()
+{
+  ThreadStatistics empty;
+  empty.Count = 0;
+  empty.Sum = 0.0;
+  empty.SumOfSquares = 0.0;
+  empty.InsideCount = 0;
+  empty.InsideSum = 0.0;
+  empty.InsideSumOfSquares = 0.0;
+  empty.InsideMinimum.Fill( NumericTraits<long>::max() );
+  empty.InsideMaximum.Fill( NumericTraits<long>::NonpositiveMin() );
+  m_ThreadStatistics.assign( this->GetNumberOfThreads(), empty );
+
+  if ( m_UseBitMaskOutput )
+    {
+    m_BitMask->CopyInformation( this->GetOutput() );
+    m_BitMask->SetOnValue( static_cast<unsigned char>( m_InsideValue ) );
+    m_BitMask->SetOffValue( static_cast<unsigned char>( m_OutsideValue ) );
+    m_BitMask->Allocate();
+    }
+  else if ( m_UseRunLengthOutput )
+    {
+    m_RunLengthMask->CopyInformation( this->GetOutput() );
+    m_RunLengthMask->SetOnValue( static_cast<unsigned char>( m_InsideValue ) );
+    m_RunLengthMask->SetOffValue( static_cast<unsigned char>( m_OutsideValue ) );
+    m_RunLengthMask->Clear();
+
+    // the rows of each thread, joined in order afterwards
+    m_ThreadRunLengthMasks.resize( this->GetNumberOfThreads() );
+    for ( unsigned int t = 0; t < m_ThreadRunLengthMasks.size(); t++ )
+      {
+      m_ThreadRunLengthMasks[t] = RunLengthMaskType::New();
+      }
+    }
+}
+
+template<class TInputImage, class TOutputImage, class TCalculator>
+void
+HistogramThresholdImageFilter<TInputImage, TOutputImage, TCalculator>
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                       int threadId )
+{
+  if ( m_UseBitMaskOutput )
+    {
+    this->BinarizeToBitMask( outputRegionForThread, threadId );
+    return;
+    }
+  if ( m_UseRunLengthOutput )
+    {
+    this->BinarizeToRunLength( outputRegionForThread, threadId );
+    return;
+    }
+
+  const TInputImage * input = this->GetInput();
+  TOutputImage * output = this->GetOutput();
+  ThreadStatistics & stats = m_ThreadStatistics[threadId];
+
+  // same test as the BinaryThresholdImageFilter
+  const InputPixelType lower = NumericTraits<InputPixelType>::NonpositiveMin();
+  const unsigned long rowLength = outputRegionForThread.GetSize()[0];
+  const InputPixelType * inputBuffer = input->GetBufferPointer();
+  OutputPixelType * outputBuffer = output->GetBufferPointer();
+
+  // blocks made only of the background are found by comparing whole
+  // vectors, and labelled and summed in one go
+  const ThresholdHistogramFill::KernelType kernel =
+    ThresholdHistogramFill::GetKernel();
+  const unsigned long blockLength = m_UseBackground ? 64 : rowLength;
+  const bool backgroundInside =
+    lower <= m_Background && m_Background <= m_Threshold;
+  const OutputPixelType backgroundLabel =
+    backgroundInside ? m_InsideValue : m_OutsideValue;
+  const double backgroundValue = static_cast<double>( m_Background );
+
+  ProgressReporter progress( this, threadId,
+                             outputRegionForThread.GetNumberOfPixels() / rowLength );
+
+  ImageLinearConstIteratorWithIndex<TOutputImage> iter( output, outputRegionForThread );
+  iter.SetDirection( 0 );
+
+  while ( !iter.IsAtEnd() )
+    {
+    const OutputIndexType index = iter.GetIndex();
+    const InputPixelType * in = inputBuffer + input->ComputeOffset( index );
+    OutputPixelType * out = outputBuffer + output->ComputeOffset( index );
+    double sum = 0.0;
+    double sumOfSquares = 0.0;
+    double insideSum = 0.0;
+    double insideSumOfSquares = 0.0;
+    unsigned long insideCount = 0;
+    long first = -1;
+    long last = -1;
+    for ( unsigned long b = 0; b < rowLength; b += blockLength )
+      {
+      const unsigned long length = std::min( blockLength, rowLength - b );
+      if ( m_UseBackground &&
+           ThresholdHistogramFill::CountValue( kernel, in + b, length,
+                                               m_Background ) == length )
+        {
+        std::fill( out + b, out + b + length, backgroundLabel );
+        sum += length * backgroundValue;
+        sumOfSquares += length * backgroundValue * backgroundValue;
+        if ( backgroundInside )
+          {
+          insideSum += length * backgroundValue;
+          insideSumOfSquares += length * backgroundValue * backgroundValue;
+          insideCount += length;
+          if ( first < 0 )
+            {
+            first = b;
+            }
+          last = b + length - 1;
+          }
+        continue;
+        }
+      if ( !m_ComputeStatistics )
+        {
+        for ( unsigned long i = b; i < b + length; i++ )
+          {
+          out[i] = ( lower <= in[i] && in[i] <= m_Threshold ) ?
+            m_InsideValue : m_OutsideValue;
+          }
+        continue;
+        }
+      for ( unsigned long i = b; i < b + length; i++ )
+        {
+        const double value = static_cast<double>( in[i] );
+        sum += value;
+        sumOfSquares += value * value;
+        if ( lower <= in[i] && in[i] <= m_Threshold )
+          {
+          out[i] = m_InsideValue;
+          insideSum += value;
+          insideSumOfSquares += value * value;
+          insideCount++;
+          if ( first < 0 )
+            {
+            first = i;
+            }
+          last = i;
+          }
+        else
+          {
+          out[i] = m_OutsideValue;
+          }
+        }
+      }
+
+    stats.Count += rowLength;
+    stats.Sum += sum;
+    stats.SumOfSquares += sumOfSquares;
+    if ( insideCount > 0 )
+      {
+      stats.InsideCount += insideCount;
+      stats.InsideSum += insideSum;
+      stats.InsideSumOfSquares += insideSumOfSquares;
+      stats.InsideMinimum[0] = std::min( stats.InsideMinimum[0], index[0] + first );
+      stats.InsideMaximum[0] = std::max( stats.InsideMaximum[0], index[0] + last );
+      for ( unsigned int d = 1; d < OutputImageDimension; d++ )
+        {
+        stats.InsideMinimum[d] = std::min( stats.InsideMinimum[d], index[d] );
+        stats.InsideMaximum[d] = std::max( stats.InsideMaximum[d], index[d] );
+        }
+      }
+    iter.NextLine();
+    progress.CompletedPixel();
+    }
+}
+
+template<class TInputImage, class TOutputImage, class TCalculator>
+void
+HistogramThresholdImageFilter<TInputImage, TOutputImage, TCalculator>
+::AfterThreadedGenerateData()
+{
+  if ( m_UseBitMaskOutput )
+    {
+    m_BitMask->Modified();
+    }
+  else if ( m_UseRunLengthOutput )
+    {
+    for ( unsigned int t = 0; t < m_ThreadRunLengthMasks.size(); t++ )
+      {
+      m_RunLengthMask->AppendRows( m_ThreadRunLengthMasks[t] );
+      }
+    m_ThreadRunLengthMasks.clear();
+    m_RunLengthMask->Modified();
+    }
+
+  ThreadStatistics total = m_ThreadStatistics[0];
+  for ( unsigned int t = 1; t < m_ThreadStatistics.size(); t++ )
+    {
+    const ThreadStatistics & stats = m_ThreadStatistics[t];
+    total.Count += stats.Count;
+    total.Sum += stats.Sum;
+    total.SumOfSquares += stats.SumOfSquares;
+    total.InsideCount += stats.InsideCount;
+    total.InsideSum += stats.InsideSum;
+    total.InsideSumOfSquares += stats.InsideSumOfSquares;
+    for ( unsigned int d = 0; d < OutputImageDimension; d++ )
+      {
+      total.InsideMinimum[d] = std::min( total.InsideMinimum[d], stats.InsideMinimum[d] );
+      total.InsideMaximum[d] = std::max( total.InsideMaximum[d], stats.InsideMaximum[d] );
+      }
+    }
+  m_ThreadStatistics.clear();
+  if ( !m_ComputeStatistics )
+    {
+    return;
+    }
+
+  // unbiased variances, as in the LabelStatisticsImageFilter
+  const unsigned long outsideCount = total.Count - total.InsideCount;
+  const double outsideSum = total.Sum - total.InsideSum;
+  const double outsideSumOfSquares = total.SumOfSquares - total.InsideSumOfSquares;
+
+  m_InsideCount = total.InsideCount;
+  m_InsideMean = m_InsideCount > 0 ? total.InsideSum / m_InsideCount : 0.0;
+  m_InsideVariance = m_InsideCount > 1 ?
+    ( total.InsideSumOfSquares - total.InsideSum * total.InsideSum / m_InsideCount )
+    / ( m_InsideCount - 1 ) : 0.0;
+  m_OutsideCount = outsideCount;
+  m_OutsideMean = m_OutsideCount > 0 ? outsideSum / m_OutsideCount : 0.0;
+  m_OutsideVariance = m_OutsideCount > 1 ?
+    ( outsideSumOfSquares - outsideSum * outsideSum / m_OutsideCount )
+    / ( m_OutsideCount - 1 ) : 0.0;
+
+  OutputIndexType index;
+  OutputSizeType size;
+  index.Fill( 0 );
+  size.Fill( 0 );
+  if ( m_InsideCount > 0 )
+    {
+    for ( unsigned int d = 0; d < OutputImageDimension; d++ )
+      {
+      index[d] = total.InsideMinimum[d];
+      size[d] = total.InsideMaximum[d] - total.InsideMinimum[d] + 1;
+      }
+    }
+  m_InsideBoundingBox.SetIndex( index );
+  m_InsideBoundingBox.SetSize( size );
+}
+
+template<class TInputImage, class TOutputImage, class TCalculator>
+double
+HistogramThresholdImageFilter<TInputImage, TOutputImage, TCalculator>
+::GetInsideVolume() const
+{
+  double volume = m_InsideCount;
+  for ( unsigned int d = 0; d < InputImageDimension; d++ )
+    {
+    volume *= this->GetInput()->GetSpacing()[d];
+    }
+  return volume;
+}
+
+template<class TInputImage, class TOutputImage, class TCalculator>
+void
+HistogramThresholdImageFilter<TInputImage, TOutputImage, TCalculator>
+::GenerateInputRequestedRegion()
+{
+  TInputImage * input = const_cast<TInputImage *>(this->GetInput());
+  if( input )
+    {
+    input->SetRequestedRegionToLargestPossibleRegion();
+    }
+}
+
+template<class TInputImage, class TOutputImage, class TCalculator>
+void
+HistogramThresholdImageFilter<TInputImage, TOutputImage, TCalculator>
+::EnlargeOutputRequestedRegion(DataObject * output)
+{
+  // the statistics and the masks cover the whole image: the sums and
+  // the masks would start over for each piece of a streamed output
+  if ( m_ComputeStatistics || m_UseBitMaskOutput || m_UseRunLengthOutput )
+    {
+    output->SetRequestedRegionToLargestPossibleRegion();
+    return;
+    }
+  Superclass::EnlargeOutputRequestedRegion( output );
+}
+
+template<class TInputImage, class TOutputImage, class TCalculator>
+unsigned long
+HistogramThresholdImageFilter<TInputImage, TOutputImage, TCalculator>
+::GetMTime() const
+{
+  unsigned long mtime = Superclass::GetMTime();
+  unsigned long calculatorMTime = m_Calculator->GetMTime();
+  return ( calculatorMTime > mtime ? calculatorMTime : mtime );
+}
+
+template<class TInputImage, class TOutputImage, class TCalculator>
+void
+HistogramThresholdImageFilter<TInputImage,TOutputImage,TCalculator>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf(os,indent);
+
+  os << indent << "OutsideValue: "
+     << static_cast<typename NumericTraits<OutputPixelType>::PrintType>(m_OutsideValue) << std::endl;
+  os << indent << "InsideValue: "
+     << static_cast<typename NumericTraits<OutputPixelType>::PrintType>(m_InsideValue) << std::endl;
+  os << indent << "Threshold (computed): "
+     << static_cast<typename NumericTraits<InputPixelType>::PrintType>(m_Threshold) << std::endl;
+  os << indent << "UseBitMaskOutput: " << m_UseBitMaskOutput << std::endl;
+  os << indent << "UseRunLengthOutput: " << m_UseRunLengthOutput << std::endl;
+  os << indent << "ComputeStatistics: " << m_ComputeStatistics << std::endl;
+  os << indent << "InsideCount: " << m_InsideCount << std::endl;
+  os << indent << "InsideMean: " << m_InsideMean << std::endl;
+  os << indent << "InsideVariance: " << m_InsideVariance << std::endl;
+  os << indent << "OutsideCount: " << m_OutsideCount << std::endl;
+  os << indent << "OutsideMean: " << m_OutsideMean << std::endl;
+  os << indent << "OutsideVariance: " << m_OutsideVariance << std::endl;
+  os << indent << "InsideBoundingBox: " << m_InsideBoundingBox << std::endl;
+  os << indent << "Calculator: " << std::endl;
+  m_Calculator->Print(os,indent.GetNextIndent());
+
+}
+
+
+}// end namespace itk
+#endif
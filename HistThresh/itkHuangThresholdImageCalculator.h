@@ -2,9 +2,7 @@
 #ifndef __itkHuangThresholdImageCalculator_h
 #define __itkHuangThresholdImageCalculator_h
 
-#include "itkObject.h"
-#include "itkObjectFactory.h"
-#include "itkNumericTraits.h"
+#include "itkHistogramThresholdImageCalculator.h"
 
 namespace itk
 {
@@ -29,12 +27,13 @@ namespace itk
  * \ingroup Operators
  */
 template <class TInputImage>
-class ITK_EXPORT HuangThresholdImageCalculator : public Object 
+class ITK_EXPORT HuangThresholdImageCalculator :
+    public HistogramThresholdImageCalculator<TInputImage>
 {
 public:
   /** Standard class typedefs. */
   typedef HuangThresholdImageCalculator Self;
-  typedef Object                       Superclass;
+  typedef HistogramThresholdImageCalculator<TInputImage> Superclass;
   typedef SmartPointer<Self>           Pointer;
   typedef SmartPointer<const Self>     ConstPointer;
 
@@ -42,54 +41,35 @@ public:
   itkNewMacro(Self);
 
   /** Run-time type information (and related methods). */
-  itkTypeMacro(HuangThresholdImageCalculator, Object);
+  itkTypeMacro(HuangThresholdImageCalculator, HistogramThresholdImageCalculator);
 
   /** Type definition for the input image. */
   typedef TInputImage  ImageType;
 
-  /** Pointer type for the image. */
-  typedef typename TInputImage::Pointer  ImagePointer;
-  
-  /** Const Pointer type for the image. */
-  typedef typename TInputImage::ConstPointer ImageConstPointer;
-
   /** Type definition for the input image pixel type. */
-  typedef typename TInputImage::PixelType PixelType;
-  
-  /** Type definition for the input image region type. */
-  typedef typename TInputImage::RegionType RegionType;
-  
-  /** Set the input image. */
-  itkSetConstObjectMacro(Image,ImageType);
-
-  /** Compute the Huang's threshold for the input image. */
-  void Compute(void);
-
-  /** Return the Huang's threshold value. */
-  itkGetConstMacro(Threshold,PixelType);
-  
-  /** Set/Get the number of histogram bins. Default is 128. */
-  itkSetClampMacro( NumberOfHistogramBins, unsigned long, 1, 
-                    NumericTraits<unsigned long>::max() );
-  itkGetConstMacro( NumberOfHistogramBins, unsigned long );
-
-  /** Set the region over which the values will be computed */
-  void SetRegion( const RegionType & region );
+  typedef typename Superclass::PixelType PixelType;
+
+  /** Type definition for the histogram. */
+  typedef typename Superclass::HistogramType HistogramType;
+
+  /** Type definition for the working arrays of the criterion. */
+  typedef typename Superclass::ScratchArrayType ScratchArrayType;
 
 protected:
-  HuangThresholdImageCalculator();
+  HuangThresholdImageCalculator() {};
   virtual ~HuangThresholdImageCalculator() {};
-  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  /** Compute the Huang's threshold from the histogram. */
+  bool ComputeThresholdFromHistogram(const HistogramType & histogram,
+                                     PixelType & threshold) const;
+
+  /** Entropy summand for a distance x from the class mean, looked up
+   * in Smu for whole bin distances. */
+  double Summand(const ScratchArrayType & Smu, double x, double C) const;
 
 private:
   HuangThresholdImageCalculator(const Self&); //purposely not implemented
   void operator=(const Self&); //purposely not implemented
-  
-  PixelType            m_Threshold;
-  unsigned long        m_NumberOfHistogramBins;
-  ImageConstPointer    m_Image;
-  RegionType           m_Region;
-  bool                 m_RegionSetByUser;
 
 };
 
@@ -0,0 +1,80 @@
+
+#ifndef __itkIJIsoDataThresholdImageCalculator_h
+#define __itkIJIsoDataThresholdImageCalculator_h
+
+#include "itkHistogramThresholdImageCalculator.h"
+
+namespace itk
+{
+
+/** \class IJIsoDataThresholdImageCalculator
+ * \brief Computes the threshold of the original ImageJ "Default"
+ * method for an image.
+ *
+ * This is the iterative intermeans variant of IsoData used by ImageJ's
+ * Image>Adjust>Threshold, kept for compatibility: starting from the
+ * lowest occupied level, the split is moved up until it passes the
+ * average of the means of the two classes, and that average is the
+ * threshold.
+ *
+ * T.W. Ridler, S. Calvard, "Picture thresholding using an iterative
+ * selection method," IEEE Trans. System, Man and Cybernetics, SMC-8
+ * (1978) 630-632.
+ *
+ * Ported from the ImageJ implementation. http://pacific.mpi-cbg.de/wiki/index.php/Auto_Threshold
+ *
+ * This class is templated over the input image type.
+ * \author Richard Beare
+ * \warning This method assumes that the input image consists of scalar pixel
+ * types.
+ *
+ * \ingroup Operators
+ */
+template <class TInputImage>
+class ITK_EXPORT IJIsoDataThresholdImageCalculator :
+    public HistogramThresholdImageCalculator<TInputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef IJIsoDataThresholdImageCalculator Self;
+  typedef HistogramThresholdImageCalculator<TInputImage> Superclass;
+  typedef SmartPointer<Self>           Pointer;
+  typedef SmartPointer<const Self>     ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(IJIsoDataThresholdImageCalculator, HistogramThresholdImageCalculator);
+
+  /** Type definition for the input image. */
+  typedef TInputImage  ImageType;
+
+  /** Type definition for the input image pixel type. */
+  typedef typename Superclass::PixelType PixelType;
+
+  /** Type definition for the histogram. */
+  typedef typename Superclass::HistogramType HistogramType;
+
+protected:
+  IJIsoDataThresholdImageCalculator() {};
+  virtual ~IJIsoDataThresholdImageCalculator() {};
+
+  /** Compute the IJIsoData threshold from the histogram. */
+  bool ComputeThresholdFromHistogram(const HistogramType & histogram,
+                                     PixelType & threshold) const;
+
+private:
+  IJIsoDataThresholdImageCalculator(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+};
+
+} // end namespace itk
+
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkIJIsoDataThresholdImageCalculator.txx"
+#endif
+
+#endif
@@ -0,0 +1,74 @@
+
+#ifndef __itkIJIsoDataThresholdImageCalculator_txx
+#define __itkIJIsoDataThresholdImageCalculator_txx
+
+#include "itkIJIsoDataThresholdImageCalculator.h"
+
+#include "vnl/vnl_math.h"
+
+namespace itk
+{
+
+/*
+ * Compute the IJIsoData threshold
+ */
+template<class TInputImage>
+bool
+IJIsoDataThresholdImageCalculator<TInputImage>
+::ComputeThresholdFromHistogram(const HistogramType & histogram,
+                                PixelType & thresholdValue) const
+{
+  const std::vector<double> & data = histogram.GetFrequencies();
+  const std::vector<double> & position = histogram.GetPositions();
+
+  // first and last occupied entries
+  unsigned long min = 0;
+  while ( ( data[min] == 0 ) && ( min + 1 < data.size() ) )
+    min++;
+  unsigned long max = data.size() - 1;
+  while ( ( data[max] == 0 ) && ( max > 0 ) )
+    max--;
+  if ( min >= max )
+    {
+    thresholdValue = histogram.PositionToThreshold( histogram.GetNumberOfBins() / 2 );
+    return true;
+    }
+
+  // The ImageJ code moves the split up a bin at a time and recomputes
+  // both class sums. Here the sums are running, and the split jumps
+  // from one occupied entry to the next: the class means don't change
+  // over the empty bins in between, so only the stopping test needs to
+  // look at the bin before the next entry.
+  double sum1 = 0, sum2 = 0, sum3 = 0, sum4 = 0;
+  for (unsigned long i = min; i <= max; i++)
+    {
+    sum3 += position[i] * data[i];
+    sum4 += data[i];
+    }
+
+  double result = 0;
+  unsigned long movingIndex = min;
+  while ( true )
+    {
+    sum1 += position[movingIndex] * data[movingIndex];
+    sum2 += data[movingIndex];
+    sum3 -= position[movingIndex] * data[movingIndex];
+    sum4 -= data[movingIndex];
+    result = ( sum1 / sum2 + sum3 / sum4 ) / 2.0;
+
+    const double next = position[movingIndex + 1];
+    if ( next + 1 > result || next >= position[max] - 1 )
+      {
+      break;
+      }
+    movingIndex++;
+    }
+
+  thresholdValue = histogram.PositionToThreshold( vcl_floor( result + 0.5 ) );
+  return true;
+
+}
+
+} // end namespace itk
+
+#endif
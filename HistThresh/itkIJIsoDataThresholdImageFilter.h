@@ -0,0 +1,59 @@
+
+#ifndef __itkIJIsoDataThresholdImageFilter_h
+#define __itkIJIsoDataThresholdImageFilter_h
+
+#include "itkHistogramThresholdImageFilter.h"
+#include "itkIJIsoDataThresholdImageCalculator.h"
+
+namespace itk {
+
+/** \class IJIsoDataThresholdImageFilter 
+ * \brief Threshold an image using the IJIsoData Threshold
+ *
+ * This filter creates a binary thresholded image that separates an
+ * image into foreground and background components. The filter
+ * computes the threshold using the IJIsoDataThresholdImageCalculator and
+ * applies that theshold to the input image using the
+ * BinaryThresholdImageFilter. The NunberOfHistogram bins can be set
+ * for the Calculator. The InsideValue and OutsideValue can be set
+ * for the BinaryThresholdImageFilter. Code derived from OtsuThresholdImageFilter
+ *
+ * \sa IJIsoDataThresholdImageCalculator
+ * \sa HistogramThresholdImageFilter
+ * \sa BinaryThresholdImageFilter 
+ * \sa OtsuThresholdImageFilter
+ * \ingroup IntensityImageFilters  Multithreaded
+ */
+
+template<class TInputImage, class TOutputImage>
+class ITK_EXPORT IJIsoDataThresholdImageFilter :
+    public HistogramThresholdImageFilter<TInputImage, TOutputImage,
+                                         IJIsoDataThresholdImageCalculator<TInputImage> >
+{
+public:
+  /** Standard Self typedef */
+  typedef IJIsoDataThresholdImageFilter                      Self;
+  typedef HistogramThresholdImageFilter<TInputImage, TOutputImage,
+    IJIsoDataThresholdImageCalculator<TInputImage> >        Superclass;
+  typedef SmartPointer<Self>                            Pointer;
+  typedef SmartPointer<const Self>                      ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(IJIsoDataThresholdImageFilter, HistogramThresholdImageFilter);
+
+protected:
+  IJIsoDataThresholdImageFilter() {};
+  ~IJIsoDataThresholdImageFilter(){};
+
+private:
+  IJIsoDataThresholdImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+}; // end of class
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,80 @@
+
+#ifndef __itkIJOtsuThresholdImageCalculator_h
+#define __itkIJOtsuThresholdImageCalculator_h
+
+#include "itkHistogramThresholdImageCalculator.h"
+
+namespace itk
+{
+
+/** \class IJOtsuThresholdImageCalculator
+ * \brief Computes the Otsu threshold for an image, as ImageJ does.
+ *
+ * N. Otsu, "A threshold selection method from gray-level histograms,"
+ * IEEE Transactions on Systems, Man and Cybernetics, vol. 9, pp. 62-66, 1979.
+ *
+ * The threshold maximises the between class variance. Ties go to the
+ * highest candidate, as in the ImageJ plugin. Unlike the
+ * OtsuThresholdImageCalculator of ITK, the threshold is mapped back to
+ * an intensity the same way as the other calculators in this package.
+ *
+ * C++ code by Jordan Bevik <Jordan.Bevic@qtiworld.com>
+ * ported to ImageJ plugin by G.Landini
+ *
+ * Ported from the ImageJ implementation. http://pacific.mpi-cbg.de/wiki/index.php/Auto_Threshold
+ *
+ * This class is templated over the input image type.
+ * \author Richard Beare
+ * \warning This method assumes that the input image consists of scalar pixel
+ * types.
+ *
+ * \ingroup Operators
+ */
+template <class TInputImage>
+class ITK_EXPORT IJOtsuThresholdImageCalculator :
+    public HistogramThresholdImageCalculator<TInputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef IJOtsuThresholdImageCalculator Self;
+  typedef HistogramThresholdImageCalculator<TInputImage> Superclass;
+  typedef SmartPointer<Self>           Pointer;
+  typedef SmartPointer<const Self>     ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(IJOtsuThresholdImageCalculator, HistogramThresholdImageCalculator);
+
+  /** Type definition for the input image. */
+  typedef TInputImage  ImageType;
+
+  /** Type definition for the input image pixel type. */
+  typedef typename Superclass::PixelType PixelType;
+
+  /** Type definition for the histogram. */
+  typedef typename Superclass::HistogramType HistogramType;
+
+protected:
+  IJOtsuThresholdImageCalculator() {};
+  virtual ~IJOtsuThresholdImageCalculator() {};
+
+  /** Compute the IJOtsu threshold from the histogram. */
+  bool ComputeThresholdFromHistogram(const HistogramType & histogram,
+                                     PixelType & threshold) const;
+
+private:
+  IJOtsuThresholdImageCalculator(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+};
+
+} // end namespace itk
+
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkIJOtsuThresholdImageCalculator.txx"
+#endif
+
+#endif
@@ -0,0 +1,85 @@
+
+#ifndef __itkIJOtsuThresholdImageCalculator_txx
+#define __itkIJOtsuThresholdImageCalculator_txx
+
+#include "itkIJOtsuThresholdImageCalculator.h"
+
+#include "vnl/vnl_math.h"
+
+namespace itk
+{
+
+/*
+ * Compute the IJOtsu threshold
+ */
+template<class TInputImage>
+bool
+IJOtsuThresholdImageCalculator<TInputImage>
+::ComputeThresholdFromHistogram(const HistogramType & histogram,
+                                PixelType & thresholdValue) const
+{
+  if ( histogram.GetSparse() )
+    {
+    // ties go to the last of a run of empty bins, so they are needed
+    HistogramType dense;
+    histogram.Expand( dense );
+    return this->ComputeThresholdFromHistogram( dense, thresholdValue );
+    }
+
+  const std::vector<double> & data = histogram.GetFrequencies();
+  const std::vector<double> & position = histogram.GetPositions();
+
+  unsigned k,kStar;  // k = the current threshold; kStar = optimal threshold
+  double N1, N;      // N1 = # points with intensity <=k; N = total number of points
+  double BCV, BCVmax; // The current Between Class Variance and maximum BCV
+  double num, denom;  // temporary bookeeping
+  double Sk;  // The total intensity for all histogram points <=k
+  double S;   // The total intensity of the image
+  const unsigned L = data.size();
+
+  // Initialize values:
+  S = N = 0;
+  for (k=0; k<L; k++)
+    {
+    S += position[k] * data[k];	// Total histogram intensity
+    N += data[k];		// Total number of data points
+    }
+
+  Sk = 0;
+  N1 = data[0]; // The entry for zero intensity
+  BCV = 0;
+  BCVmax=0;
+  kStar = 0;
+
+  // Look at each possible threshold value,
+  // calculate the between-class variance, and decide if it's a max
+  for (k=1; k+1<L; k++) // No need to check endpoints k = 0 or k = L-1
+    {
+    Sk += position[k] * data[k];
+    N1 += data[k];
+
+    denom = N1 * (N - N1);
+
+    if (denom != 0 )
+      {
+      num = ( N1 / N ) * S - Sk;
+      BCV = (num * num) / denom;
+      }
+    else
+      BCV = 0;
+
+    if (BCV >= BCVmax) // Assign the best threshold found so far
+      {
+      BCVmax = BCV;
+      kStar = k;
+      }
+    }
+
+  thresholdValue = histogram.EntryToThreshold( kStar );
+  return true;
+
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,59 @@
+
+#ifndef __itkIJOtsuThresholdImageFilter_h
+#define __itkIJOtsuThresholdImageFilter_h
+
+#include "itkHistogramThresholdImageFilter.h"
+#include "itkIJOtsuThresholdImageCalculator.h"
+
+namespace itk {
+
+/** \class IJOtsuThresholdImageFilter 
+ * \brief Threshold an image using the IJOtsu Threshold
+ *
+ * This filter creates a binary thresholded image that separates an
+ * image into foreground and background components. The filter
+ * computes the threshold using the IJOtsuThresholdImageCalculator and
+ * applies that theshold to the input image using the
+ * BinaryThresholdImageFilter. The NunberOfHistogram bins can be set
+ * for the Calculator. The InsideValue and OutsideValue can be set
+ * for the BinaryThresholdImageFilter. Code derived from OtsuThresholdImageFilter
+ *
+ * \sa IJOtsuThresholdImageCalculator
+ * \sa HistogramThresholdImageFilter
+ * \sa BinaryThresholdImageFilter 
+ * \sa OtsuThresholdImageFilter
+ * \ingroup IntensityImageFilters  Multithreaded
+ */
+
+template<class TInputImage, class TOutputImage>
+class ITK_EXPORT IJOtsuThresholdImageFilter :
+    public HistogramThresholdImageFilter<TInputImage, TOutputImage,
+                                         IJOtsuThresholdImageCalculator<TInputImage> >
+{
+public:
+  /** Standard Self typedef */
+  typedef IJOtsuThresholdImageFilter                      Self;
+  typedef HistogramThresholdImageFilter<TInputImage, TOutputImage,
+    IJOtsuThresholdImageCalculator<TInputImage> >        Superclass;
+  typedef SmartPointer<Self>                            Pointer;
+  typedef SmartPointer<const Self>                      ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(IJOtsuThresholdImageFilter, HistogramThresholdImageFilter);
+
+protected:
+  IJOtsuThresholdImageFilter() {};
+  ~IJOtsuThresholdImageFilter(){};
+
+private:
+  IJOtsuThresholdImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+}; // end of class
+
+} // end namespace itk
+
+#endif
@@ -2,9 +2,7 @@
 #ifndef __itkIntermodesThresholdImageCalculator_h
 #define __itkIntermodesThresholdImageCalculator_h
 
-#include "itkObject.h"
-#include "itkObjectFactory.h"
-#include "itkNumericTraits.h"
+#include "itkHistogramThresholdImageCalculator.h"
 
 namespace itk
 {
@@ -37,12 +35,13 @@ namespace itk
  * \ingroup Operators
  */
 template <class TInputImage>
-class ITK_EXPORT IntermodesThresholdImageCalculator : public Object 
+class ITK_EXPORT IntermodesThresholdImageCalculator :
+    public HistogramThresholdImageCalculator<TInputImage>
 {
 public:
   /** Standard class typedefs. */
   typedef IntermodesThresholdImageCalculator Self;
-  typedef Object                       Superclass;
+  typedef HistogramThresholdImageCalculator<TInputImage> Superclass;
   typedef SmartPointer<Self>           Pointer;
   typedef SmartPointer<const Self>     ConstPointer;
 
@@ -50,38 +49,20 @@ public:
   itkNewMacro(Self);
 
   /** Run-time type information (and related methods). */
-  itkTypeMacro(IntermodesThresholdImageCalculator, Object);
+  itkTypeMacro(IntermodesThresholdImageCalculator, HistogramThresholdImageCalculator);
 
   /** Type definition for the input image. */
   typedef TInputImage  ImageType;
 
-  /** Pointer type for the image. */
-  typedef typename TInputImage::Pointer  ImagePointer;
-  
-  /** Const Pointer type for the image. */
-  typedef typename TInputImage::ConstPointer ImageConstPointer;
-
   /** Type definition for the input image pixel type. */
-  typedef typename TInputImage::PixelType PixelType;
-  
-  /** Type definition for the input image region type. */
-  typedef typename TInputImage::RegionType RegionType;
-  
-  /** Set the input image. */
-  itkSetConstObjectMacro(Image,ImageType);
-
-  /** Compute the Intermodes's threshold for the input image. */
-  void Compute(void);
-
-  /** Return the Intermodes's threshold value. */
-  itkGetConstMacro(Threshold,PixelType);
-  
-  /** Set/Get the number of histogram bins. Default is 128. */
-  itkSetClampMacro( NumberOfHistogramBins, unsigned long, 1, 
-                    NumericTraits<unsigned long>::max() );
-  itkGetConstMacro( NumberOfHistogramBins, unsigned long );
-
-  
+  typedef typename Superclass::PixelType PixelType;
+
+  /** Type definition for the histogram. */
+  typedef typename Superclass::HistogramType HistogramType;
+
+  /** Type definition for the working arrays of the criterion. */
+  typedef typename Superclass::ScratchArrayType ScratchArrayType;
+
   itkSetMacro( MaxSmoothingIterations, unsigned long);
   itkGetConstMacro( MaxSmoothingIterations, unsigned long );
 
@@ -90,27 +71,22 @@ public:
   itkSetMacro( UseInterMode, bool);
   itkGetConstMacro( UseInterMode, bool );
 
-
-  /** Set the region over which the values will be computed */
-  void SetRegion( const RegionType & region );
-
 protected:
   IntermodesThresholdImageCalculator();
   virtual ~IntermodesThresholdImageCalculator() {};
   void PrintSelf(std::ostream& os, Indent indent) const;
 
-  bool bimodalTest(std::vector<double> h);
+  /** Compute the Intermodes's threshold from the histogram. */
+  bool ComputeThresholdFromHistogram(const HistogramType & histogram,
+                                     PixelType & threshold) const;
+
+  bool bimodalTest(const ScratchArrayType & h) const;
 
 private:
   IntermodesThresholdImageCalculator(const Self&); //purposely not implemented
   void operator=(const Self&); //purposely not implemented
-  
-  PixelType            m_Threshold;
+
   unsigned             m_MaxSmoothingIterations;
-  unsigned long        m_NumberOfHistogramBins;
-  ImageConstPointer    m_Image;
-  RegionType           m_Region;
-  bool                 m_RegionSetByUser;
   bool                 m_UseInterMode;
 
 };
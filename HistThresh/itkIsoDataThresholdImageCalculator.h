@@ -2,9 +2,7 @@
 #ifndef __itkIsoDataThresholdImageCalculator_h
 #define __itkIsoDataThresholdImageCalculator_h
 
-#include "itkObject.h"
-#include "itkObjectFactory.h"
-#include "itkNumericTraits.h"
+#include "itkHistogramThresholdImageCalculator.h"
 
 namespace itk
 {
@@ -31,12 +29,13 @@ namespace itk
  * \ingroup Operators
  */
 template <class TInputImage>
-class ITK_EXPORT IsoDataThresholdImageCalculator : public Object 
+class ITK_EXPORT IsoDataThresholdImageCalculator :
+    public HistogramThresholdImageCalculator<TInputImage>
 {
 public:
   /** Standard class typedefs. */
   typedef IsoDataThresholdImageCalculator Self;
-  typedef Object                       Superclass;
+  typedef HistogramThresholdImageCalculator<TInputImage> Superclass;
   typedef SmartPointer<Self>           Pointer;
   typedef SmartPointer<const Self>     ConstPointer;
 
@@ -44,55 +43,28 @@ public:
   itkNewMacro(Self);
 
   /** Run-time type information (and related methods). */
-  itkTypeMacro(IsoDataThresholdImageCalculator, Object);
+  itkTypeMacro(IsoDataThresholdImageCalculator, HistogramThresholdImageCalculator);
 
   /** Type definition for the input image. */
   typedef TInputImage  ImageType;
 
-  /** Pointer type for the image. */
-  typedef typename TInputImage::Pointer  ImagePointer;
-  
-  /** Const Pointer type for the image. */
-  typedef typename TInputImage::ConstPointer ImageConstPointer;
-
   /** Type definition for the input image pixel type. */
-  typedef typename TInputImage::PixelType PixelType;
-  
-  /** Type definition for the input image region type. */
-  typedef typename TInputImage::RegionType RegionType;
-  
-  /** Set the input image. */
-  itkSetConstObjectMacro(Image,ImageType);
-
-  /** Compute the IsoData's threshold for the input image. */
-  void Compute(void);
-
-  /** Return the IsoData's threshold value. */
-  itkGetConstMacro(Threshold,PixelType);
-  
-  /** Set/Get the number of histogram bins. Default is 128. */
-  itkSetClampMacro( NumberOfHistogramBins, unsigned long, 1, 
-                    NumericTraits<unsigned long>::max() );
-  itkGetConstMacro( NumberOfHistogramBins, unsigned long );
+  typedef typename Superclass::PixelType PixelType;
 
-
-  /** Set the region over which the values will be computed */
-  void SetRegion( const RegionType & region );
+  /** Type definition for the histogram. */
+  typedef typename Superclass::HistogramType HistogramType;
 
 protected:
-  IsoDataThresholdImageCalculator();
+  IsoDataThresholdImageCalculator() {};
   virtual ~IsoDataThresholdImageCalculator() {};
-  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  /** Compute the IsoData's threshold from the histogram. */
+  bool ComputeThresholdFromHistogram(const HistogramType & histogram,
+                                     PixelType & threshold) const;
 
 private:
   IsoDataThresholdImageCalculator(const Self&); //purposely not implemented
   void operator=(const Self&); //purposely not implemented
-  
-  PixelType            m_Threshold;
-  unsigned long        m_NumberOfHistogramBins;
-  ImageConstPointer    m_Image;
-  RegionType           m_Region;
-  bool                 m_RegionSetByUser;
 
 };
 
@@ -2,9 +2,7 @@
 #ifndef __itkKittlerIllingworthThresholdImageCalculator_h
 #define __itkKittlerIllingworthThresholdImageCalculator_h
 
-#include "itkObject.h"
-#include "itkObjectFactory.h"
-#include "itkNumericTraits.h"
+#include "itkHistogramThresholdImageCalculator.h"
 
 namespace itk
 {
@@ -30,12 +28,13 @@ namespace itk
  * \ingroup Operators
  */
 template <class TInputImage>
-class ITK_EXPORT KittlerIllingworthThresholdImageCalculator : public Object 
+class ITK_EXPORT KittlerIllingworthThresholdImageCalculator :
+    public HistogramThresholdImageCalculator<TInputImage>
 {
 public:
   /** Standard class typedefs. */
   typedef KittlerIllingworthThresholdImageCalculator Self;
-  typedef Object                       Superclass;
+  typedef HistogramThresholdImageCalculator<TInputImage> Superclass;
   typedef SmartPointer<Self>           Pointer;
   typedef SmartPointer<const Self>     ConstPointer;
 
@@ -43,59 +42,33 @@ public:
   itkNewMacro(Self);
 
   /** Run-time type information (and related methods). */
-  itkTypeMacro(KittlerIllingworthThresholdImageCalculator, Object);
+  itkTypeMacro(KittlerIllingworthThresholdImageCalculator, HistogramThresholdImageCalculator);
 
   /** Type definition for the input image. */
   typedef TInputImage  ImageType;
 
-  /** Pointer type for the image. */
-  typedef typename TInputImage::Pointer  ImagePointer;
-  
-  /** Const Pointer type for the image. */
-  typedef typename TInputImage::ConstPointer ImageConstPointer;
-
   /** Type definition for the input image pixel type. */
-  typedef typename TInputImage::PixelType PixelType;
-  
-  /** Type definition for the input image region type. */
-  typedef typename TInputImage::RegionType RegionType;
-  
-  /** Set the input image. */
-  itkSetConstObjectMacro(Image,ImageType);
-
-  /** Compute the KittlerIllingworth's threshold for the input image. */
-  void Compute(void);
-
-  /** Return the KittlerIllingworth's threshold value. */
-  itkGetConstMacro(Threshold,PixelType);
-  
-  /** Set/Get the number of histogram bins. Default is 128. */
-  itkSetClampMacro( NumberOfHistogramBins, unsigned long, 1, 
-                    NumericTraits<unsigned long>::max() );
-  itkGetConstMacro( NumberOfHistogramBins, unsigned long );
-
-  /** Set the region over which the values will be computed */
-  void SetRegion( const RegionType & region );
+  typedef typename Superclass::PixelType PixelType;
+
+  /** Type definition for the histogram. */
+  typedef typename Superclass::HistogramType HistogramType;
 
 protected:
-  KittlerIllingworthThresholdImageCalculator();
+  KittlerIllingworthThresholdImageCalculator() {};
   virtual ~KittlerIllingworthThresholdImageCalculator() {};
-  void PrintSelf(std::ostream& os, Indent indent) const;
 
-  int Mean(std::vector<double> data);
-  double A(std::vector<double> y, int j);
-  double B(std::vector<double> y, int j);
-  double C(std::vector<double> y, int j);
+  /** Compute the KittlerIllingworth's threshold from the histogram. */
+  bool ComputeThresholdFromHistogram(const HistogramType & histogram,
+                                     PixelType & threshold) const;
+
+  int Mean(const HistogramType & histogram) const;
+  double A(const HistogramType & histogram, double j) const;
+  double B(const HistogramType & histogram, double j) const;
+  double C(const HistogramType & histogram, double j) const;
 
 private:
   KittlerIllingworthThresholdImageCalculator(const Self&); //purposely not implemented
   void operator=(const Self&); //purposely not implemented
-  
-  PixelType            m_Threshold;
-  unsigned long        m_NumberOfHistogramBins;
-  ImageConstPointer    m_Image;
-  RegionType           m_Region;
-  bool                 m_RegionSetByUser;
 
 };
 
@@ -0,0 +1,75 @@
+#ifndef __itkMappedImageContainer_h
+#define __itkMappedImageContainer_h
+
+#include "itkImportImageContainer.h"
+
+namespace itk
+{
+
+/** \class MappedImageContainer
+ * \brief Pixel container over the pixels of a file mapped in memory.
+ *
+ * The pixels of an uncompressed image file are used where they lie in
+ * the file, instead of being copied into a buffer before any
+ * processing starts. The operating system reads them as they are
+ * first accessed, reading ahead of a sequential pass, and they are
+ * shared with the page cache rather than allocated by the process.
+ *
+ * The mapping is private: pixels written to are copied, and the file
+ * is never modified. It is released with the container.
+ *
+ * Mapping is only available where mmap() is. Map() returns false
+ * elsewhere, and for files it can't map, so that the caller can read
+ * the file instead.
+ *
+ * \sa ImportImageContainer
+ */
+template <typename TElementIdentifier, typename TElement>
+class ITK_EXPORT MappedImageContainer :
+    public ImportImageContainer<TElementIdentifier, TElement>
+{
+public:
+  /** Standard class typedefs. */
+  typedef MappedImageContainer                                Self;
+  typedef ImportImageContainer<TElementIdentifier, TElement>  Superclass;
+  typedef SmartPointer<Self>                                  Pointer;
+  typedef SmartPointer<const Self>                            ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Standard part of every itk Object. */
+  itkTypeMacro(MappedImageContainer, ImportImageContainer);
+
+  /** Use count elements of the file, starting offset bytes into it, as
+   * the pixels. The offset must be a multiple of the element size.
+   * Returns false if the file can't be mapped. */
+  bool Map(const char * filename, unsigned long offset,
+           TElementIdentifier count);
+
+  /** Whether the pixels are those of a mapped file. */
+  bool IsMapped() const
+    { return m_Mapping != 0; }
+
+protected:
+  MappedImageContainer();
+  virtual ~MappedImageContainer();
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  void Unmap();
+
+private:
+  MappedImageContainer(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  void *          m_Mapping;
+  unsigned long   m_MappingLength;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkMappedImageContainer.txx"
+#endif
+
+#endif
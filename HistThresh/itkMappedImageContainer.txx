@@ -0,0 +1,116 @@
+#ifndef __itkMappedImageContainer_txx
+#define __itkMappedImageContainer_txx
+
+#include "itkMappedImageContainer.h"
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace itk
+{
+
+template <typename TElementIdentifier, typename TElement>
+MappedImageContainer<TElementIdentifier, TElement>
+::MappedImageContainer()
+{
+  m_Mapping = 0;
+  m_MappingLength = 0;
+}
+
+template <typename TElementIdentifier, typename TElement>
+MappedImageContainer<TElementIdentifier, TElement>
+::~MappedImageContainer()
+{
+  this->Unmap();
+}
+
+template <typename TElementIdentifier, typename TElement>
+bool
+MappedImageContainer<TElementIdentifier, TElement>
+::Map(const char * filename, unsigned long offset, TElementIdentifier count)
+{
+  this->Unmap();
+#if defined(_WIN32)
+  (void)filename;
+  (void)offset;
+  (void)count;
+  return false;
+#else
+  if ( offset % sizeof(TElement) != 0 || count == 0 )
+    {
+    return false;
+    }
+
+  int fd = open( filename, O_RDONLY );
+  if ( fd < 0 )
+    {
+    return false;
+    }
+  struct stat status;
+  const unsigned long length = count * sizeof(TElement);
+  if ( fstat( fd, &status ) != 0 ||
+       (unsigned long) status.st_size < offset + length )
+    {
+    close( fd );
+    return false;
+    }
+
+  // the mapping starts on a page boundary
+  const unsigned long page = sysconf( _SC_PAGESIZE );
+  const unsigned long start = offset - offset % page;
+  const unsigned long mappingLength = length + ( offset - start );
+  void * mapping = mmap( 0, mappingLength, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE, fd, start );
+  // the mapping holds its own reference to the file
+  close( fd );
+  if ( mapping == MAP_FAILED )
+    {
+    return false;
+    }
+
+  // the passes over the pixels are sequential, let the pages be read
+  // well ahead of them
+  posix_madvise( mapping, mappingLength, POSIX_MADV_SEQUENTIAL );
+
+  m_Mapping = mapping;
+  m_MappingLength = mappingLength;
+  this->SetImportPointer(
+    reinterpret_cast<TElement *>( static_cast<char *>( mapping ) + ( offset - start ) ),
+    count, false );
+  return true;
+#endif
+}
+
+template <typename TElementIdentifier, typename TElement>
+void
+MappedImageContainer<TElementIdentifier, TElement>
+::Unmap()
+{
+#if !defined(_WIN32)
+  if ( m_Mapping )
+    {
+    this->SetImportPointer( 0, 0, false );
+    munmap( m_Mapping, m_MappingLength );
+    }
+#endif
+  m_Mapping = 0;
+  m_MappingLength = 0;
+}
+
+template <typename TElementIdentifier, typename TElement>
+void
+MappedImageContainer<TElementIdentifier, TElement>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf(os,indent);
+  os << indent << "Mapping: " << m_Mapping << std::endl;
+  os << indent << "MappingLength: " << m_MappingLength << std::endl;
+}
+
+} // end namespace itk
+
+#endif
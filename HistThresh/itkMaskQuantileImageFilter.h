@@ -0,0 +1,188 @@
+#ifndef __itkMaskQuantileImageFilter_h
+#define __itkMaskQuantileImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkNumericTraits.h"
+#include "itkQuantileSketch.h"
+#include <vector>
+#include <map>
+#include <set>
+
+namespace itk {
+
+/** \class MaskQuantileImageFilter
+ * \brief Compute quantiles of the input pixels under each label of a
+ * label image.
+ *
+ * The input and the label image are read together in one multithreaded
+ * pass. The input is passed through to the output, as in the
+ * LabelStatisticsImageFilter. The quantiles listed with SetQuantiles()
+ * are then available from GetQuantiles() for every label met, or for
+ * the labels given with AddLabel() only.
+ *
+ * By default the quantiles are exact: the value of rank q * (n - 1),
+ * interpolated between the two nearest ranks, n being the number of
+ * pixels of the label. For 8 and 16 bit integer pixels they come from
+ * a histogram with one bin per value, spanning only the values met
+ * under the label, so that a label of CT values doesn't take the 64k
+ * bins of the whole 16 bit range in each thread. For the other pixel
+ * types the values are kept and the ranks selected, which takes memory
+ * for every pixel of the labels gathered. With UseSketch on, each
+ * label instead keeps a QuantileSketch, whose quantiles are within
+ * RelativeAccuracy of the exact values and whose size does not depend
+ * on the number of pixels.
+ *
+ * \sa QuantileSketch
+ * \sa LabelStatisticsImageFilter
+ * \ingroup MathematicalStatisticsImageFilters  Multithreaded
+ */
+template<class TInputImage, class TLabelImage>
+class ITK_EXPORT MaskQuantileImageFilter :
+    public ImageToImageFilter<TInputImage, TInputImage>
+{
+public:
+  /** Standard Self typedef */
+  typedef MaskQuantileImageFilter                       Self;
+  typedef ImageToImageFilter<TInputImage,TInputImage>   Superclass;
+  typedef SmartPointer<Self>                            Pointer;
+  typedef SmartPointer<const Self>                      ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(MaskQuantileImageFilter, ImageToImageFilter);
+
+  /** Image related typedefs. */
+  typedef typename TInputImage::Pointer      InputImagePointer;
+  typedef typename TInputImage::RegionType   RegionType;
+  typedef typename TInputImage::PixelType    PixelType;
+  typedef TLabelImage                        LabelImageType;
+  typedef typename TLabelImage::PixelType    LabelPixelType;
+
+  itkStaticConstMacro(ImageDimension, unsigned int,
+                      TInputImage::ImageDimension );
+
+  /** Set/Get the label image. */
+  void SetLabelInput(const TLabelImage * input)
+    { this->SetNthInput(1, const_cast<TLabelImage *>(input)); }
+  const TLabelImage * GetLabelInput()
+    { return static_cast<const TLabelImage *>(this->ProcessObject::GetInput(1)); }
+
+  /** Set/Get the quantiles computed, between 0 and 1. */
+  void SetQuantiles(const std::vector<double> & quantiles)
+    {
+    m_Quantiles = quantiles;
+    this->Modified();
+    }
+  const std::vector<double> & GetQuantiles() const
+    { return m_Quantiles; }
+
+  /** Restrict the labels gathered. All the labels are gathered when
+   * none is given. */
+  void AddLabel(LabelPixelType label)
+    {
+    m_Labels.insert(label);
+    this->Modified();
+    }
+  void ClearLabels()
+    {
+    m_Labels.clear();
+    this->Modified();
+    }
+
+  /** Set/Get whether the quantiles are approximated with a
+   * QuantileSketch. Default is false. */
+  itkSetMacro(UseSketch, bool);
+  itkGetConstMacro(UseSketch, bool);
+  itkBooleanMacro(UseSketch);
+
+  /** Set/Get the relative accuracy of the sketch. Default is 0.01. */
+  itkSetMacro(RelativeAccuracy, double);
+  itkGetConstMacro(RelativeAccuracy, double);
+
+  /** Whether a label was met in the last update. */
+  bool HasLabel(LabelPixelType label) const
+    { return m_Results.find(label) != m_Results.end(); }
+
+  /** Number of pixels of a label. */
+  unsigned long GetCount(LabelPixelType label) const;
+
+  /** The quantiles of a label, in the order of SetQuantiles(). */
+  std::vector<double> GetQuantiles(LabelPixelType label) const;
+
+protected:
+  MaskQuantileImageFilter();
+  ~MaskQuantileImageFilter(){};
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  /** Pass the input through unmodified. Do this by Grafting in the
+   * AllocateOutputs method. */
+  void AllocateOutputs();
+
+  /** The whole of both inputs is needed. */
+  void GenerateInputRequestedRegion();
+  void EnlargeOutputRequestedRegion(DataObject *data);
+
+  void BeforeThreadedGenerateData();
+  void ThreadedGenerateData(const RegionType& outputRegionForThread,
+                            int threadId );
+  void AfterThreadedGenerateData();
+
+private:
+  MaskQuantileImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  /** What is gathered for a label by a thread. */
+  struct LabelData
+    {
+    unsigned long               Count;
+    std::vector<PixelType>      Values;
+    std::vector<unsigned long>  Histogram;
+    long                        HistogramMinimum;
+    QuantileSketch              Sketch;
+    };
+  typedef std::map<LabelPixelType, LabelData>  LabelDataMapType;
+
+  /** Result for a label. */
+  struct LabelResult
+    {
+    unsigned long               Count;
+    std::vector<double>         Quantiles;
+    };
+  typedef std::map<LabelPixelType, LabelResult>  LabelResultMapType;
+
+  /** Whether the pixels are counted in a histogram with one bin per
+   * value. */
+  static bool UseHistogram()
+    {
+    return NumericTraits<PixelType>::is_integer && sizeof(PixelType) <= 2;
+    }
+
+  /** Extend the histogram of a label to the values from minimum to
+   * maximum. */
+  static void GrowHistogram(LabelData & data, long minimum, long maximum);
+
+  /** Add the values of a row to the data of a label. */
+  void AddValues(LabelData & data, const PixelType * values,
+                 unsigned long length) const;
+
+  /** Quantile q of the merged data of a label. */
+  double ComputeQuantile(LabelData & data, double q) const;
+
+  std::vector<double>             m_Quantiles;
+  std::set<LabelPixelType>        m_Labels;
+  bool                            m_UseSketch;
+  double                          m_RelativeAccuracy;
+  std::vector<LabelDataMapType>   m_ThreadData;
+  LabelResultMapType              m_Results;
+
+}; // end of class
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkMaskQuantileImageFilter.txx"
+#endif
+
+#endif
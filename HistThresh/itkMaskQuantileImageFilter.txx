@@ -0,0 +1,363 @@
+#ifndef __itkMaskQuantileImageFilter_txx
+#define __itkMaskQuantileImageFilter_txx
+#include "itkMaskQuantileImageFilter.h"
+
+#include "itkProgressReporter.h"
+#include "itkImageLinearConstIteratorWithIndex.h"
+#include <algorithm>
+
+namespace itk {
+
+template<class TInputImage, class TLabelImage>
+MaskQuantileImageFilter<TInputImage, TLabelImage>
+::MaskQuantileImageFilter()
+{
+  this->SetNumberOfRequiredInputs(2);
+  m_UseSketch = false;
+  m_RelativeAccuracy = 0.01;
+}
+
+template<class TInputImage, class TLabelImage>
+void
+MaskQuantileImageFilter<TInputImage, TLabelImage>
+::AllocateOutputs()
+{
+  // Pass the input through as the output
+  InputImagePointer image = const_cast< TInputImage * >( this->GetInput() );
+  this->GraftOutput( image );
+}
+
+template<class TInputImage, class TLabelImage>
+void
+MaskQuantileImageFilter<TInputImage, TLabelImage>
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+  TInputImage * input = const_cast<TInputImage *>(this->GetInput());
+  if( input )
+    {
+    input->SetRequestedRegionToLargestPossibleRegion();
+    }
+  TLabelImage * labels = const_cast<TLabelImage *>(this->GetLabelInput());
+  if( labels )
+    {
+    labels->SetRequestedRegionToLargestPossibleRegion();
+    }
+}
+
+template<class TInputImage, class TLabelImage>
+void
+MaskQuantileImageFilter<TInputImage, TLabelImage>
+::EnlargeOutputRequestedRegion(DataObject *data)
+{
+  Superclass::EnlargeOutputRequestedRegion(data);
+  data->SetRequestedRegionToLargestPossibleRegion();
+}
+
+template<class TInputImage, class TLabelImage>
+void
+MaskQuantileImageFilter<TInputImage, TLabelImage>
+::BeforeThreadedGenerateData()
+{
+  m_ThreadData.assign( this->GetNumberOfThreads(), LabelDataMapType() );
+  m_Results.clear();
+}
+
+template<class TInputImage, class TLabelImage>
+void
+MaskQuantileImageFilter<TInputImage, TLabelImage>
+::GrowHistogram(LabelData & data, long minimum, long maximum)
+{
+  const long size = data.Histogram.size();
+  long first = data.HistogramMinimum;
+  long last = first + size - 1;
+  if ( size == 0 )
+    {
+    first = minimum;
+    last = maximum;
+    }
+  else if ( minimum >= first && maximum <= last )
+    {
+    return;
+    }
+  else
+    {
+    // grow by at least the current size, so that the bins of a label
+    // whose values spread slowly are only copied a few times
+    const long typeMinimum = static_cast<long>( NumericTraits<PixelType>::NonpositiveMin() );
+    const long typeMaximum = static_cast<long>( NumericTraits<PixelType>::max() );
+    if ( minimum < first )
+      {
+      first = std::max( typeMinimum, std::min( minimum, first - size ) );
+      }
+    if ( maximum > last )
+      {
+      last = std::min( typeMaximum, std::max( maximum, last + size ) );
+      }
+    }
+
+  std::vector<unsigned long> grown( last - first + 1, 0 );
+  std::copy( data.Histogram.begin(), data.Histogram.end(),
+             grown.begin() + ( data.HistogramMinimum - first ) );
+  data.Histogram.swap( grown );
+  data.HistogramMinimum = first;
+}
+
+template<class TInputImage, class TLabelImage>
+void
+MaskQuantileImageFilter<TInputImage, TLabelImage>
+::AddValues(LabelData & data, const PixelType * values,
+            unsigned long length) const
+{
+  data.Count += length;
+  if ( m_UseSketch )
+    {
+    for ( unsigned long i = 0; i < length; i++ )
+      {
+      data.Sketch.Add( static_cast<double>( values[i] ) );
+      }
+    }
+  else if ( UseHistogram() )
+    {
+    long minimum = static_cast<long>( values[0] );
+    long maximum = minimum;
+    for ( unsigned long i = 1; i < length; i++ )
+      {
+      minimum = std::min( minimum, static_cast<long>( values[i] ) );
+      maximum = std::max( maximum, static_cast<long>( values[i] ) );
+      }
+    GrowHistogram( data, minimum, maximum );
+    unsigned long * histogram = &data.Histogram[0];
+    const long first = data.HistogramMinimum;
+    for ( unsigned long i = 0; i < length; i++ )
+      {
+      histogram[static_cast<long>( values[i] ) - first]++;
+      }
+    }
+  else
+    {
+    data.Values.insert( data.Values.end(), values, values + length );
+    }
+}
+
+template<class TInputImage, class TLabelImage>
+void
+MaskQuantileImageFilter<TInputImage, TLabelImage>
+::ThreadedGenerateData(const RegionType& outputRegionForThread,
+                       int threadId )
+{
+  const TInputImage * input = this->GetInput();
+  const TLabelImage * labels = this->GetLabelInput();
+  LabelDataMapType & dataMap = m_ThreadData[threadId];
+
+  const unsigned long rowLength = outputRegionForThread.GetSize()[0];
+  const PixelType * inputBuffer = input->GetBufferPointer();
+  const LabelPixelType * labelBuffer = labels->GetBufferPointer();
+
+  // the data of the label of the previous run, the labels coming in
+  // long runs in most label images
+  LabelPixelType lastLabel = NumericTraits<LabelPixelType>::Zero;
+  LabelData * lastData = 0;
+  bool haveLast = false;
+
+  ProgressReporter progress( this, threadId,
+                             outputRegionForThread.GetNumberOfPixels() / rowLength );
+
+  ImageLinearConstIteratorWithIndex<TInputImage> iter( input, outputRegionForThread );
+  iter.SetDirection( 0 );
+
+  while ( !iter.IsAtEnd() )
+    {
+    const PixelType * in = inputBuffer + input->ComputeOffset( iter.GetIndex() );
+    const LabelPixelType * lab = labelBuffer + labels->ComputeOffset( iter.GetIndex() );
+    unsigned long i = 0;
+    while ( i < rowLength )
+      {
+      const LabelPixelType label = lab[i];
+      unsigned long end = i + 1;
+      while ( end < rowLength && lab[end] == label )
+        {
+        end++;
+        }
+
+      if ( !haveLast || label != lastLabel )
+        {
+        lastLabel = label;
+        haveLast = true;
+        lastData = 0;
+        if ( m_Labels.empty() || m_Labels.count( label ) )
+          {
+          typename LabelDataMapType::iterator found = dataMap.find( label );
+          if ( found == dataMap.end() )
+            {
+            LabelData & data = dataMap[label];
+            data.Count = 0;
+            data.HistogramMinimum = 0;
+            data.Sketch.SetRelativeAccuracy( m_RelativeAccuracy );
+            lastData = &data;
+            }
+          else
+            {
+            lastData = &found->second;
+            }
+          }
+        }
+      if ( lastData )
+        {
+        this->AddValues( *lastData, in + i, end - i );
+        }
+      i = end;
+      }
+    iter.NextLine();
+    progress.CompletedPixel();
+    }
+}
+
+template<class TInputImage, class TLabelImage>
+double
+MaskQuantileImageFilter<TInputImage, TLabelImage>
+::ComputeQuantile(LabelData & data, double q) const
+{
+  if ( data.Count == 0 )
+    {
+    return 0.0;
+    }
+  q = std::max( 0.0, std::min( 1.0, q ) );
+  if ( m_UseSketch )
+    {
+    return data.Sketch.GetQuantile( q );
+    }
+
+  // interpolate between the values of ranks low and low + 1
+  const double position = q * ( data.Count - 1 );
+  const unsigned long low = static_cast<unsigned long>( position );
+  const double fraction = position - low;
+  const unsigned long high = fraction > 0.0 ? low + 1 : low;
+  double lowValue = 0.0;
+  double highValue = 0.0;
+
+  if ( UseHistogram() )
+    {
+    const long minimum = data.HistogramMinimum;
+    unsigned long seen = 0;
+    bool haveLow = false;
+    for ( unsigned long b = 0; b < data.Histogram.size(); b++ )
+      {
+      seen += data.Histogram[b];
+      if ( !haveLow && seen > low )
+        {
+        lowValue = static_cast<double>( minimum + long( b ) );
+        haveLow = true;
+        }
+      if ( seen > high )
+        {
+        highValue = static_cast<double>( minimum + long( b ) );
+        break;
+        }
+      }
+    }
+  else
+    {
+    typename std::vector<PixelType>::iterator lowIt = data.Values.begin() + low;
+    std::nth_element( data.Values.begin(), lowIt, data.Values.end() );
+    lowValue = static_cast<double>( *lowIt );
+    highValue = high > low ?
+      static_cast<double>( *std::min_element( lowIt + 1, data.Values.end() ) )
+      : lowValue;
+    }
+  return lowValue + fraction * ( highValue - lowValue );
+}
+
+template<class TInputImage, class TLabelImage>
+void
+MaskQuantileImageFilter<TInputImage, TLabelImage>
+::AfterThreadedGenerateData()
+{
+  LabelDataMapType & merged = m_ThreadData[0];
+  for ( unsigned int t = 1; t < m_ThreadData.size(); t++ )
+    {
+    for ( typename LabelDataMapType::iterator it = m_ThreadData[t].begin();
+          it != m_ThreadData[t].end(); ++it )
+      {
+      typename LabelDataMapType::iterator found = merged.find( it->first );
+      if ( found == merged.end() )
+        {
+        merged[it->first] = it->second;
+        continue;
+        }
+      LabelData & data = found->second;
+      data.Count += it->second.Count;
+      data.Values.insert( data.Values.end(), it->second.Values.begin(),
+                          it->second.Values.end() );
+      const std::vector<unsigned long> & histogram = it->second.Histogram;
+      if ( !histogram.empty() )
+        {
+        const long minimum = it->second.HistogramMinimum;
+        GrowHistogram( data, minimum, minimum + long( histogram.size() ) - 1 );
+        const unsigned long offset = minimum - data.HistogramMinimum;
+        for ( unsigned long b = 0; b < histogram.size(); b++ )
+          {
+          data.Histogram[offset + b] += histogram[b];
+          }
+        }
+      data.Sketch.Merge( it->second.Sketch );
+      }
+    m_ThreadData[t].clear();
+    }
+
+  for ( typename LabelDataMapType::iterator it = merged.begin();
+        it != merged.end(); ++it )
+    {
+    LabelResult & result = m_Results[it->first];
+    result.Count = it->second.Count;
+    for ( unsigned int q = 0; q < m_Quantiles.size(); q++ )
+      {
+      result.Quantiles.push_back( this->ComputeQuantile( it->second, m_Quantiles[q] ) );
+      }
+    }
+  m_ThreadData.clear();
+}
+
+template<class TInputImage, class TLabelImage>
+unsigned long
+MaskQuantileImageFilter<TInputImage, TLabelImage>
+::GetCount(LabelPixelType label) const
+{
+  typename LabelResultMapType::const_iterator found = m_Results.find( label );
+  return found == m_Results.end() ? 0 : found->second.Count;
+}
+
+template<class TInputImage, class TLabelImage>
+std::vector<double>
+MaskQuantileImageFilter<TInputImage, TLabelImage>
+::GetQuantiles(LabelPixelType label) const
+{
+  typename LabelResultMapType::const_iterator found = m_Results.find( label );
+  if ( found == m_Results.end() )
+    {
+    return std::vector<double>( m_Quantiles.size(), 0.0 );
+    }
+  return found->second.Quantiles;
+}
+
+template<class TInputImage, class TLabelImage>
+void
+MaskQuantileImageFilter<TInputImage, TLabelImage>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf(os,indent);
+
+  os << indent << "Quantiles:";
+  for ( unsigned int q = 0; q < m_Quantiles.size(); q++ )
+    {
+    os << " " << m_Quantiles[q];
+    }
+  os << std::endl;
+  os << indent << "Number of labels restricted to: " << m_Labels.size() << std::endl;
+  os << indent << "UseSketch: " << m_UseSketch << std::endl;
+  os << indent << "RelativeAccuracy: " << m_RelativeAccuracy << std::endl;
+  os << indent << "Number of labels met: " << m_Results.size() << std::endl;
+}
+
+}// end namespace itk
+#endif
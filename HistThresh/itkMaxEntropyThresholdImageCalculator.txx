@@ -3,95 +3,22 @@
 #define __itkMaxEntropyThresholdImageCalculator_txx
 
 #include "itkMaxEntropyThresholdImageCalculator.h"
-#include "itkImageRegionConstIteratorWithIndex.h"
-#include "itkMinimumMaximumImageCalculator.h"
 
 #include "vnl/vnl_math.h"
 
 namespace itk
-{ 
-    
-/**
- * Constructor
- */
-template<class TInputImage>
-MaxEntropyThresholdImageCalculator<TInputImage>
-::MaxEntropyThresholdImageCalculator()
 {
-  m_Image = NULL;
-  m_Threshold = NumericTraits<PixelType>::Zero;
-  m_NumberOfHistogramBins = 128;
-  m_RegionSetByUser = false;
-}
-
 
 /*
  * Compute the MaxEntropy's threshold
  */
 template<class TInputImage>
-void
+bool
 MaxEntropyThresholdImageCalculator<TInputImage>
-::Compute(void)
+::ComputeThresholdFromHistogram(const HistogramType & histogram,
+                                PixelType & thresholdValue) const
 {
-
-  if ( !m_Image ) { return; }
-  if( !m_RegionSetByUser )
-    {
-    m_Region = m_Image->GetRequestedRegion();
-    }
-
-  double totalPixels = (double) m_Region.GetNumberOfPixels();
-  if ( totalPixels == 0 ) { return; }
-
-
-  // compute image max and min
-  typedef MinimumMaximumImageCalculator<TInputImage> RangeCalculator;
-  typename RangeCalculator::Pointer rangeCalculator = RangeCalculator::New();
-  rangeCalculator->SetImage( m_Image );
-  rangeCalculator->Compute();
-
-  PixelType imageMin = rangeCalculator->GetMinimum();
-  PixelType imageMax = rangeCalculator->GetMaximum();
-
-  if ( imageMin >= imageMax )
-    {
-    m_Threshold = imageMin;
-    return;
-    }
-
-  // create a histogram
-  std::vector<double> relativeFrequency;
-  relativeFrequency.resize( m_NumberOfHistogramBins );
-  std::fill(relativeFrequency.begin(), relativeFrequency.end(), 0.0);
-
-  double binMultiplier = (double) m_NumberOfHistogramBins /
-    (double) ( imageMax - imageMin );
-
-  typedef ImageRegionConstIteratorWithIndex<TInputImage> Iterator;
-  Iterator iter( m_Image, m_Region );
-
-  while ( !iter.IsAtEnd() )
-    {
-    unsigned int binNumber;
-    PixelType value = iter.Get();
-
-    if ( value == imageMin ) 
-      {
-      binNumber = 0;
-      }
-    else
-      {
-      binNumber = (unsigned int) vcl_ceil((value - imageMin) * binMultiplier ) - 1;
-      if ( binNumber == m_NumberOfHistogramBins ) // in case of rounding errors
-        {
-        binNumber -= 1;
-        }
-      }
-
-    relativeFrequency[binNumber] += 1.0;
-    ++iter;
-
-    }
+  const std::vector<double> & relativeFrequency = histogram.GetFrequencies();
 
   int threshold=-1;
   int ih, it;
@@ -101,9 +28,9 @@ MaxEntropyThresholdImageCalculator<TInputImage>
   double max_ent;  /* max entropy */
   double ent_back; /* entropy of the background pixels at a given threshold */
   double ent_obj;  /* entropy of the object pixels at a given threshold */
-  std::vector<double> norm_histo(relativeFrequency.size()); /* normalized histogram */
-  std::vector<double> P1(relativeFrequency.size()); /* cumulative normalized histogram */
-  std::vector<double> P2(relativeFrequency.size());
+  ScratchArrayType norm_histo(relativeFrequency.size()); /* normalized histogram */
+  ScratchArrayType P1(relativeFrequency.size()); /* cumulative normalized histogram */
+  ScratchArrayType P2(relativeFrequency.size());
   
   const double tolerance = 2.220446049250313E-16; // should get this
 						  // from traits
@@ -183,32 +110,9 @@ MaxEntropyThresholdImageCalculator<TInputImage>
     }
   
   
-  m_Threshold = static_cast<PixelType>( imageMin + 
-                                        ( threshold ) / binMultiplier );
-
-
-}
-
-template<class TInputImage>
-void
-MaxEntropyThresholdImageCalculator<TInputImage>
-::SetRegion( const RegionType & region )
-{
-  m_Region = region;
-  m_RegionSetByUser = true;
-}
-
-  
-template<class TInputImage>
-void
-MaxEntropyThresholdImageCalculator<TInputImage>
-::PrintSelf( std::ostream& os, Indent indent ) const
-{
-  Superclass::PrintSelf(os,indent);
+  thresholdValue = histogram.EntryToThreshold( threshold );
+  return true;
 
-  os << indent << "Threshold: " << m_Threshold << std::endl;
-  os << indent << "NumberOfHistogramBins: " << m_NumberOfHistogramBins << std::endl;
-  os << indent << "Image: " << m_Image.GetPointer() << std::endl;
 }
 
 } // end namespace itk
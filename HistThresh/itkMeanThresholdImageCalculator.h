@@ -0,0 +1,74 @@
+
+#ifndef __itkMeanThresholdImageCalculator_h
+#define __itkMeanThresholdImageCalculator_h
+
+#include "itkHistogramThresholdImageCalculator.h"
+
+namespace itk
+{
+
+/** \class MeanThresholdImageCalculator
+ * \brief Computes the Mean threshold for an image.
+ *
+ * C. A. Glasbey, "An analysis of histogram-based thresholding algorithms,"
+ * CVGIP: Graphical Models and Image Processing, vol. 55, pp. 532-537, 1993.
+ *
+ * The threshold is the mean of the greyscale data.
+ *
+ * Ported from the ImageJ implementation. http://pacific.mpi-cbg.de/wiki/index.php/Auto_Threshold
+ *
+ * This class is templated over the input image type.
+ * \author Richard Beare
+ * \warning This method assumes that the input image consists of scalar pixel
+ * types.
+ *
+ * \ingroup Operators
+ */
+template <class TInputImage>
+class ITK_EXPORT MeanThresholdImageCalculator :
+    public HistogramThresholdImageCalculator<TInputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef MeanThresholdImageCalculator Self;
+  typedef HistogramThresholdImageCalculator<TInputImage> Superclass;
+  typedef SmartPointer<Self>           Pointer;
+  typedef SmartPointer<const Self>     ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(MeanThresholdImageCalculator, HistogramThresholdImageCalculator);
+
+  /** Type definition for the input image. */
+  typedef TInputImage  ImageType;
+
+  /** Type definition for the input image pixel type. */
+  typedef typename Superclass::PixelType PixelType;
+
+  /** Type definition for the histogram. */
+  typedef typename Superclass::HistogramType HistogramType;
+
+protected:
+  MeanThresholdImageCalculator() {};
+  virtual ~MeanThresholdImageCalculator() {};
+
+  /** Compute the Mean threshold from the histogram. */
+  bool ComputeThresholdFromHistogram(const HistogramType & histogram,
+                                     PixelType & threshold) const;
+
+private:
+  MeanThresholdImageCalculator(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+};
+
+} // end namespace itk
+
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkMeanThresholdImageCalculator.txx"
+#endif
+
+#endif
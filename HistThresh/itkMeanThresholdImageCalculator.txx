@@ -0,0 +1,35 @@
+
+#ifndef __itkMeanThresholdImageCalculator_txx
+#define __itkMeanThresholdImageCalculator_txx
+
+#include "itkMeanThresholdImageCalculator.h"
+
+#include "vnl/vnl_math.h"
+
+namespace itk
+{
+
+/*
+ * Compute the Mean threshold
+ */
+template<class TInputImage>
+bool
+MeanThresholdImageCalculator<TInputImage>
+::ComputeThresholdFromHistogram(const HistogramType & histogram,
+                                PixelType & thresholdValue) const
+{
+  double tot=0, sum=0;
+  for (unsigned i=0; i<histogram.GetSize(); i++)
+    {
+    tot+= histogram.GetFrequency(i);
+    sum+=(histogram.GetPosition(i)*histogram.GetFrequency(i));
+    }
+
+  thresholdValue = histogram.PositionToThreshold( vcl_floor(sum/tot) );
+  return true;
+
+}
+
+} // end namespace itk
+
+#endif
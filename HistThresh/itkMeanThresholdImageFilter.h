@@ -0,0 +1,59 @@
+
+#ifndef __itkMeanThresholdImageFilter_h
+#define __itkMeanThresholdImageFilter_h
+
+#include "itkHistogramThresholdImageFilter.h"
+#include "itkMeanThresholdImageCalculator.h"
+
+namespace itk {
+
+/** \class MeanThresholdImageFilter 
+ * \brief Threshold an image using the Mean Threshold
+ *
+ * This filter creates a binary thresholded image that separates an
+ * image into foreground and background components. The filter
+ * computes the threshold using the MeanThresholdImageCalculator and
+ * applies that theshold to the input image using the
+ * BinaryThresholdImageFilter. The NunberOfHistogram bins can be set
+ * for the Calculator. The InsideValue and OutsideValue can be set
+ * for the BinaryThresholdImageFilter. Code derived from OtsuThresholdImageFilter
+ *
+ * \sa MeanThresholdImageCalculator
+ * \sa HistogramThresholdImageFilter
+ * \sa BinaryThresholdImageFilter 
+ * \sa OtsuThresholdImageFilter
+ * \ingroup IntensityImageFilters  Multithreaded
+ */
+
+template<class TInputImage, class TOutputImage>
+class ITK_EXPORT MeanThresholdImageFilter :
+    public HistogramThresholdImageFilter<TInputImage, TOutputImage,
+                                         MeanThresholdImageCalculator<TInputImage> >
+{
+public:
+  /** Standard Self typedef */
+  typedef MeanThresholdImageFilter                      Self;
+  typedef HistogramThresholdImageFilter<TInputImage, TOutputImage,
+    MeanThresholdImageCalculator<TInputImage> >        Superclass;
+  typedef SmartPointer<Self>                            Pointer;
+  typedef SmartPointer<const Self>                      ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(MeanThresholdImageFilter, HistogramThresholdImageFilter);
+
+protected:
+  MeanThresholdImageFilter() {};
+  ~MeanThresholdImageFilter(){};
+
+private:
+  MeanThresholdImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+}; // end of class
+
+} // end namespace itk
+
+#endif
@@ -3,102 +3,29 @@
 #define __itkMomentsThresholdImageCalculator_txx
 
 #include "itkMomentsThresholdImageCalculator.h"
-#include "itkImageRegionConstIteratorWithIndex.h"
-#include "itkMinimumMaximumImageCalculator.h"
 
 #include "vnl/vnl_math.h"
 
 namespace itk
-{ 
-    
-/**
- * Constructor
- */
-template<class TInputImage>
-MomentsThresholdImageCalculator<TInputImage>
-::MomentsThresholdImageCalculator()
 {
-  m_Image = NULL;
-  m_Threshold = NumericTraits<PixelType>::Zero;
-  m_NumberOfHistogramBins = 128;
-  m_RegionSetByUser = false;
-}
-
 
 /*
  * Compute the Moments's threshold
  */
 template<class TInputImage>
-void
+bool
 MomentsThresholdImageCalculator<TInputImage>
-::Compute(void)
+::ComputeThresholdFromHistogram(const HistogramType & histogram,
+                                PixelType & thresholdValue) const
 {
+  const std::vector<double> & relativeFrequency = histogram.GetFrequencies();
 
-  if ( !m_Image ) { return; }
-  if( !m_RegionSetByUser )
-    {
-    m_Region = m_Image->GetRequestedRegion();
-    }
-
-  double totalPixels = (double) m_Region.GetNumberOfPixels();
-  if ( totalPixels == 0 ) { return; }
-
-
-  // compute image max and min
-  typedef MinimumMaximumImageCalculator<TInputImage> RangeCalculator;
-  typename RangeCalculator::Pointer rangeCalculator = RangeCalculator::New();
-  rangeCalculator->SetImage( m_Image );
-  rangeCalculator->Compute();
-
-  PixelType imageMin = rangeCalculator->GetMinimum();
-  PixelType imageMax = rangeCalculator->GetMaximum();
-
-  if ( imageMin >= imageMax )
-    {
-    m_Threshold = imageMin;
-    return;
-    }
-
-  // create a histogram
-  std::vector<double> relativeFrequency;
-  relativeFrequency.resize( m_NumberOfHistogramBins );
-  std::fill(relativeFrequency.begin(), relativeFrequency.end(), 0.0);
-
-
-  double binMultiplier = (double) m_NumberOfHistogramBins /
-    (double) ( imageMax - imageMin );
-
-  typedef ImageRegionConstIteratorWithIndex<TInputImage> Iterator;
-  Iterator iter( m_Image, m_Region );
-
-  while ( !iter.IsAtEnd() )
-    {
-    unsigned int binNumber;
-    PixelType value = iter.Get();
-
-    if ( value == imageMin ) 
-      {
-      binNumber = 0;
-      }
-    else
-      {
-      binNumber = (unsigned int) vcl_ceil((value - imageMin) * binMultiplier ) - 1;
-      if ( binNumber == m_NumberOfHistogramBins ) // in case of rounding errors
-        {
-        binNumber -= 1;
-        }
-      }
-
-    relativeFrequency[binNumber] += 1.0;
-    ++iter;
-
-    }
   double total =0;
   double m0=1.0, m1=0.0, m2 =0.0, m3 =0.0, sum =0.0, p0=0.0;
   double cd, c0, c1, z0, z1;	/* auxiliary variables */
   int threshold = -1;
   
-  std::vector<double> histo(relativeFrequency.size());
+  ScratchArrayType histo(relativeFrequency.size());
   
   for (unsigned i=0; i<relativeFrequency.size(); i++)
     total+=relativeFrequency[i];
@@ -109,9 +36,10 @@ MomentsThresholdImageCalculator<TInputImage>
   /* Calculate the first, second, and third order moments */
   for ( unsigned i = 0; i < relativeFrequency.size(); i++ )
     {
-    m1 += i * histo[i];
-    m2 += i * i * histo[i];
-    m3 += i * i * i * histo[i];
+    double x = histogram.GetPosition(i);
+    m1 += x * histo[i];
+    m2 += x * x * histo[i];
+    m3 += x * x * x * histo[i];
     }
   // 
   // First 4 moments of the gray-level image should match the first 4 moments
@@ -138,32 +66,9 @@ MomentsThresholdImageCalculator<TInputImage>
       }
     }
 
-    m_Threshold = static_cast<PixelType>( imageMin + 
-					  ( threshold ) / binMultiplier );
-
-
-}
-
-template<class TInputImage>
-void
-MomentsThresholdImageCalculator<TInputImage>
-::SetRegion( const RegionType & region )
-{
-  m_Region = region;
-  m_RegionSetByUser = true;
-}
-
-  
-template<class TInputImage>
-void
-MomentsThresholdImageCalculator<TInputImage>
-::PrintSelf( std::ostream& os, Indent indent ) const
-{
-  Superclass::PrintSelf(os,indent);
+  thresholdValue = histogram.EntryToThreshold( threshold );
+  return true;
 
-  os << indent << "Threshold: " << m_Threshold << std::endl;
-  os << indent << "NumberOfHistogramBins: " << m_NumberOfHistogramBins << std::endl;
-  os << indent << "Image: " << m_Image.GetPointer() << std::endl;
 }
 
 } // end namespace itk
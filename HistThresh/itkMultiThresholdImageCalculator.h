@@ -0,0 +1,144 @@
+
+#ifndef __itkMultiThresholdImageCalculator_h
+#define __itkMultiThresholdImageCalculator_h
+
+#include "itkHistogramThresholdImageCalculator.h"
+
+namespace itk
+{
+
+/** \class MultiThresholdImageCalculator
+ * \brief Computes several thresholds for an image, splitting the
+ * histogram into NumberOfThresholds + 1 classes.
+ *
+ * The thresholds maximise a criterion that is a sum of per class
+ * terms, so the optimal split is found by dynamic programming over
+ * prefix sums of the histogram, in O(NumberOfThresholds * n^2) for a
+ * histogram of n entries, rather than by trying every tuple of
+ * thresholds. The available criteria are
+ *
+ * MaxEntropy - the sum of the Shannon entropies of the classes, as in
+ * Kapur J.N., Sahoo P.K., and Wong A.K.C. (1985) "A New Method for
+ * Gray-Level Picture Thresholding Using the Entropy of the Histogram"
+ * Graphical Models and Image Processing, 29(3): 273-285
+ *
+ * RenyiEntropy - the sum of the Renyi entropies of order Alpha of the
+ * classes, as in Kapur J.N., Sahoo P.K., and Wong A.K.C. (1985)
+ * Graphical Models and Image Processing, 29(3): 273-285
+ *
+ * Li - the minimum cross entropy between the image and its piecewise
+ * constant approximation, as in Li C.H. and Lee C.K. (1993) "Minimum
+ * Cross Entropy Thresholding" Pattern Recognition, 26(4): 617-625.
+ * Unlike LiThresholdImageCalculator, which iterates from the mean, the
+ * global minimum is found.
+ *
+ * With a single threshold the MaxEntropy criterion gives the same
+ * threshold as MaxEntropyThresholdImageCalculator. Thresholds are
+ * returned in increasing order, and GetThreshold() returns the first.
+ *
+ * This class is templated over the input image type.
+ * \author Richard Beare
+ * \warning This method assumes that the input image consists of scalar pixel
+ * types.
+ *
+ * \ingroup Operators
+ */
+template <class TInputImage>
+class ITK_EXPORT MultiThresholdImageCalculator :
+    public HistogramThresholdImageCalculator<TInputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef MultiThresholdImageCalculator Self;
+  typedef HistogramThresholdImageCalculator<TInputImage> Superclass;
+  typedef SmartPointer<Self>           Pointer;
+  typedef SmartPointer<const Self>     ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(MultiThresholdImageCalculator, HistogramThresholdImageCalculator);
+
+  /** Type definition for the input image. */
+  typedef TInputImage  ImageType;
+
+  /** Type definition for the input image pixel type. */
+  typedef typename Superclass::PixelType PixelType;
+
+  /** Type definition for the histogram. */
+  typedef typename Superclass::HistogramType HistogramType;
+
+  /** Type of the list of thresholds. */
+  typedef std::vector<PixelType> ThresholdVectorType;
+
+  /** The criteria that can be optimised. */
+  typedef enum { MaxEntropy, RenyiEntropy, Li } CriterionType;
+
+  /** Set/Get the number of thresholds. Default is 2. */
+  itkSetClampMacro( NumberOfThresholds, unsigned int, 1,
+                    NumericTraits<unsigned int>::max() );
+  itkGetConstMacro( NumberOfThresholds, unsigned int );
+
+  /** Set/Get the criterion. Default is MaxEntropy. */
+  itkSetMacro( Criterion, CriterionType );
+  itkGetConstMacro( Criterion, CriterionType );
+
+  /** Set/Get the order of the Renyi entropy. Must be positive and
+   * different from 1. Default is 0.5. */
+  itkSetMacro( Alpha, double );
+  itkGetConstMacro( Alpha, double );
+
+  /** Get the computed thresholds. */
+  itkGetConstReferenceMacro( Thresholds, ThresholdVectorType );
+
+  /** Type definition for the input image region type. */
+  typedef typename Superclass::RegionType RegionType;
+
+  /** Compute the thresholds for the input image. */
+  virtual void Compute(void);
+
+  /** Compute the thresholds of a region of an image without modifying
+   * the calculator. Returns false if none could be found. */
+  bool ComputeThresholds(const ImageType * image, const RegionType & region,
+                         ThresholdVectorType & thresholds) const;
+
+protected:
+  MultiThresholdImageCalculator();
+  virtual ~MultiThresholdImageCalculator() {};
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  /** Compute the thresholds from the histogram. */
+  bool ComputeThresholdFromHistogram(const HistogramType & histogram,
+                                     PixelType & threshold) const;
+
+  /** Compute the thresholds from the histogram. Returns false if the
+   * histogram can't be split into enough non empty classes. */
+  bool ComputeThresholdsFromHistogram(const HistogramType & histogram,
+                                      ThresholdVectorType & thresholds) const;
+
+private:
+  MultiThresholdImageCalculator(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  /** Criterion term of the class made of entries first to last, using
+   * prefix sums with a leading zero. */
+  double ClassTerm(const std::vector<double> & P,
+                   const std::vector<double> & S,
+                   unsigned long first, unsigned long last) const;
+
+  unsigned int                m_NumberOfThresholds;
+  CriterionType               m_Criterion;
+  double                      m_Alpha;
+  ThresholdVectorType         m_Thresholds;
+
+};
+
+} // end namespace itk
+
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkMultiThresholdImageCalculator.txx"
+#endif
+
+#endif
@@ -0,0 +1,222 @@
+
+#ifndef __itkMultiThresholdImageCalculator_txx
+#define __itkMultiThresholdImageCalculator_txx
+
+#include "itkMultiThresholdImageCalculator.h"
+
+#include "vnl/vnl_math.h"
+
+namespace itk
+{
+
+/**
+ * Constructor
+ */
+template<class TInputImage>
+MultiThresholdImageCalculator<TInputImage>
+::MultiThresholdImageCalculator()
+{
+  m_NumberOfThresholds = 2;
+  m_Criterion = MaxEntropy;
+  m_Alpha = 0.5;
+}
+
+template<class TInputImage>
+double
+MultiThresholdImageCalculator<TInputImage>
+::ClassTerm(const std::vector<double> & P, const std::vector<double> & S,
+            unsigned long first, unsigned long last) const
+{
+  const double p = P[last + 1] - P[first];
+  const double s = S[last + 1] - S[first];
+
+  switch ( m_Criterion )
+    {
+    case RenyiEntropy:
+      return ( s > 0.0 ? vcl_log( s / vcl_pow( p, m_Alpha ) ) / ( 1.0 - m_Alpha ) : 0.0 );
+    case Li:
+      return ( s > 0.0 ? s * vcl_log( s / p ) : 0.0 );
+    case MaxEntropy:
+    default:
+      return vcl_log( p ) - s / p;
+    }
+}
+
+/*
+ * Compute the thresholds
+ */
+template<class TInputImage>
+bool
+MultiThresholdImageCalculator<TInputImage>
+::ComputeThresholdsFromHistogram(const HistogramType & histogram,
+                                 ThresholdVectorType & thresholds) const
+{
+  const std::vector<double> & relativeFrequency = histogram.GetFrequencies();
+  const unsigned long size = relativeFrequency.size();
+  const unsigned long classes = m_NumberOfThresholds + 1;
+
+  thresholds.clear();
+  if ( m_Criterion == RenyiEntropy && ( m_Alpha <= 0 || m_Alpha == 1.0 ) )
+    {
+    itkWarningMacro(<< "Alpha must be positive and different from 1");
+    return false;
+    }
+  if ( size < classes )
+    {
+    itkWarningMacro(<< "Not enough histogram entries for "
+                    << m_NumberOfThresholds << " thresholds");
+    return false;
+    }
+
+  double total = histogram.GetTotalFrequency();
+
+  // prefix sums, with a leading zero, of the normalised histogram and
+  // of the quantity summed by the criterion
+  std::vector<double> P(size + 1, 0.0);
+  std::vector<double> S(size + 1, 0.0);
+  for (unsigned long i = 0; i < size; i++)
+    {
+    double p = relativeFrequency[i] / total;
+    double s = 0;
+    switch ( m_Criterion )
+      {
+      case RenyiEntropy:
+        s = vcl_pow( p, m_Alpha );
+        break;
+      case Li:
+        p = relativeFrequency[i];
+        s = histogram.GetPosition(i) * p;
+        break;
+      case MaxEntropy:
+      default:
+        s = ( p > 0 ? p * vcl_log( p ) : 0.0 );
+        break;
+      }
+    P[i + 1] = P[i] + p;
+    S[i + 1] = S[i] + s;
+    }
+
+  // best[k][j] is the best criterion for entries 0..j split into k+1
+  // non empty classes, and last[k][j] the first entry of the last of
+  // those classes.
+  const double invalid = NumericTraits<double>::NonpositiveMin();
+  std::vector< std::vector<double> > best(classes, std::vector<double>(size, invalid));
+  std::vector< std::vector<unsigned long> > last(classes, std::vector<unsigned long>(size, 0));
+
+  for (unsigned long j = 0; j < size; j++)
+    {
+    if ( P[j + 1] > 0 )
+      {
+      best[0][j] = this->ClassTerm( P, S, 0, j );
+      }
+    }
+
+  for (unsigned long k = 1; k < classes; k++)
+    {
+    for (unsigned long j = k; j < size; j++)
+      {
+      for (unsigned long i = k; i <= j; i++)
+        {
+        if ( best[k - 1][i - 1] == invalid || P[j + 1] - P[i] <= 0 )
+          {
+          continue;
+          }
+        double crit = best[k - 1][i - 1] + this->ClassTerm( P, S, i, j );
+        if ( best[k][j] == invalid || crit > best[k][j] )
+          {
+          best[k][j] = crit;
+          last[k][j] = i;
+          }
+        }
+      }
+    }
+
+  if ( best[classes - 1][size - 1] == invalid )
+    {
+    itkWarningMacro(<< "Can't split the histogram into "
+                    << classes << " non empty classes");
+    return false;
+    }
+
+  // follow the splits back from the last entry. Each threshold is
+  // mapped from the last entry of the class below it: like the single
+  // threshold methods for a binned histogram, and to the value of that
+  // entry for an exact one, so that the labels are the classes found.
+  thresholds.resize( m_NumberOfThresholds );
+  unsigned long j = size - 1;
+  for (unsigned long k = classes - 1; k > 0; k--)
+    {
+    unsigned long i = last[k][j];
+    thresholds[k - 1] = histogram.GetExact() ?
+      histogram.EntryToUpperThreshold( i - 1 ) : histogram.EntryToThreshold( i - 1 );
+    j = i - 1;
+    }
+  return true;
+}
+
+template<class TInputImage>
+bool
+MultiThresholdImageCalculator<TInputImage>
+::ComputeThresholdFromHistogram(const HistogramType & histogram,
+                                PixelType & threshold) const
+{
+  ThresholdVectorType thresholds;
+  if ( !this->ComputeThresholdsFromHistogram( histogram, thresholds ) )
+    {
+    return false;
+    }
+  threshold = thresholds[0];
+  return true;
+}
+
+template<class TInputImage>
+void
+MultiThresholdImageCalculator<TInputImage>
+::Compute(void)
+{
+  ThresholdVectorType thresholds;
+  if ( this->ComputeThresholds( this->GetImage(), this->GetComputeRegion(),
+                                thresholds ) )
+    {
+    m_Thresholds = thresholds;
+    this->SetThreshold( thresholds[0] );
+    }
+}
+
+template<class TInputImage>
+bool
+MultiThresholdImageCalculator<TInputImage>
+::ComputeThresholds(const ImageType * image, const RegionType & region,
+                    ThresholdVectorType & thresholds) const
+{
+  if ( !image || region.GetNumberOfPixels() == 0 ) { return false; }
+
+  HistogramType histogram;
+  if ( !this->ComputeHistogram( image, region, histogram ) )
+    {
+    return false;
+    }
+  return this->ComputeThresholdsFromHistogram( histogram, thresholds );
+}
+
+template<class TInputImage>
+void
+MultiThresholdImageCalculator<TInputImage>
+::PrintSelf( std::ostream& os, Indent indent ) const
+{
+  Superclass::PrintSelf(os,indent);
+
+  os << indent << "NumberOfThresholds: " << m_NumberOfThresholds << std::endl;
+  os << indent << "Criterion: " << m_Criterion << std::endl;
+  os << indent << "Alpha: " << m_Alpha << std::endl;
+  os << indent << "Thresholds:";
+  for (unsigned i = 0; i < m_Thresholds.size(); i++)
+    {
+    os << " " << static_cast<typename NumericTraits<PixelType>::PrintType>(m_Thresholds[i]);
+    }
+  os << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,218 @@
+
+#ifndef __itkMultiThresholdImageFilter_h
+#define __itkMultiThresholdImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkMultiThresholdImageCalculator.h"
+
+namespace itk {
+
+/** \class MultiThresholdImageFilter
+ * \brief Label an image using several histogram thresholds
+ *
+ * This filter creates a label image that separates an image into
+ * NumberOfThresholds + 1 classes, such as air, soft tissue, bone and
+ * contrast. The filter computes the thresholds using the
+ * MultiThresholdImageCalculator and labels the input image in a single
+ * pass using the ThresholdLabelerImageFilter. Pixels at or below the
+ * first threshold get LabelOffset, those between the first and second
+ * thresholds LabelOffset + 1, and so on. The NumberOfHistogram bins,
+ * the NumberOfThresholds and the Criterion can be set for the
+ * Calculator, as can the histogram options of the single threshold
+ * filters: exact and sparse histograms, background value, clipped or
+ * fixed histogram range.
+ *
+ * \sa MultiThresholdImageCalculator
+ * \sa ThresholdLabelerImageFilter
+ * \ingroup IntensityImageFilters  Multithreaded
+ */
+
+template<class TInputImage, class TOutputImage>
+class ITK_EXPORT MultiThresholdImageFilter :
+    public ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  /** Standard Self typedef */
+  typedef MultiThresholdImageFilter                      Self;
+  typedef ImageToImageFilter<TInputImage,TOutputImage>  Superclass;
+  typedef SmartPointer<Self>                            Pointer;
+  typedef SmartPointer<const Self>                      ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(MultiThresholdImageFilter, ImageToImageFilter);
+
+  /** Image pixel value typedef. */
+  typedef typename TInputImage::PixelType   InputPixelType;
+  typedef typename TOutputImage::PixelType  OutputPixelType;
+
+  /** Image related typedefs. */
+  typedef typename TInputImage::Pointer  InputImagePointer;
+  typedef typename TOutputImage::Pointer OutputImagePointer;
+
+  typedef typename TInputImage::SizeType    InputSizeType;
+  typedef typename TInputImage::IndexType   InputIndexType;
+  typedef typename TInputImage::RegionType  InputImageRegionType;
+  typedef typename TOutputImage::SizeType   OutputSizeType;
+  typedef typename TOutputImage::IndexType  OutputIndexType;
+  typedef typename TOutputImage::RegionType OutputImageRegionType;
+
+  /** Calculator related typedefs. */
+  typedef MultiThresholdImageCalculator<TInputImage>     CalculatorType;
+  typedef typename CalculatorType::CriterionType         CriterionType;
+  typedef typename CalculatorType::ThresholdVectorType   ThresholdVectorType;
+
+  /** Image related typedefs. */
+  itkStaticConstMacro(InputImageDimension, unsigned int,
+                      TInputImage::ImageDimension );
+  itkStaticConstMacro(OutputImageDimension, unsigned int,
+                      TOutputImage::ImageDimension );
+
+  /** Set/Get the label of the lowest class. The default value
+   * NumericTraits<OutputPixelType>::Zero. */
+  itkSetMacro(LabelOffset,OutputPixelType);
+  itkGetConstMacro(LabelOffset,OutputPixelType);
+
+  /** Set/Get the number of thresholds. Default is 2. */
+  itkSetClampMacro( NumberOfThresholds, unsigned int, 1,
+                    NumericTraits<unsigned int>::max() );
+  itkGetConstMacro( NumberOfThresholds, unsigned int );
+
+  /** Set/Get the criterion. Default is MaxEntropy. */
+  itkSetMacro( Criterion, CriterionType );
+  itkGetConstMacro( Criterion, CriterionType );
+
+  /** Set/Get the order of the Renyi entropy. Default is 0.5. */
+  itkSetMacro( Alpha, double );
+  itkGetConstMacro( Alpha, double );
+
+  /** Set/Get the number of histogram bins. Defaults is 128. */
+  itkSetClampMacro( NumberOfHistogramBins, unsigned long, 1,
+                    NumericTraits<unsigned long>::max() );
+  itkGetConstMacro( NumberOfHistogramBins, unsigned long );
+
+  /** Set/Get whether the calculator should build its histogram from
+   * the distinct pixel values when there are few enough of them.
+   * Default is false. */
+  itkSetMacro( UseExactHistogram, bool );
+  itkGetConstMacro( UseExactHistogram, bool );
+  itkBooleanMacro( UseExactHistogram );
+
+  /** Set/Get the largest number of distinct values for which the
+   * exact histogram is used. Default is 4096. */
+  itkSetClampMacro( MaximumNumberOfExactValues, unsigned long, 2,
+                    NumericTraits<unsigned long>::max() );
+  itkGetConstMacro( MaximumNumberOfExactValues, unsigned long );
+
+  /** Set/Get whether the calculator's binned histogram only stores
+   * the occupied bins. Default is false. */
+  itkSetMacro( UseSparseHistogram, bool );
+  itkGetConstMacro( UseSparseHistogram, bool );
+  itkBooleanMacro( UseSparseHistogram );
+
+  /** Set/Get the background value of the calculator, used when
+   * UseBackgroundValue is on. Default is 0. */
+  itkSetMacro( BackgroundValue, InputPixelType );
+  itkGetConstMacro( BackgroundValue, InputPixelType );
+
+  /** Set/Get whether BackgroundValue is the background of the image.
+   * Default is false. */
+  itkSetMacro( UseBackgroundValue, bool );
+  itkGetConstMacro( UseBackgroundValue, bool );
+  itkBooleanMacro( UseBackgroundValue );
+
+  /** Set/Get whether the background value is estimated from the image.
+   * Default is false. */
+  itkSetMacro( AutomaticBackgroundValue, bool );
+  itkGetConstMacro( AutomaticBackgroundValue, bool );
+  itkBooleanMacro( AutomaticBackgroundValue );
+
+  /** Set/Get whether the calculator's binned histogram spans the
+   * range percentiles of the pixels instead of their whole range.
+   * Default is false. */
+  itkSetMacro( ClipHistogramRange, bool );
+  itkGetConstMacro( ClipHistogramRange, bool );
+  itkBooleanMacro( ClipHistogramRange );
+
+  /** Set/Get the percentiles at the bounds of the clipped range.
+   * Defaults are 0.001 and 0.999. */
+  itkSetClampMacro( LowerRangePercentile, double, 0.0, 1.0 );
+  itkGetConstMacro( LowerRangePercentile, double );
+  itkSetClampMacro( UpperRangePercentile, double, 0.0, 1.0 );
+  itkGetConstMacro( UpperRangePercentile, double );
+
+  /** Set the fixed range of the calculator's binned histogram, which
+   * saves computing the range of the input, and turn
+   * UseFixedHistogramRange on. */
+  void SetHistogramRange(InputPixelType minimum, InputPixelType maximum);
+  itkGetConstMacro( HistogramMinimum, InputPixelType );
+  itkGetConstMacro( HistogramMaximum, InputPixelType );
+
+  /** Set/Get whether the calculator uses the fixed range. Default is
+   * false. */
+  itkSetMacro( UseFixedHistogramRange, bool );
+  itkGetConstMacro( UseFixedHistogramRange, bool );
+  itkBooleanMacro( UseFixedHistogramRange );
+
+  /** Set/Get whether the pixels outside a fixed or clipped range are
+   * counted in the edge bins rather than left out. Default is true. */
+  itkSetMacro( ClampToHistogramRange, bool );
+  itkGetConstMacro( ClampToHistogramRange, bool );
+  itkBooleanMacro( ClampToHistogramRange );
+
+  /** Get the computed thresholds. */
+  itkGetConstReferenceMacro(Thresholds,ThresholdVectorType);
+
+#ifdef ITK_USE_CONCEPT_CHECKING
+  /** Begin concept checking */
+  itkConceptMacro(OutputEqualityComparableCheck,
+    (Concept::EqualityComparable<OutputPixelType>));
+  itkConceptMacro(InputOStreamWritableCheck,
+    (Concept::OStreamWritable<InputPixelType>));
+  itkConceptMacro(OutputOStreamWritableCheck,
+    (Concept::OStreamWritable<OutputPixelType>));
+  /** End concept checking */
+#endif
+protected:
+  MultiThresholdImageFilter();
+  ~MultiThresholdImageFilter(){};
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  void GenerateInputRequestedRegion();
+  void GenerateData ();
+
+private:
+  MultiThresholdImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  ThresholdVectorType m_Thresholds;
+  OutputPixelType     m_LabelOffset;
+  unsigned int        m_NumberOfThresholds;
+  CriterionType       m_Criterion;
+  double              m_Alpha;
+  unsigned long       m_NumberOfHistogramBins;
+  bool                m_UseExactHistogram;
+  unsigned long       m_MaximumNumberOfExactValues;
+  bool                m_UseSparseHistogram;
+  InputPixelType      m_BackgroundValue;
+  bool                m_UseBackgroundValue;
+  bool                m_AutomaticBackgroundValue;
+  bool                m_ClipHistogramRange;
+  double              m_LowerRangePercentile;
+  double              m_UpperRangePercentile;
+  InputPixelType      m_HistogramMinimum;
+  InputPixelType      m_HistogramMaximum;
+  bool                m_UseFixedHistogramRange;
+  bool                m_ClampToHistogramRange;
+
+}; // end of class
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkMultiThresholdImageFilter.txx"
+#endif
+
+#endif
@@ -0,0 +1,167 @@
+#ifndef __itkMultiThresholdImageFilter_txx
+#define __itkMultiThresholdImageFilter_txx
+#include "itkMultiThresholdImageFilter.h"
+
+#include "itkThresholdLabelerImageFilter.h"
+#include "itkProgressAccumulator.h"
+
+namespace itk {
+
+template<class TInputImage, class TOutputImage>
+MultiThresholdImageFilter<TInputImage, TOutputImage>
+::MultiThresholdImageFilter()
+{
+  m_LabelOffset    = NumericTraits<OutputPixelType>::Zero;
+  m_NumberOfThresholds = 2;
+  m_Criterion = CalculatorType::MaxEntropy;
+  m_Alpha = 0.5;
+  m_NumberOfHistogramBins = 128;
+  m_UseExactHistogram = false;
+  m_MaximumNumberOfExactValues = 4096;
+  m_UseSparseHistogram = false;
+  m_BackgroundValue = NumericTraits<InputPixelType>::Zero;
+  m_UseBackgroundValue = false;
+  m_AutomaticBackgroundValue = false;
+  m_ClipHistogramRange = false;
+  m_LowerRangePercentile = 0.001;
+  m_UpperRangePercentile = 0.999;
+  m_HistogramMinimum = NumericTraits<InputPixelType>::Zero;
+  m_HistogramMaximum = NumericTraits<InputPixelType>::Zero;
+  m_UseFixedHistogramRange = false;
+  m_ClampToHistogramRange = true;
+}
+
+template<class TInputImage, class TOutputImage>
+void
+MultiThresholdImageFilter<TInputImage, TOutputImage>
+::SetHistogramRange(InputPixelType minimum, InputPixelType maximum)
+{
+  if ( !( minimum < maximum ) )
+    {
+    itkWarningMacro(<< "Empty histogram range ["
+                    << static_cast<typename NumericTraits<InputPixelType>::PrintType>(minimum) << ", "
+                    << static_cast<typename NumericTraits<InputPixelType>::PrintType>(maximum)
+                    << "]: the range of the image is used instead");
+    }
+  if ( m_HistogramMinimum != minimum || m_HistogramMaximum != maximum ||
+       !m_UseFixedHistogramRange )
+    {
+    m_HistogramMinimum = minimum;
+    m_HistogramMaximum = maximum;
+    m_UseFixedHistogramRange = true;
+    this->Modified();
+    }
+}
+
+template<class TInputImage, class TOutputImage>
+void
+MultiThresholdImageFilter<TInputImage, TOutputImage>
+::GenerateData()
+{
+  typename ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
+  progress->SetMiniPipelineFilter(this);
+
+  // Compute the thresholds for the input image
+  typename CalculatorType::Pointer calculator = CalculatorType::New();
+  calculator->SetImage (this->GetInput());
+  calculator->SetNumberOfThresholds (m_NumberOfThresholds);
+  calculator->SetCriterion (m_Criterion);
+  calculator->SetAlpha (m_Alpha);
+  calculator->SetNumberOfHistogramBins (m_NumberOfHistogramBins);
+  calculator->SetUseExactHistogram (m_UseExactHistogram);
+  calculator->SetMaximumNumberOfExactValues (m_MaximumNumberOfExactValues);
+  calculator->SetUseSparseHistogram (m_UseSparseHistogram);
+  calculator->SetBackgroundValue (m_BackgroundValue);
+  calculator->SetUseBackgroundValue (m_UseBackgroundValue);
+  calculator->SetAutomaticBackgroundValue (m_AutomaticBackgroundValue);
+  calculator->SetClipHistogramRange (m_ClipHistogramRange);
+  calculator->SetLowerRangePercentile (m_LowerRangePercentile);
+  calculator->SetUpperRangePercentile (m_UpperRangePercentile);
+  calculator->SetHistogramMinimum (m_HistogramMinimum);
+  calculator->SetHistogramMaximum (m_HistogramMaximum);
+  calculator->SetUseFixedHistogramRange (m_UseFixedHistogramRange);
+  calculator->SetClampToHistogramRange (m_ClampToHistogramRange);
+  calculator->Compute();
+  m_Thresholds = calculator->GetThresholds();
+
+  // label all the classes in one pass
+  typename ThresholdLabelerImageFilter<TInputImage,TOutputImage>::Pointer labeler =
+    ThresholdLabelerImageFilter<TInputImage,TOutputImage>::New();
+
+  progress->RegisterInternalFilter(labeler,.5f);
+  labeler->GraftOutput (this->GetOutput());
+  labeler->SetInput (this->GetInput());
+  labeler->SetThresholds (m_Thresholds);
+  labeler->SetLabelOffset (m_LabelOffset);
+  labeler->Update();
+
+  this->GraftOutput(labeler->GetOutput());
+}
+
+template<class TInputImage, class TOutputImage>
+void
+MultiThresholdImageFilter<TInputImage, TOutputImage>
+::GenerateInputRequestedRegion()
+{
+  TInputImage * input = const_cast<TInputImage *>(this->GetInput());
+  if( input )
+    {
+    input->SetRequestedRegionToLargestPossibleRegion();
+    }
+}
+
+template<class TInputImage, class TOutputImage>
+void
+MultiThresholdImageFilter<TInputImage,TOutputImage>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf(os,indent);
+
+  os << indent << "LabelOffset: "
+     << static_cast<typename NumericTraits<OutputPixelType>::PrintType>(m_LabelOffset) << std::endl;
+  os << indent << "NumberOfThresholds: "
+     << m_NumberOfThresholds << std::endl;
+  os << indent << "Criterion: "
+     << m_Criterion << std::endl;
+  os << indent << "Alpha: "
+     << m_Alpha << std::endl;
+  os << indent << "NumberOfHistogramBins: "
+     << m_NumberOfHistogramBins << std::endl;
+  os << indent << "UseExactHistogram: "
+     << m_UseExactHistogram << std::endl;
+  os << indent << "MaximumNumberOfExactValues: "
+     << m_MaximumNumberOfExactValues << std::endl;
+  os << indent << "UseSparseHistogram: "
+     << m_UseSparseHistogram << std::endl;
+  os << indent << "BackgroundValue: "
+     << static_cast<typename NumericTraits<InputPixelType>::PrintType>(m_BackgroundValue) << std::endl;
+  os << indent << "UseBackgroundValue: "
+     << m_UseBackgroundValue << std::endl;
+  os << indent << "AutomaticBackgroundValue: "
+     << m_AutomaticBackgroundValue << std::endl;
+  os << indent << "ClipHistogramRange: "
+     << m_ClipHistogramRange << std::endl;
+  os << indent << "LowerRangePercentile: "
+     << m_LowerRangePercentile << std::endl;
+  os << indent << "UpperRangePercentile: "
+     << m_UpperRangePercentile << std::endl;
+  os << indent << "HistogramMinimum: "
+     << static_cast<typename NumericTraits<InputPixelType>::PrintType>(m_HistogramMinimum) << std::endl;
+  os << indent << "HistogramMaximum: "
+     << static_cast<typename NumericTraits<InputPixelType>::PrintType>(m_HistogramMaximum) << std::endl;
+  os << indent << "UseFixedHistogramRange: "
+     << m_UseFixedHistogramRange << std::endl;
+  os << indent << "ClampToHistogramRange: "
+     << m_ClampToHistogramRange << std::endl;
+  os << indent << "Thresholds (computed):";
+  for (unsigned i = 0; i < m_Thresholds.size(); i++)
+    {
+    os << " " << static_cast<typename NumericTraits<InputPixelType>::PrintType>(m_Thresholds[i]);
+    }
+  os << std::endl;
+
+}
+
+
+}// end namespace itk
+#endif
@@ -0,0 +1,88 @@
+
+#ifndef __itkPercentileThresholdImageCalculator_h
+#define __itkPercentileThresholdImageCalculator_h
+
+#include "itkHistogramThresholdImageCalculator.h"
+
+namespace itk
+{
+
+/** \class PercentileThresholdImageCalculator
+ * \brief Computes the Percentile threshold for an image.
+ *
+ * W. Doyle, "Operation useful for similarity-invariant pattern recognition,"
+ * Journal of the Association for Computing Machinery, vol. 9,pp. 259-267, 1962.
+ *
+ * The threshold is the level whose cumulative fraction of the
+ * histogram is closest to Percentile, 0.5 by default.
+ *
+ * Ported to ImageJ plugin by G.Landini from Antti Niemisto's Matlab code (GPL)
+ * Original Matlab code Copyright (C) 2004 Antti Niemisto
+ * See http://www.cs.tut.fi/~ant/histthresh/ for an excellent slide presentation
+ * and the original Matlab code.
+ *
+ * Ported from the ImageJ implementation. http://pacific.mpi-cbg.de/wiki/index.php/Auto_Threshold
+ *
+ * This class is templated over the input image type.
+ * \author Richard Beare
+ * \warning This method assumes that the input image consists of scalar pixel
+ * types.
+ *
+ * \ingroup Operators
+ */
+template <class TInputImage>
+class ITK_EXPORT PercentileThresholdImageCalculator :
+    public HistogramThresholdImageCalculator<TInputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef PercentileThresholdImageCalculator Self;
+  typedef HistogramThresholdImageCalculator<TInputImage> Superclass;
+  typedef SmartPointer<Self>           Pointer;
+  typedef SmartPointer<const Self>     ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(PercentileThresholdImageCalculator, HistogramThresholdImageCalculator);
+
+  /** Type definition for the input image. */
+  typedef TInputImage  ImageType;
+
+  /** Type definition for the input image pixel type. */
+  typedef typename Superclass::PixelType PixelType;
+
+  /** Type definition for the histogram. */
+  typedef typename Superclass::HistogramType HistogramType;
+
+  /** Set/Get the fraction of the histogram at or below the
+   * threshold. Default is 0.5. */
+  itkSetClampMacro( Percentile, double, 0.0, 1.0 );
+  itkGetConstMacro( Percentile, double );
+
+protected:
+  PercentileThresholdImageCalculator();
+  virtual ~PercentileThresholdImageCalculator() {};
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  /** Compute the Percentile threshold from the histogram. */
+  bool ComputeThresholdFromHistogram(const HistogramType & histogram,
+                                     PixelType & threshold) const;
+
+private:
+  PercentileThresholdImageCalculator(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  double               m_Percentile;
+
+};
+
+} // end namespace itk
+
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkPercentileThresholdImageCalculator.txx"
+#endif
+
+#endif
@@ -0,0 +1,65 @@
+
+#ifndef __itkPercentileThresholdImageCalculator_txx
+#define __itkPercentileThresholdImageCalculator_txx
+
+#include "itkPercentileThresholdImageCalculator.h"
+
+#include "vnl/vnl_math.h"
+
+namespace itk
+{
+
+/**
+ * Constructor
+ */
+template<class TInputImage>
+PercentileThresholdImageCalculator<TInputImage>
+::PercentileThresholdImageCalculator()
+{
+  m_Percentile = 0.5;
+}
+
+/*
+ * Compute the Percentile threshold
+ */
+template<class TInputImage>
+bool
+PercentileThresholdImageCalculator<TInputImage>
+::ComputeThresholdFromHistogram(const HistogramType & histogram,
+                                PixelType & thresholdValue) const
+{
+  const std::vector<double> & data = histogram.GetFrequencies();
+
+  int threshold = -1;
+  double total = histogram.GetTotalFrequency();
+  double partialSum = 0;
+  double temp = 1.0;
+  for (unsigned i=0; i<data.size(); i++)
+    {
+    partialSum += data[i];
+    double avec = vcl_abs((partialSum/total)-m_Percentile);
+    if (avec<temp)
+      {
+      temp = avec;
+      threshold = i;
+      }
+    }
+
+  thresholdValue = histogram.EntryToThreshold( threshold );
+  return true;
+
+}
+
+template<class TInputImage>
+void
+PercentileThresholdImageCalculator<TInputImage>
+::PrintSelf( std::ostream& os, Indent indent ) const
+{
+  Superclass::PrintSelf(os,indent);
+
+  os << indent << "Percentile: " << m_Percentile << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,64 @@
+
+#ifndef __itkPercentileThresholdImageFilter_h
+#define __itkPercentileThresholdImageFilter_h
+
+#include "itkHistogramThresholdImageFilter.h"
+#include "itkPercentileThresholdImageCalculator.h"
+
+namespace itk {
+
+/** \class PercentileThresholdImageFilter 
+ * \brief Threshold an image using the Percentile Threshold
+ *
+ * This filter creates a binary thresholded image that separates an
+ * image into foreground and background components. The filter
+ * computes the threshold using the PercentileThresholdImageCalculator and
+ * applies that theshold to the input image using the
+ * BinaryThresholdImageFilter. The NunberOfHistogram bins can be set
+ * for the Calculator. The InsideValue and OutsideValue can be set
+ * for the BinaryThresholdImageFilter. Code derived from OtsuThresholdImageFilter
+ *
+ * \sa PercentileThresholdImageCalculator
+ * \sa HistogramThresholdImageFilter
+ * \sa BinaryThresholdImageFilter 
+ * \sa OtsuThresholdImageFilter
+ * \ingroup IntensityImageFilters  Multithreaded
+ */
+
+template<class TInputImage, class TOutputImage>
+class ITK_EXPORT PercentileThresholdImageFilter :
+    public HistogramThresholdImageFilter<TInputImage, TOutputImage,
+                                         PercentileThresholdImageCalculator<TInputImage> >
+{
+public:
+  /** Standard Self typedef */
+  typedef PercentileThresholdImageFilter                      Self;
+  typedef HistogramThresholdImageFilter<TInputImage, TOutputImage,
+    PercentileThresholdImageCalculator<TInputImage> >        Superclass;
+  typedef SmartPointer<Self>                            Pointer;
+  typedef SmartPointer<const Self>                      ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(PercentileThresholdImageFilter, HistogramThresholdImageFilter);
+
+  /** Set/Get the fraction of the histogram at or below the
+   * threshold. Default is 0.5. */
+  itkSetCalculatorMacro( Percentile, double );
+  itkGetCalculatorMacro( Percentile, double );
+
+protected:
+  PercentileThresholdImageFilter() {};
+  ~PercentileThresholdImageFilter(){};
+
+private:
+  PercentileThresholdImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+}; // end of class
+
+} // end namespace itk
+
+#endif
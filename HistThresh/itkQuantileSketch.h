@@ -0,0 +1,181 @@
+#ifndef __itkQuantileSketch_h
+#define __itkQuantileSketch_h
+
+#include <vector>
+#include <cmath>
+
+namespace itk
+{
+
+/** \class QuantileSketch
+ * \brief Summary of a stream of values giving quantiles within a
+ * relative accuracy.
+ *
+ * The values are counted in buckets whose bounds grow geometrically,
+ * bucket k of a sign holding the magnitudes in (g^(k-1), g^k] with
+ * g = (1 + a) / (1 - a), a being the RelativeAccuracy. A quantile is
+ * the middle of the bucket holding the value of that rank, which is
+ * within a relative error a of that value. Magnitudes below
+ * GetMinimumMagnitude() are counted as zero.
+ *
+ * The memory depends on the range of the values and on a, not on
+ * their number: about log(max / min) / a buckets. Two sketches of the
+ * same accuracy merge by adding their buckets, so that the values can
+ * be split between threads.
+ *
+ * \sa MaskQuantileImageFilter
+ */
+class QuantileSketch
+{
+public:
+  QuantileSketch(double relativeAccuracy = 0.01)
+    { this->SetRelativeAccuracy( relativeAccuracy ); }
+
+  /** Set the relative accuracy, which empties the sketch. */
+  void SetRelativeAccuracy(double relativeAccuracy)
+    {
+    m_RelativeAccuracy = relativeAccuracy;
+    m_Gamma = ( 1.0 + relativeAccuracy ) / ( 1.0 - relativeAccuracy );
+    m_LogGamma = std::log( m_Gamma );
+    m_Positive.Clear();
+    m_Negative.Clear();
+    m_Zero = 0;
+    m_Count = 0;
+    }
+  double GetRelativeAccuracy() const
+    { return m_RelativeAccuracy; }
+
+  /** Number of values added. */
+  unsigned long GetCount() const
+    { return m_Count; }
+
+  /** Add a value. */
+  void Add(double value)
+    {
+    m_Count++;
+    if ( value > GetMinimumMagnitude() )
+      {
+      m_Positive.Add( this->GetKey( value ), 1 );
+      }
+    else if ( value < -GetMinimumMagnitude() )
+      {
+      m_Negative.Add( this->GetKey( -value ), 1 );
+      }
+    else
+      {
+      m_Zero++;
+      }
+    }
+
+  /** Add the values of a sketch of the same accuracy. */
+  void Merge(const QuantileSketch & other)
+    {
+    m_Positive.Merge( other.m_Positive );
+    m_Negative.Merge( other.m_Negative );
+    m_Zero += other.m_Zero;
+    m_Count += other.m_Count;
+    }
+
+  /** Value of rank q * (count - 1), for q in [0, 1]. */
+  double GetQuantile(double q) const
+    {
+    if ( m_Count == 0 )
+      {
+      return 0.0;
+      }
+    q = q < 0.0 ? 0.0 : ( q > 1.0 ? 1.0 : q );
+    const unsigned long rank =
+      static_cast<unsigned long>( q * ( m_Count - 1 ) );
+
+    // the negative values come first, largest magnitude first
+    unsigned long seen = 0;
+    for ( long i = long( m_Negative.Counts.size() ) - 1; i >= 0; i-- )
+      {
+      seen += m_Negative.Counts[i];
+      if ( seen > rank )
+        {
+        return -this->GetValue( m_Negative.Offset + i );
+        }
+      }
+    seen += m_Zero;
+    if ( seen > rank )
+      {
+      return 0.0;
+      }
+    for ( unsigned long i = 0; i < m_Positive.Counts.size(); i++ )
+      {
+      seen += m_Positive.Counts[i];
+      if ( seen > rank )
+        {
+        return this->GetValue( m_Positive.Offset + i );
+        }
+      }
+    return this->GetValue( m_Positive.Offset + m_Positive.Counts.size() - 1 );
+    }
+
+  /** Smallest magnitude not counted as zero. */
+  static double GetMinimumMagnitude()
+    { return 1e-100; }
+
+private:
+  /** Counts of the buckets of one sign, from key Offset on. */
+  struct Store
+    {
+    long                        Offset;
+    std::vector<unsigned long>  Counts;
+
+    void Clear()
+      {
+      Offset = 0;
+      Counts.clear();
+      }
+
+    void Add(long key, unsigned long count)
+      {
+      if ( Counts.empty() )
+        {
+        Offset = key;
+        Counts.assign( 1, 0 );
+        }
+      else if ( key < Offset )
+        {
+        Counts.insert( Counts.begin(), Offset - key, 0 );
+        Offset = key;
+        }
+      else if ( key >= Offset + long( Counts.size() ) )
+        {
+        Counts.resize( key - Offset + 1, 0 );
+        }
+      Counts[key - Offset] += count;
+      }
+
+    void Merge(const Store & other)
+      {
+      for ( unsigned long i = 0; i < other.Counts.size(); i++ )
+        {
+        if ( other.Counts[i] )
+          {
+          this->Add( other.Offset + i, other.Counts[i] );
+          }
+        }
+      }
+    };
+
+  long GetKey(double magnitude) const
+    { return static_cast<long>( std::ceil( std::log( magnitude ) / m_LogGamma ) ); }
+
+  double GetValue(long key) const
+    { return 2.0 * std::pow( m_Gamma, double( key ) ) / ( m_Gamma + 1.0 ); }
+
+  double          m_RelativeAccuracy;
+  double          m_Gamma;
+  double          m_LogGamma;
+  Store           m_Positive;
+  Store           m_Negative;
+  unsigned long   m_Zero;
+  unsigned long   m_Count;
+};
+
+} // end namespace itk
+
+#endif
@@ -3,97 +3,23 @@
 #define __itkRenyiEntropyThresholdImageCalculator_txx
 
 #include "itkRenyiEntropyThresholdImageCalculator.h"
-#include "itkImageRegionConstIteratorWithIndex.h"
-#include "itkMinimumMaximumImageCalculator.h"
 
 #include "vnl/vnl_math.h"
 
 namespace itk
-{ 
-    
-/**
- * Constructor
- */
-template<class TInputImage>
-RenyiEntropyThresholdImageCalculator<TInputImage>
-::RenyiEntropyThresholdImageCalculator()
 {
-  m_Image = NULL;
-  m_Threshold = NumericTraits<PixelType>::Zero;
-  m_NumberOfHistogramBins = 128;
-  m_RegionSetByUser = false;
-}
-
 
 /*
  * Compute the RenyiEntropy's threshold
  */
 template<class TInputImage>
-void
+bool
 RenyiEntropyThresholdImageCalculator<TInputImage>
-::Compute(void)
+::ComputeThresholdFromHistogram(const HistogramType & histogram,
+                                PixelType & thresholdValue) const
 {
+  const std::vector<double> & relativeFrequency = histogram.GetFrequencies();
 
-  if ( !m_Image ) { return; }
-  if( !m_RegionSetByUser )
-    {
-    m_Region = m_Image->GetRequestedRegion();
-    }
-
-  double totalPixels = (double) m_Region.GetNumberOfPixels();
-  if ( totalPixels == 0 ) { return; }
-
-
-  // compute image max and min
-  typedef MinimumMaximumImageCalculator<TInputImage> RangeCalculator;
-  typename RangeCalculator::Pointer rangeCalculator = RangeCalculator::New();
-  rangeCalculator->SetImage( m_Image );
-  rangeCalculator->Compute();
-
-  PixelType imageMin = rangeCalculator->GetMinimum();
-  PixelType imageMax = rangeCalculator->GetMaximum();
-
-  if ( imageMin >= imageMax )
-    {
-    m_Threshold = imageMin;
-    return;
-    }
-
-  // create a histogram
-  std::vector<double> relativeFrequency;
-
-  relativeFrequency.resize( m_NumberOfHistogramBins );
-
-  std::fill(relativeFrequency.begin(), relativeFrequency.end(), 0.0);
-
-  double binMultiplier = (double) m_NumberOfHistogramBins /
-    (double) ( imageMax - imageMin );
-
-  typedef ImageRegionConstIteratorWithIndex<TInputImage> Iterator;
-  Iterator iter( m_Image, m_Region );
-
-  while ( !iter.IsAtEnd() )
-    {
-    unsigned int binNumber;
-    PixelType value = iter.Get();
-
-    if ( value == imageMin ) 
-      {
-      binNumber = 0;
-      }
-    else
-      {
-      binNumber = (unsigned int) vcl_ceil((value - imageMin) * binMultiplier ) - 1;
-      if ( binNumber == m_NumberOfHistogramBins ) // in case of rounding errors
-        {
-        binNumber -= 1;
-        }
-      }
-
-    relativeFrequency[binNumber] += 1.0;
-    ++iter;
-
-    }
   const double tolerance = 2.220446049250313E-16;
   int threshold; 
   int opt_threshold;
@@ -111,9 +37,9 @@ RenyiEntropyThresholdImageCalculator<TInputImage>
   double ent_back; /* entropy of the background pixels at a given threshold */
   double ent_obj;  /* entropy of the object pixels at a given threshold */
   double omega;
-  std::vector<double> norm_histo(relativeFrequency.size()); /* normalized histogram */
-  std::vector<double> P1(relativeFrequency.size());  /* cumulative normalized histogram */
-  std::vector<double> P2(relativeFrequency.size());
+  ScratchArrayType norm_histo(relativeFrequency.size()); /* normalized histogram */
+  ScratchArrayType P1(relativeFrequency.size());  /* cumulative normalized histogram */
+  ScratchArrayType P2(relativeFrequency.size());
   
   int total =0;
   for (ih = 0; (unsigned)ih < relativeFrequency.size(); ih++ )
@@ -272,10 +198,15 @@ RenyiEntropyThresholdImageCalculator<TInputImage>
     t_star2 = tmp_var;
     }
   
+  /* The combination below works on gray levels, so use positions */
+  const double x_star1 = histogram.GetPosition(t_star1);
+  const double x_star2 = histogram.GetPosition(t_star2);
+  const double x_star3 = histogram.GetPosition(t_star3);
+
   /* Adjust beta values */
-  if ( vcl_abs ( t_star1 - t_star2 ) <= 5 )  
+  if ( vcl_abs ( x_star1 - x_star2 ) <= 5 )  
     {
-    if ( vcl_abs ( t_star2 - t_star3 ) <= 5 ) 
+    if ( vcl_abs ( x_star2 - x_star3 ) <= 5 ) 
       {
       beta1 = 1;
       beta2 = 2;
@@ -290,7 +221,7 @@ RenyiEntropyThresholdImageCalculator<TInputImage>
     }
   else
     {
-    if ( vcl_abs ( t_star2 - t_star3 ) <= 5 ) 
+    if ( vcl_abs ( x_star2 - x_star3 ) <= 5 ) 
       {
       beta1 = 3;
       beta2 = 1;
@@ -306,35 +237,12 @@ RenyiEntropyThresholdImageCalculator<TInputImage>
   //IJ.log(""+t_star1+" "+t_star2+" "+t_star3);
   /* Determine the optimal threshold value */
   omega = P1[t_star3] - P1[t_star1];
-  opt_threshold = (int) (t_star1 * ( P1[t_star1] + 0.25 * omega * beta1 ) + 0.25 * t_star2 * omega * beta2  + t_star3 * ( P2[t_star3] + 0.25 * omega * beta3 ));
+  opt_threshold = (int) (x_star1 * ( P1[t_star1] + 0.25 * omega * beta1 ) + 0.25 * x_star2 * omega * beta2  + x_star3 * ( P2[t_star3] + 0.25 * omega * beta3 ));
   
   
-  m_Threshold = static_cast<PixelType>( imageMin + 
-                                        ( opt_threshold ) / binMultiplier );
-
-
-}
-
-template<class TInputImage>
-void
-RenyiEntropyThresholdImageCalculator<TInputImage>
-::SetRegion( const RegionType & region )
-{
-  m_Region = region;
-  m_RegionSetByUser = true;
-}
-
-  
-template<class TInputImage>
-void
-RenyiEntropyThresholdImageCalculator<TInputImage>
-::PrintSelf( std::ostream& os, Indent indent ) const
-{
-  Superclass::PrintSelf(os,indent);
+  thresholdValue = histogram.PositionToThreshold( opt_threshold );
+  return true;
 
-  os << indent << "Threshold: " << m_Threshold << std::endl;
-  os << indent << "NumberOfHistogramBins: " << m_NumberOfHistogramBins << std::endl;
-  os << indent << "Image: " << m_Image.GetPointer() << std::endl;
 }
 
 } // end namespace itk
@@ -0,0 +1,229 @@
+#ifndef __itkRunLengthMask_h
+#define __itkRunLengthMask_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkImage.h"
+#include <vector>
+
+namespace itk
+{
+
+/** \class RunLengthMask
+ * \brief Binary mask storing the runs of set voxels along each row.
+ *
+ * A mask over a region, stored as the runs of set voxels of each row
+ * along the first axis. The runs of a row are sorted, do not overlap
+ * and are separated by at least one voxel that is not set. A run goes
+ * from Begin up to, but not including, End, both counted from the
+ * start of the row. Rows are numbered in the order of the region's
+ * buffer.
+ *
+ * The size of the mask follows the number of runs rather than the
+ * number of voxels, so that sparse masks and masks made of large
+ * blobs are both small. Erode(), Dilate(), Opening() and Closing()
+ * work on the runs directly, with box or cross structuring elements,
+ * one pass along each axis with a non null radius. The pass along the
+ * first axis moves the ends of each run and costs O(runs). A pass
+ * along another axis merges, for each row, the 2 * radius + 1 rows of
+ * the line through it, and so costs O(radius * runs) for the radius
+ * along that axis. As in the grayscale filters, voxels outside the
+ * region are set for the erosion and not set for the dilation.
+ *
+ * The mask is filled row by row: Clear() removes every row, then each
+ * row is added in turn with AppendRun() and EndRow(), or from packed
+ * bits with AppendRow(). AppendRows() adds the rows of another mask,
+ * so that pieces filled separately can be joined in order. GetImage()
+ * converts the mask to a standard image, with OnValue in the runs and
+ * OffValue elsewhere.
+ *
+ * \sa BinaryBitMask
+ * \sa HistogramThresholdImageFilter
+ * \ingroup DataRepresentation
+ */
+template <unsigned int VDimension>
+class ITK_EXPORT RunLengthMask : public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef RunLengthMask             Self;
+  typedef Object                    Superclass;
+  typedef SmartPointer<Self>        Pointer;
+  typedef SmartPointer<const Self>  ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(RunLengthMask, Object);
+
+  itkStaticConstMacro(ImageDimension, unsigned int, VDimension);
+
+  /** Image the mask converts to. */
+  typedef Image<unsigned char, VDimension>  ImageType;
+  typedef typename ImageType::Pointer       ImagePointer;
+  typedef typename ImageType::RegionType    RegionType;
+  typedef typename ImageType::IndexType     IndexType;
+  typedef typename ImageType::SizeType      SizeType;
+  typedef typename ImageType::SpacingType   SpacingType;
+  typedef typename ImageType::PointType     PointType;
+  typedef typename ImageType::DirectionType DirectionType;
+
+  /** A run of set voxels of a row. */
+  struct RunType
+    {
+    RunType( long begin = 0, long end = 0 ) : Begin( begin ), End( end ) {}
+    long Begin;
+    long End;
+    };
+  typedef std::vector<RunType>        RunContainerType;
+  typedef std::vector<unsigned long>  RowOffsetContainerType;
+
+  /** Shapes of the structuring elements. */
+  typedef enum { Box = 0, Cross } StructuringElementType;
+
+  /** Word of the packed bits read by AppendRow(). */
+  typedef unsigned int WordType;
+  itkStaticConstMacro(BitsPerWord, unsigned int, 32);
+
+  /** Set/Get the region covered by the mask. */
+  itkSetMacro(Region, RegionType);
+  itkGetConstReferenceMacro(Region, RegionType);
+
+  /** Get the geometry passed on to the converted image. */
+  itkGetConstReferenceMacro(Spacing, SpacingType);
+  itkGetConstReferenceMacro(Origin, PointType);
+  itkGetConstReferenceMacro(Direction, DirectionType);
+
+  /** Take the requested region and the geometry of an image. */
+  template <class TImage>
+  void CopyInformation(const TImage * image)
+    {
+    m_Region = image->GetRequestedRegion();
+    m_Spacing = image->GetSpacing();
+    m_Origin = image->GetOrigin();
+    m_Direction = image->GetDirection();
+    this->Modified();
+    }
+
+  /** Take the region, the geometry and the values of another mask. */
+  void CopyInformation(const Self * mask);
+
+  /** Copy another mask, runs included. */
+  void DeepCopy(const Self * mask);
+
+  /** Set/Get the values of the converted image. Defaults are 1 in the
+   * runs and 0 elsewhere. */
+  itkSetMacro(OnValue, unsigned char);
+  itkGetConstMacro(OnValue, unsigned char);
+  itkSetMacro(OffValue, unsigned char);
+  itkGetConstMacro(OffValue, unsigned char);
+
+  /** Remove every row. */
+  void Clear();
+
+  /** Add a run to the row being filled. Runs must come in order. */
+  void AppendRun(long begin, long end)
+    { m_Runs.push_back( RunType( begin, end ) ); }
+
+  /** Finish the row being filled and start the next one. */
+  void EndRow()
+    { m_RowStart.push_back( m_Runs.size() ); }
+
+  /** Add a row from length bits packed as in a BinaryBitMask. */
+  void AppendRow(const WordType * words, unsigned long length);
+
+  /** Add the rows of another mask after the rows filled. */
+  void AppendRows(const Self * mask);
+
+  /** Number of rows filled. */
+  unsigned long GetNumberOfRows() const
+    { return m_RowStart.size() - 1; }
+
+  /** Number of the row holding index. index[0] is ignored. */
+  unsigned long GetRowNumber(const IndexType & index) const;
+
+  /** Runs of a row, from GetRunsBegin() up to GetRunsEnd(). */
+  const RunType * GetRunsBegin(unsigned long row) const
+    { return this->GetRunPointer( m_RowStart[row] ); }
+  const RunType * GetRunsEnd(unsigned long row) const
+    { return this->GetRunPointer( m_RowStart[row + 1] ); }
+
+  /** Whether a voxel is in a run. */
+  bool GetPixel(const IndexType & index) const;
+
+  /** Number of runs. */
+  unsigned long GetNumberOfRuns() const
+    { return m_Runs.size(); }
+
+  /** Number of voxels in the runs. */
+  unsigned long GetNumberOfSetPixels() const;
+
+  /** Size of the runs and row offsets in bytes. */
+  unsigned long GetBufferSize() const
+    {
+    return m_Runs.size() * sizeof(RunType)
+      + m_RowStart.size() * sizeof(unsigned long);
+    }
+
+  /** Morphological operations on the runs, with a structuring element
+   * of the given radius in voxels along each axis. */
+  void Erode(const SizeType & radius, StructuringElementType shape = Box);
+  void Dilate(const SizeType & radius, StructuringElementType shape = Box);
+  void Opening(const SizeType & radius, StructuringElementType shape = Box);
+  void Closing(const SizeType & radius, StructuringElementType shape = Box);
+
+  /** The mask as a standard image, converted when the mask has
+   * changed since the last call. */
+  ImageType * GetImage();
+
+protected:
+  RunLengthMask();
+  virtual ~RunLengthMask() {};
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  /** Erode or dilate the runs along one axis, with a line of
+   * 2 * radius + 1 voxels. Costs O(runs) along the first axis and
+   * O(radius * runs) along the others. */
+  void ComputeLine(unsigned int axis, unsigned long radius, bool dilate,
+                   Self * output) const;
+
+  /** Erode or dilate with a box or a cross, leaving the mask
+   * unchanged for a null radius. */
+  void Apply(const SizeType & radius, StructuringElementType shape,
+             bool dilate);
+
+  /** Union and intersection of two rows of runs, written to out. */
+  static void UniteRuns(const RunType * a, const RunType * aEnd,
+                        const RunType * b, const RunType * bEnd,
+                        RunContainerType & out);
+  static void IntersectRuns(const RunType * a, const RunType * aEnd,
+                            const RunType * b, const RunType * bEnd,
+                            RunContainerType & out);
+
+private:
+  RunLengthMask(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  const RunType * GetRunPointer(unsigned long offset) const
+    { return m_Runs.empty() ? 0 : &m_Runs[0] + offset; }
+
+  RegionType              m_Region;
+  SpacingType             m_Spacing;
+  PointType               m_Origin;
+  DirectionType           m_Direction;
+  unsigned char           m_OnValue;
+  unsigned char           m_OffValue;
+  RunContainerType        m_Runs;
+  RowOffsetContainerType  m_RowStart;
+  ImagePointer            m_Image;
+  unsigned long           m_ImageMTime;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkRunLengthMask.txx"
+#endif
+
+#endif
@@ -0,0 +1,466 @@
+#ifndef __itkRunLengthMask_txx
+#define __itkRunLengthMask_txx
+
+#include "itkRunLengthMask.h"
+#include "itkImageLinearIteratorWithIndex.h"
+#include <algorithm>
+
+namespace itk
+{
+
+template <unsigned int VDimension>
+RunLengthMask<VDimension>
+::RunLengthMask()
+{
+  m_Spacing.Fill( 1.0 );
+  m_Origin.Fill( 0.0 );
+  m_Direction.SetIdentity();
+  m_OnValue = 1;
+  m_OffValue = 0;
+  m_RowStart.assign( 1, 0 );
+  m_ImageMTime = 0;
+}
+
+template <unsigned int VDimension>
+void
+RunLengthMask<VDimension>
+::CopyInformation(const Self * mask)
+{
+  m_Region = mask->m_Region;
+  m_Spacing = mask->m_Spacing;
+  m_Origin = mask->m_Origin;
+  m_Direction = mask->m_Direction;
+  m_OnValue = mask->m_OnValue;
+  m_OffValue = mask->m_OffValue;
+  this->Modified();
+}
+
+template <unsigned int VDimension>
+void
+RunLengthMask<VDimension>
+::DeepCopy(const Self * mask)
+{
+  this->CopyInformation( mask );
+  m_Runs = mask->m_Runs;
+  m_RowStart = mask->m_RowStart;
+}
+
+template <unsigned int VDimension>
+void
+RunLengthMask<VDimension>
+::Clear()
+{
+  m_Runs.clear();
+  m_RowStart.assign( 1, 0 );
+  this->Modified();
+}
+
+template <unsigned int VDimension>
+void
+RunLengthMask<VDimension>
+::AppendRow(const WordType * words, unsigned long length)
+{
+  // words of the same value as the run being followed are skipped; the
+  // bits past the end of the row are never set, so a partial last word
+  // is always looked at bit by bit
+  long begin = -1;
+  for ( unsigned long w = 0; w * BitsPerWord < length; w++ )
+    {
+    const WordType word = words[w];
+    if ( word == ( begin < 0 ? WordType( 0 ) : ~WordType( 0 ) ) )
+      {
+      continue;
+      }
+    const long base = w * BitsPerWord;
+    const long bits = std::min( (unsigned long)BitsPerWord, length - base );
+    for ( long k = 0; k < bits; k++ )
+      {
+      const bool set = ( word >> k ) & 1;
+      if ( set && begin < 0 )
+        {
+        begin = base + k;
+        }
+      else if ( !set && begin >= 0 )
+        {
+        this->AppendRun( begin, base + k );
+        begin = -1;
+        }
+      }
+    }
+  if ( begin >= 0 )
+    {
+    this->AppendRun( begin, length );
+    }
+  this->EndRow();
+}
+
+template <unsigned int VDimension>
+void
+RunLengthMask<VDimension>
+::AppendRows(const Self * mask)
+{
+  const unsigned long offset = m_Runs.size();
+  m_Runs.insert( m_Runs.end(), mask->m_Runs.begin(), mask->m_Runs.end() );
+  for ( unsigned long r = 1; r < mask->m_RowStart.size(); r++ )
+    {
+    m_RowStart.push_back( offset + mask->m_RowStart[r] );
+    }
+}
+
+template <unsigned int VDimension>
+unsigned long
+RunLengthMask<VDimension>
+::GetRowNumber(const IndexType & index) const
+{
+  unsigned long row = 0;
+  unsigned long stride = 1;
+  for ( unsigned int d = 1; d < VDimension; d++ )
+    {
+    row += ( index[d] - m_Region.GetIndex()[d] ) * stride;
+    stride *= m_Region.GetSize()[d];
+    }
+  return row;
+}
+
+template <unsigned int VDimension>
+bool
+RunLengthMask<VDimension>
+::GetPixel(const IndexType & index) const
+{
+  const long x = index[0] - m_Region.GetIndex()[0];
+  const unsigned long row = this->GetRowNumber( index );
+
+  // first run starting after x
+  const RunType * first = this->GetRunsBegin( row );
+  const RunType * last = this->GetRunsEnd( row );
+  while ( first != last )
+    {
+    const RunType * middle = first + ( last - first ) / 2;
+    if ( middle->Begin <= x )
+      {
+      first = middle + 1;
+      }
+    else
+      {
+      last = middle;
+      }
+    }
+  return first != this->GetRunsBegin( row ) && x < ( first - 1 )->End;
+}
+
+template <unsigned int VDimension>
+unsigned long
+RunLengthMask<VDimension>
+::GetNumberOfSetPixels() const
+{
+  unsigned long count = 0;
+  for ( unsigned long r = 0; r < m_Runs.size(); r++ )
+    {
+    count += m_Runs[r].End - m_Runs[r].Begin;
+    }
+  return count;
+}
+
+template <unsigned int VDimension>
+void
+RunLengthMask<VDimension>
+::UniteRuns(const RunType * a, const RunType * aEnd,
+            const RunType * b, const RunType * bEnd,
+            RunContainerType & out)
+{
+  out.clear();
+  while ( a != aEnd || b != bEnd )
+    {
+    const RunType * next;
+    if ( b == bEnd || ( a != aEnd && a->Begin <= b->Begin ) )
+      {
+      next = a++;
+      }
+    else
+      {
+      next = b++;
+      }
+    // touching runs are merged too
+    if ( !out.empty() && next->Begin <= out.back().End )
+      {
+      out.back().End = std::max( out.back().End, next->End );
+      }
+    else
+      {
+      out.push_back( *next );
+      }
+    }
+}
+
+template <unsigned int VDimension>
+void
+RunLengthMask<VDimension>
+::IntersectRuns(const RunType * a, const RunType * aEnd,
+                const RunType * b, const RunType * bEnd,
+                RunContainerType & out)
+{
+  out.clear();
+  while ( a != aEnd && b != bEnd )
+    {
+    const long begin = std::max( a->Begin, b->Begin );
+    const long end = std::min( a->End, b->End );
+    if ( begin < end )
+      {
+      out.push_back( RunType( begin, end ) );
+      }
+    if ( a->End < b->End )
+      {
+      ++a;
+      }
+    else
+      {
+      ++b;
+      }
+    }
+}
+
+template <unsigned int VDimension>
+void
+RunLengthMask<VDimension>
+::ComputeLine(unsigned int axis, unsigned long radius, bool dilate,
+              Self * output) const
+{
+  output->CopyInformation( this );
+  output->Clear();
+
+  const SizeType size = m_Region.GetSize();
+  const long length = size[axis];
+  const long r = radius;
+  const unsigned long rows = this->GetNumberOfRows();
+
+  if ( axis == 0 )
+    {
+    // the runs grow or shrink by the radius at both ends
+    for ( unsigned long row = 0; row < rows; row++ )
+      {
+      const unsigned long rowStart = output->m_Runs.size();
+      for ( const RunType * run = this->GetRunsBegin( row );
+            run != this->GetRunsEnd( row ); ++run )
+        {
+        if ( dilate )
+          {
+          const long begin = std::max( run->Begin - r, 0L );
+          const long end = std::min( run->End + r, length );
+          if ( output->m_Runs.size() > rowStart
+               && begin <= output->m_Runs.back().End )
+            {
+            output->m_Runs.back().End = end;
+            }
+          else
+            {
+            output->AppendRun( begin, end );
+            }
+          }
+        else
+          {
+          // the voxels outside the row are set
+          const long begin = run->Begin == 0 ? 0 : run->Begin + r;
+          const long end = run->End == length ? length : run->End - r;
+          if ( begin < end )
+            {
+            output->AppendRun( begin, end );
+            }
+          }
+        }
+      output->EndRow();
+      }
+    return;
+    }
+
+  // the rows along the axis are stride rows apart. Each output row is
+  // the union, or intersection, of the input rows of the line that
+  // fall in the region.
+  unsigned long stride = 1;
+  for ( unsigned int d = 1; d < axis; d++ )
+    {
+    stride *= size[d];
+    }
+
+  RunContainerType accumulated;
+  RunContainerType scratch;
+  for ( unsigned long row = 0; row < rows; row++ )
+    {
+    const long y = ( row / stride ) % length;
+    const long first = std::max( y - r, 0L );
+    const long last = std::min( y + r, length - 1 );
+    const unsigned long firstRow = row - ( y - first ) * stride;
+    accumulated.assign( this->GetRunsBegin( firstRow ),
+                        this->GetRunsEnd( firstRow ) );
+    for ( long k = first + 1;
+          k <= last && ( dilate || !accumulated.empty() ); k++ )
+      {
+      const unsigned long other = firstRow + ( k - first ) * stride;
+      const RunType * runs = accumulated.empty() ? 0 : &accumulated[0];
+      if ( dilate )
+        {
+        UniteRuns( runs, runs + accumulated.size(),
+                   this->GetRunsBegin( other ), this->GetRunsEnd( other ),
+                   scratch );
+        }
+      else
+        {
+        IntersectRuns( runs, runs + accumulated.size(),
+                       this->GetRunsBegin( other ), this->GetRunsEnd( other ),
+                       scratch );
+        }
+      accumulated.swap( scratch );
+      }
+    output->m_Runs.insert( output->m_Runs.end(),
+                           accumulated.begin(), accumulated.end() );
+    output->EndRow();
+    }
+}
+
+template <unsigned int VDimension>
+void
+RunLengthMask<VDimension>
+::Apply(const SizeType & radius, StructuringElementType shape, bool dilate)
+{
+  // a box is the lines along each axis applied in turn, a cross the
+  // union, or intersection, of the lines applied to the mask
+  Pointer result;
+  RunContainerType runs;
+  for ( unsigned int d = 0; d < VDimension; d++ )
+    {
+    if ( radius[d] == 0 )
+      {
+      continue;
+      }
+    Pointer line = Self::New();
+    if ( shape == Box )
+      {
+      ( result ? result.GetPointer() : this )->ComputeLine( d, radius[d],
+                                                            dilate, line );
+      result = line;
+      continue;
+      }
+    this->ComputeLine( d, radius[d], dilate, line );
+    if ( !result )
+      {
+      result = line;
+      continue;
+      }
+    Pointer combined = Self::New();
+    combined->CopyInformation( this );
+    combined->Clear();
+    for ( unsigned long row = 0; row < this->GetNumberOfRows(); row++ )
+      {
+      if ( dilate )
+        {
+        UniteRuns( result->GetRunsBegin( row ), result->GetRunsEnd( row ),
+                   line->GetRunsBegin( row ), line->GetRunsEnd( row ), runs );
+        }
+      else
+        {
+        IntersectRuns( result->GetRunsBegin( row ), result->GetRunsEnd( row ),
+                       line->GetRunsBegin( row ), line->GetRunsEnd( row ), runs );
+        }
+      combined->m_Runs.insert( combined->m_Runs.end(), runs.begin(), runs.end() );
+      combined->EndRow();
+      }
+    result = combined;
+    }
+
+  if ( result )
+    {
+    m_Runs.swap( result->m_Runs );
+    m_RowStart.swap( result->m_RowStart );
+    this->Modified();
+    }
+}
+
+template <unsigned int VDimension>
+void
+RunLengthMask<VDimension>
+::Erode(const SizeType & radius, StructuringElementType shape)
+{
+  this->Apply( radius, shape, false );
+}
+
+template <unsigned int VDimension>
+void
+RunLengthMask<VDimension>
+::Dilate(const SizeType & radius, StructuringElementType shape)
+{
+  this->Apply( radius, shape, true );
+}
+
+template <unsigned int VDimension>
+void
+RunLengthMask<VDimension>
+::Opening(const SizeType & radius, StructuringElementType shape)
+{
+  this->Apply( radius, shape, false );
+  this->Apply( radius, shape, true );
+}
+
+template <unsigned int VDimension>
+void
+RunLengthMask<VDimension>
+::Closing(const SizeType & radius, StructuringElementType shape)
+{
+  this->Apply( radius, shape, true );
+  this->Apply( radius, shape, false );
+}
+
+template <unsigned int VDimension>
+typename RunLengthMask<VDimension>::ImageType *
+RunLengthMask<VDimension>
+::GetImage()
+{
+  if ( m_Image && m_ImageMTime >= this->GetMTime() )
+    {
+    return m_Image.GetPointer();
+    }
+
+  m_Image = ImageType::New();
+  m_Image->SetRegions( m_Region );
+  m_Image->SetSpacing( m_Spacing );
+  m_Image->SetOrigin( m_Origin );
+  m_Image->SetDirection( m_Direction );
+  m_Image->Allocate();
+
+  const unsigned long rowLength = m_Region.GetSize()[0];
+  ImageLinearIteratorWithIndex<ImageType> it( m_Image, m_Region );
+  it.SetDirection( 0 );
+  it.GoToBegin();
+  for ( unsigned long row = 0; !it.IsAtEnd(); row++ )
+    {
+    unsigned char * out =
+      m_Image->GetBufferPointer() + m_Image->ComputeOffset( it.GetIndex() );
+    std::fill( out, out + rowLength, m_OffValue );
+    for ( const RunType * run = this->GetRunsBegin( row );
+          run != this->GetRunsEnd( row ); ++run )
+      {
+      std::fill( out + run->Begin, out + run->End, m_OnValue );
+      }
+    it.NextLine();
+    }
+
+  m_ImageMTime = this->GetMTime();
+  return m_Image.GetPointer();
+}
+
+template <unsigned int VDimension>
+void
+RunLengthMask<VDimension>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf(os,indent);
+
+  os << indent << "Region: " << m_Region << std::endl;
+  os << indent << "OnValue: " << static_cast<int>(m_OnValue) << std::endl;
+  os << indent << "OffValue: " << static_cast<int>(m_OffValue) << std::endl;
+  os << indent << "NumberOfRows: " << this->GetNumberOfRows() << std::endl;
+  os << indent << "NumberOfRuns: " << this->GetNumberOfRuns() << std::endl;
+  os << indent << "Image: " << m_Image.GetPointer() << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef __itkThresholdHistogram_h
+#define __itkThresholdHistogram_h
+
+#include "itkNumericTraits.h"
+#include <vector>
+#include <map>
+#include <string>
+
+namespace itk
+{
+
+/** \class ThresholdHistogram
+ * \brief Intensity histogram shared by the histogram based threshold
+ * calculators.
+ *
+ * The histogram is a list of entries, each with a frequency and a
+ * position. Positions are expressed in units of the nominal bin width,
+ * (maximum - minimum) / NumberOfBins, measured from the minimum, so
+ * the threshold criteria can use them wherever they would otherwise
+ * use a bin index.
+ *
+ * In binned mode there is one entry per bin and the position of entry
+ * k is k. A sparse binned histogram only holds the occupied bins (and
+ * always the first one), each positioned at its bin index, which keeps
+ * very high bin counts cheap. In exact mode there is one entry per
+ * distinct pixel value, positioned at the true value, and thresholds
+ * are mapped back onto the distinct values rather than onto bin edges.
+ *
+ * Histograms can be saved to and loaded from a small binary file, and
+ * merged. Parts of a large volume can so be histogrammed separately,
+ * possibly by different processes, and thresholded once the partial
+ * histograms have been merged, without reading the voxels again.
+ *
+ * \author Richard Beare
+ * \ingroup Operators
+ */
+template <class TValue>
+class ThresholdHistogram
+{
+public:
+  typedef ThresholdHistogram Self;
+  typedef TValue             ValueType;
+
+  typedef std::vector<double>    FrequencyContainerType;
+  typedef std::vector<double>    PositionContainerType;
+  typedef std::vector<ValueType> ValueContainerType;
+
+  ThresholdHistogram();
+
+  /** Set up an empty binned histogram spanning [minimum, maximum]. */
+  void Initialize(ValueType minimum, ValueType maximum,
+                  unsigned long numberOfBins);
+
+  /** Set up an exact histogram from the sorted distinct values and
+   * their counts. numberOfBins only sets the unit of the positions. */
+  void InitializeExact(const ValueContainerType & values,
+                       const FrequencyContainerType & counts,
+                       unsigned long numberOfBins);
+
+  /** Set up a sparse binned histogram from the sorted indexes of the
+   * occupied bins and their counts. */
+  void InitializeSparse(ValueType minimum, ValueType maximum,
+                        unsigned long numberOfBins,
+                        const std::vector<unsigned long> & bins,
+                        const FrequencyContainerType & counts);
+
+  /** Fill dense with the binned histogram holding every bin. */
+  void Expand(Self & dense) const;
+
+  /** Add the counts of other to this histogram. Exact histograms stay
+   * exact. Otherwise the result is binned over the union of the two
+   * ranges, with the number of bins of this histogram, and the counts
+   * of each bin are spread over the new bins it overlaps. The result
+   * is sparse if either histogram is. */
+  void Merge(const Self & other);
+
+  /** Save the histogram to a file, in a little endian binary format
+   * holding the range, the nominal number of bins, the voxel count and
+   * the position, lower edge (or value) and count of each entry. */
+  void Write(const std::string & filename) const;
+
+  /** Load a histogram saved by Write(). Throws an ExceptionObject if
+   * the file can't be read or is not a histogram file. */
+  void Read(const std::string & filename);
+
+  /** Number of entries. */
+  unsigned long GetSize() const { return m_Frequency.size(); }
+
+  /** Nominal number of bins the positions are measured against. */
+  unsigned long GetNumberOfBins() const { return m_NumberOfBins; }
+
+  const FrequencyContainerType & GetFrequencies() const { return m_Frequency; }
+  FrequencyContainerType & GetFrequencies() { return m_Frequency; }
+
+  const PositionContainerType & GetPositions() const { return m_Position; }
+
+  double GetFrequency(unsigned long k) const { return m_Frequency[k]; }
+  double GetPosition(unsigned long k) const { return m_Position[k]; }
+
+  double GetTotalFrequency() const;
+
+  ValueType GetMinimum() const { return m_Minimum; }
+  ValueType GetMaximum() const { return m_Maximum; }
+  double GetBinMultiplier() const { return m_BinMultiplier; }
+  bool GetExact() const { return m_Exact; }
+  bool GetSparse() const { return m_Sparse; }
+
+  /** Threshold that keeps the entries before k at or below it. A
+   * negative k is treated as a position. */
+  ValueType EntryToThreshold(long k) const;
+
+  /** Threshold that keeps entry k and those before it at or below it. */
+  ValueType EntryToUpperThreshold(unsigned long k) const;
+
+  /** Threshold corresponding to a position, which need not be that of
+   * an entry. */
+  ValueType PositionToThreshold(double position) const;
+
+private:
+  /** Spread the counts of other over the bins of this histogram. */
+  void AccumulateBinned(const Self & other,
+                        std::map<unsigned long, double> & counts) const;
+
+  FrequencyContainerType m_Frequency;
+  PositionContainerType  m_Position;
+  ValueContainerType     m_Values;
+  ValueType              m_Minimum;
+  ValueType              m_Maximum;
+  double                 m_BinMultiplier;
+  unsigned long          m_NumberOfBins;
+  bool                   m_Exact;
+  bool                   m_Sparse;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkThresholdHistogram.txx"
+#endif
+
+#endif
@@ -0,0 +1,451 @@
+#ifndef __itkThresholdHistogram_txx
+#define __itkThresholdHistogram_txx
+
+#include "itkThresholdHistogram.h"
+#include "itkMacro.h"
+#include "itkByteSwapper.h"
+#include "vnl/vnl_math.h"
+
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+
+namespace itk
+{
+
+template<class TValue>
+ThresholdHistogram<TValue>
+::ThresholdHistogram()
+{
+  m_Minimum = NumericTraits<ValueType>::Zero;
+  m_Maximum = NumericTraits<ValueType>::Zero;
+  m_BinMultiplier = 1.0;
+  m_NumberOfBins = 0;
+  m_Exact = false;
+  m_Sparse = false;
+}
+
+template<class TValue>
+void
+ThresholdHistogram<TValue>
+::Initialize(ValueType minimum, ValueType maximum, unsigned long numberOfBins)
+{
+  m_Minimum = minimum;
+  m_Maximum = maximum;
+  m_NumberOfBins = numberOfBins;
+  m_BinMultiplier = 1.0;
+  if ( maximum > minimum )
+    {
+    m_BinMultiplier = (double) numberOfBins / (double) ( maximum - minimum );
+    }
+  m_Exact = false;
+  m_Sparse = false;
+
+  m_Values.clear();
+  m_Frequency.resize( numberOfBins );
+  std::fill(m_Frequency.begin(), m_Frequency.end(), 0.0);
+  m_Position.resize( numberOfBins );
+  for (unsigned long k = 0; k < numberOfBins; k++)
+    {
+    m_Position[k] = k;
+    }
+}
+
+template<class TValue>
+void
+ThresholdHistogram<TValue>
+::InitializeExact(const ValueContainerType & values,
+                  const FrequencyContainerType & counts,
+                  unsigned long numberOfBins)
+{
+  m_Minimum = values.front();
+  m_Maximum = values.back();
+  m_NumberOfBins = numberOfBins;
+  m_BinMultiplier = 1.0;
+  if ( m_Maximum > m_Minimum )
+    {
+    m_BinMultiplier = (double) numberOfBins / (double) ( m_Maximum - m_Minimum );
+    }
+  m_Exact = true;
+  m_Sparse = false;
+
+  m_Values = values;
+  m_Frequency = counts;
+  m_Position.resize( values.size() );
+  for (unsigned long k = 0; k < values.size(); k++)
+    {
+    m_Position[k] = ( (double) values[k] - (double) m_Minimum ) * m_BinMultiplier;
+    }
+}
+
+template<class TValue>
+void
+ThresholdHistogram<TValue>
+::InitializeSparse(ValueType minimum, ValueType maximum,
+                   unsigned long numberOfBins,
+                   const std::vector<unsigned long> & bins,
+                   const FrequencyContainerType & counts)
+{
+  this->Initialize( minimum, maximum, 0 );
+  m_NumberOfBins = numberOfBins;
+  if ( maximum > minimum )
+    {
+    m_BinMultiplier = (double) numberOfBins / (double) ( maximum - minimum );
+    }
+  m_Sparse = true;
+
+  m_Frequency = counts;
+  m_Position.resize( bins.size() );
+  for (unsigned long k = 0; k < bins.size(); k++)
+    {
+    m_Position[k] = bins[k];
+    }
+}
+
+template<class TValue>
+void
+ThresholdHistogram<TValue>
+::Expand(Self & dense) const
+{
+  dense.Initialize( m_Minimum, m_Maximum, m_NumberOfBins );
+  for (unsigned long k = 0; k < m_Frequency.size(); k++)
+    {
+    dense.m_Frequency[ (unsigned long) m_Position[k] ] = m_Frequency[k];
+    }
+}
+
+template<class TValue>
+void
+ThresholdHistogram<TValue>
+::Merge(const Self & other)
+{
+  if ( other.m_Frequency.empty() )
+    {
+    return;
+    }
+  if ( m_Frequency.empty() )
+    {
+    *this = other;
+    return;
+    }
+
+  if ( m_Exact && other.m_Exact )
+    {
+    typedef std::map<ValueType, double> ValueCountMapType;
+    ValueCountMapType counts;
+    for (unsigned long k = 0; k < m_Frequency.size(); k++)
+      {
+      counts[m_Values[k]] += m_Frequency[k];
+      }
+    for (unsigned long k = 0; k < other.m_Frequency.size(); k++)
+      {
+      counts[other.m_Values[k]] += other.m_Frequency[k];
+      }
+    ValueContainerType values;
+    FrequencyContainerType frequency;
+    for ( typename ValueCountMapType::const_iterator it = counts.begin();
+          it != counts.end(); ++it )
+      {
+      values.push_back( it->first );
+      frequency.push_back( it->second );
+      }
+    this->InitializeExact( values, frequency, m_NumberOfBins );
+    return;
+    }
+
+  // bin both histograms over the common range
+  Self merged;
+  merged.Initialize( std::min( m_Minimum, other.m_Minimum ),
+                     std::max( m_Maximum, other.m_Maximum ), m_NumberOfBins );
+
+  typedef std::map<unsigned long, double> BinCountMapType;
+  BinCountMapType counts;
+  merged.AccumulateBinned( *this, counts );
+  merged.AccumulateBinned( other, counts );
+
+  if ( m_Sparse || other.m_Sparse )
+    {
+    counts[0] += 0.0;
+    std::vector<unsigned long> bins;
+    FrequencyContainerType frequency;
+    for ( typename BinCountMapType::const_iterator it = counts.begin();
+          it != counts.end(); ++it )
+      {
+      bins.push_back( it->first );
+      frequency.push_back( it->second );
+      }
+    merged.InitializeSparse( merged.m_Minimum, merged.m_Maximum,
+                             m_NumberOfBins, bins, frequency );
+    }
+  else
+    {
+    for ( typename BinCountMapType::const_iterator it = counts.begin();
+          it != counts.end(); ++it )
+      {
+      merged.m_Frequency[it->first] = it->second;
+      }
+    }
+  *this = merged;
+}
+
+template<class TValue>
+void
+ThresholdHistogram<TValue>
+::AccumulateBinned(const Self & other,
+                   std::map<unsigned long, double> & counts) const
+{
+  const long lastBin = (long) m_NumberOfBins - 1;
+  for (unsigned long k = 0; k < other.m_Frequency.size(); k++)
+    {
+    const double count = other.m_Frequency[k];
+    if ( count == 0.0 )
+      {
+      continue;
+      }
+
+    if ( other.m_Exact )
+      {
+      // same rule as the calculators use to bin a pixel value
+      long bin = 0;
+      if ( other.m_Values[k] > m_Minimum )
+        {
+        bin = (long) vcl_ceil( ( (double) other.m_Values[k] - (double) m_Minimum )
+                               * m_BinMultiplier ) - 1;
+        }
+      counts[ std::max( 0L, std::min( bin, lastBin ) ) ] += count;
+      continue;
+      }
+
+    // the bin of other, in positions of this histogram. Its count is
+    // shared between the bins it overlaps.
+    const double width = m_BinMultiplier / other.m_BinMultiplier;
+    const double start =
+      ( (double) other.m_Minimum - (double) m_Minimum ) * m_BinMultiplier
+      + other.m_Position[k] * width;
+    const double end = start + width;
+    for (long j = (long) vcl_floor( start ); j < end; j++)
+      {
+      const double overlap = std::min( end, j + 1.0 ) - std::max( start, (double) j );
+      if ( overlap > 0 )
+        {
+        counts[ std::max( 0L, std::min( j, lastBin ) ) ] += count * overlap / width;
+        }
+      }
+    }
+}
+
+template<class TValue>
+void
+ThresholdHistogram<TValue>
+::Write(const std::string & filename) const
+{
+  std::ofstream file( filename.c_str(), std::ios::out | std::ios::binary );
+  if ( !file )
+    {
+    itkGenericExceptionMacro(<< "Can't open " << filename << " for writing");
+    }
+
+  unsigned int header[2];
+  header[0] = 1; // version
+  header[1] = ( m_Exact ? 1 : 0 ) | ( m_Sparse ? 2 : 0 );
+
+  double range[5];
+  range[0] = m_Minimum;
+  range[1] = m_Maximum;
+  range[2] = m_NumberOfBins;
+  range[3] = m_Frequency.size();
+  range[4] = this->GetTotalFrequency();
+
+  // position, lower edge or value, and count of each entry
+  std::vector<double> entries( 3 * m_Frequency.size() );
+  for (unsigned long k = 0; k < m_Frequency.size(); k++)
+    {
+    entries[3*k] = m_Position[k];
+    entries[3*k+1] = m_Exact ? (double) m_Values[k]
+      : (double) m_Minimum + m_Position[k] / m_BinMultiplier;
+    entries[3*k+2] = m_Frequency[k];
+    }
+
+  file.write( "ITKTHIST", 8 );
+  ByteSwapper<unsigned int>::SwapWriteRangeFromSystemToLittleEndian( header, 2, &file );
+  ByteSwapper<double>::SwapWriteRangeFromSystemToLittleEndian( range, 5, &file );
+  if ( !entries.empty() )
+    {
+    ByteSwapper<double>::SwapWriteRangeFromSystemToLittleEndian(
+      &entries[0], entries.size(), &file );
+    }
+  if ( !file )
+    {
+    itkGenericExceptionMacro(<< "Error writing " << filename);
+    }
+}
+
+template<class TValue>
+void
+ThresholdHistogram<TValue>
+::Read(const std::string & filename)
+{
+  std::ifstream file( filename.c_str(), std::ios::in | std::ios::binary );
+  if ( !file )
+    {
+    itkGenericExceptionMacro(<< "Can't open " << filename << " for reading");
+    }
+
+  char magic[8];
+  unsigned int header[2];
+  double range[5];
+  file.read( magic, 8 );
+  file.read( reinterpret_cast<char *>( header ), sizeof( header ) );
+  file.read( reinterpret_cast<char *>( range ), sizeof( range ) );
+  if ( !file || std::strncmp( magic, "ITKTHIST", 8 ) != 0 )
+    {
+    itkGenericExceptionMacro(<< filename << " is not a histogram file");
+    }
+  ByteSwapper<unsigned int>::SwapRangeFromSystemToLittleEndian( header, 2 );
+  ByteSwapper<double>::SwapRangeFromSystemToLittleEndian( range, 5 );
+  if ( header[0] != 1 )
+    {
+    itkGenericExceptionMacro(<< filename << " has unsupported version " << header[0]);
+    }
+
+  const bool exact = ( header[1] & 1 ) != 0;
+  const bool sparse = ( header[1] & 2 ) != 0;
+
+  // check the counts of the header before allocating anything: the
+  // entries must be in the file, and a binned histogram has at most
+  // one entry per bin
+  const std::streampos start = file.tellg();
+  file.seekg( 0, std::ios::end );
+  const double available =
+    (double) ( file.tellg() - start ) / ( 3 * sizeof( double ) );
+  file.seekg( start );
+  if ( !( range[2] >= 1 && range[2] <= NumericTraits<unsigned long>::max() &&
+          range[2] == vcl_floor( range[2] ) ) )
+    {
+    itkGenericExceptionMacro(<< filename << " has an invalid number of bins");
+    }
+  const unsigned long numberOfBins = (unsigned long) range[2];
+  if ( !( range[3] >= 0 && range[3] == vcl_floor( range[3] ) ) ||
+       range[3] > available || ( !exact && range[3] > range[2] ) )
+    {
+    itkGenericExceptionMacro(<< filename << " is truncated or has an invalid number of entries");
+    }
+  const unsigned long size = (unsigned long) range[3];
+
+  std::vector<double> entries( 3 * size );
+  if ( size > 0 )
+    {
+    file.read( reinterpret_cast<char *>( &entries[0] ), entries.size() * sizeof( double ) );
+    if ( !file )
+      {
+      itkGenericExceptionMacro(<< filename << " is truncated");
+      }
+    ByteSwapper<double>::SwapRangeFromSystemToLittleEndian( &entries[0], entries.size() );
+    }
+
+  FrequencyContainerType frequency( size );
+  for (unsigned long k = 0; k < size; k++)
+    {
+    frequency[k] = entries[3*k+2];
+    }
+
+  if ( exact && size > 0 )
+    {
+    ValueContainerType values( size );
+    for (unsigned long k = 0; k < size; k++)
+      {
+      values[k] = static_cast<ValueType>( entries[3*k+1] );
+      }
+    this->InitializeExact( values, frequency, numberOfBins );
+    }
+  else if ( sparse )
+    {
+    std::vector<unsigned long> bins( size );
+    for (unsigned long k = 0; k < size; k++)
+      {
+      const double bin = entries[3*k];
+      if ( !( bin >= 0 && bin < numberOfBins && bin == vcl_floor( bin ) ) ||
+           ( k > 0 && !( bin > entries[3*(k-1)] ) ) )
+        {
+        itkGenericExceptionMacro(<< filename << " has an invalid bin index " << bin);
+        }
+      bins[k] = (unsigned long) bin;
+      }
+    this->InitializeSparse( static_cast<ValueType>( range[0] ),
+                            static_cast<ValueType>( range[1] ),
+                            numberOfBins, bins, frequency );
+    }
+  else
+    {
+    if ( size != numberOfBins )
+      {
+      itkGenericExceptionMacro(<< filename << " has " << size
+                               << " entries for " << numberOfBins << " bins");
+      }
+    this->Initialize( static_cast<ValueType>( range[0] ),
+                      static_cast<ValueType>( range[1] ), numberOfBins );
+    m_Frequency = frequency;
+    }
+}
+
+template<class TValue>
+double
+ThresholdHistogram<TValue>
+::GetTotalFrequency() const
+{
+  double total = 0;
+  for (unsigned long k = 0; k < m_Frequency.size(); k++)
+    {
+    total += m_Frequency[k];
+    }
+  return total;
+}
+
+template<class TValue>
+typename ThresholdHistogram<TValue>::ValueType
+ThresholdHistogram<TValue>
+::EntryToThreshold(long k) const
+{
+  if ( k < 0 )
+    {
+    return this->PositionToThreshold( k );
+    }
+  if ( m_Exact )
+    {
+    // the largest value below entry k - the minimum is always included
+    return m_Values[ k > 0 ? k - 1 : 0 ];
+    }
+  return static_cast<ValueType>( m_Minimum + ( m_Position[k] ) / m_BinMultiplier );
+}
+
+template<class TValue>
+typename ThresholdHistogram<TValue>::ValueType
+ThresholdHistogram<TValue>
+::EntryToUpperThreshold(unsigned long k) const
+{
+  if ( m_Exact )
+    {
+    return m_Values[k];
+    }
+  return static_cast<ValueType>( m_Minimum + ( m_Position[k] + 1 ) / m_BinMultiplier );
+}
+
+template<class TValue>
+typename ThresholdHistogram<TValue>::ValueType
+ThresholdHistogram<TValue>
+::PositionToThreshold(double position) const
+{
+  if ( m_Exact )
+    {
+    // snap to the largest distinct value at or below the position
+    typename PositionContainerType::const_iterator it =
+      std::upper_bound(m_Position.begin(), m_Position.end(), position);
+    unsigned long k = std::distance(m_Position.begin(), it);
+    return m_Values[ k > 0 ? k - 1 : 0 ];
+    }
+  return static_cast<ValueType>( m_Minimum + ( position ) / m_BinMultiplier );
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,507 @@
+#ifndef __itkThresholdHistogramFill_h
+#define __itkThresholdHistogramFill_h
+
+#include "vnl/vnl_math.h"
+#include <algorithm>
+
+// Vector kernels binning rows of float pixels into a histogram, used
+// by HistogramThresholdImageCalculator. They reproduce the scalar bin
+// assignment exactly:
+//
+//   bin = value == imageMin ? 0 : ceil((value - imageMin) * binMultiplier) - 1
+//
+// with bin numberOfBins moved back to the last bin. The difference is
+// taken in single precision and the rest in double precision, as the
+// scalar code does. Values below imageMin go to the first bin and
+// values past the range to the last one, so that the range of the
+// histogram may be clipped to less than that of the image. The widest
+// instruction set the processor supports is picked at run time, so no
+// special compiler flags are needed.
+// Define ITK_THRESHOLD_HISTOGRAM_NO_SIMD to use the scalar code only.
+//
+// Consecutive pixels are counted in different copies of the histogram,
+// which are summed once the image is done. On images dominated by one
+// value, such as the air of a CT volume, the increments of one bin then
+// no longer wait on each other. Vectors holding a single value are
+// counted in one go, together with the vectors of the same value that
+// follow them.
+//
+// CountValue() counts the pixels of a row equal to a value, comparing
+// a whole vector at a time and adding up the bits of the comparison
+// masks. It finds the blocks made only of the background. PackRow()
+// binarizes a row into the 32 bit words of a BinaryBitMask, building
+// each word from the comparison masks.
+
+#if !defined(ITK_THRESHOLD_HISTOGRAM_NO_SIMD) && \
+    ( defined(__x86_64__) || defined(__i386__) ) && \
+    ( defined(__clang__) || \
+      ( defined(__GNUC__) && ( __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 ) ) ) )
+#define ITK_THRESHOLD_HISTOGRAM_SIMD
+#include <immintrin.h>
+#endif
+
+namespace itk
+{
+
+namespace ThresholdHistogramFill
+{
+
+/** Instruction sets of the kernels. */
+enum KernelType { Scalar = 0, SSE41, AVX2, AVX512 };
+
+/** Number of copies of the histogram the counts are spread over. */
+const unsigned int NumberOfCopies = 4;
+
+/** Bin of a float value, as computed by the scalar code. */
+inline unsigned long BinNumber(float value, float imageMin,
+                               double binMultiplier, unsigned long numberOfBins)
+{
+  if ( !( value > imageMin ) )
+    {
+    return 0;
+    }
+  const double binNumber = vcl_ceil( ( value - imageMin ) * binMultiplier ) - 1;
+  if ( binNumber >= numberOfBins )
+    {
+    return numberOfBins - 1;
+    }
+  return (unsigned long) binNumber;
+}
+
+/** The widest kernel GetKernel() may pick, AVX512 by default. Set it
+ * to Scalar to run the scalar code only, as if the kernels were
+ * compiled out, e.g. to compare the two. */
+inline KernelType & MaximumKernel()
+{
+  static KernelType maximum = AVX512;
+  return maximum;
+}
+
+/** The widest kernel the processor supports, up to MaximumKernel(). */
+inline KernelType GetKernel()
+{
+  KernelType kernel = Scalar;
+#ifdef ITK_THRESHOLD_HISTOGRAM_SIMD
+  __builtin_cpu_init();
+  if ( __builtin_cpu_supports("avx512f") )
+    {
+    kernel = AVX512;
+    }
+  else if ( __builtin_cpu_supports("avx2") )
+    {
+    kernel = AVX2;
+    }
+  else if ( __builtin_cpu_supports("sse4.1") )
+    {
+    kernel = SSE41;
+    }
+#endif
+  return std::min( kernel, MaximumKernel() );
+}
+
+#ifdef ITK_THRESHOLD_HISTOGRAM_SIMD
+
+__attribute__((target("sse4.1")))
+inline unsigned long FillSSE41(const float * row, unsigned long length,
+                               float imageMin, double binMultiplier,
+                               int numberOfBins, double ** copies)
+{
+  const __m128  vmin = _mm_set1_ps( imageMin );
+  const __m128d vmul = _mm_set1_pd( binMultiplier );
+  const __m128i vone = _mm_set1_epi32( 1 );
+  const __m128i vbins = _mm_set1_epi32( numberOfBins );
+  const __m128d vbinsd = _mm_set1_pd( numberOfBins );
+  int bins[4];
+
+  unsigned long i = 0;
+  while ( i + 4 <= length )
+    {
+    const __m128 v = _mm_loadu_ps( row + i );
+    const __m128 value = _mm_set1_ps( row[i] );
+    if ( _mm_movemask_ps( _mm_cmpeq_ps( v, value ) ) == 0xf )
+      {
+      // a run of one value, counted in one go
+      unsigned long end = i + 4;
+      while ( end + 4 <= length &&
+              _mm_movemask_ps( _mm_cmpeq_ps( _mm_loadu_ps( row + end ), value ) ) == 0xf )
+        {
+        end += 4;
+        }
+      copies[0][BinNumber( row[i], imageMin, binMultiplier, numberOfBins )] += end - i;
+      i = end;
+      continue;
+      }
+    // values below the range are moved to its minimum
+    const __m128 c = _mm_max_ps( v, vmin );
+    const __m128 d = _mm_sub_ps( c, vmin );
+    const __m128d lo = _mm_min_pd( _mm_round_pd( _mm_mul_pd( _mm_cvtps_pd( d ), vmul ),
+                                                 _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC ), vbinsd );
+    const __m128d hi = _mm_min_pd( _mm_round_pd( _mm_mul_pd( _mm_cvtps_pd( _mm_movehl_ps( d, d ) ), vmul ),
+                                                 _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC ), vbinsd );
+    __m128i b = _mm_unpacklo_epi64( _mm_cvttpd_epi32( lo ), _mm_cvttpd_epi32( hi ) );
+    b = _mm_sub_epi32( b, vone );
+    // the minimum goes to the first bin
+    b = _mm_andnot_si128( _mm_castps_si128( _mm_cmpeq_ps( c, vmin ) ), b );
+    // and a rounding overflow to the last one
+    b = _mm_add_epi32( b, _mm_cmpeq_epi32( b, vbins ) );
+    _mm_storeu_si128( (__m128i *) bins, b );
+    copies[0][bins[0]] += 1.0;
+    copies[1][bins[1]] += 1.0;
+    copies[2][bins[2]] += 1.0;
+    copies[3][bins[3]] += 1.0;
+    i += 4;
+    }
+  return i;
+}
+
+__attribute__((target("avx2")))
+inline unsigned long FillAVX2(const float * row, unsigned long length,
+                              float imageMin, double binMultiplier,
+                              int numberOfBins, double ** copies)
+{
+  const __m256  vmin = _mm256_set1_ps( imageMin );
+  const __m256d vmul = _mm256_set1_pd( binMultiplier );
+  const __m256i vone = _mm256_set1_epi32( 1 );
+  const __m256i vbins = _mm256_set1_epi32( numberOfBins );
+  const __m256d vbinsd = _mm256_set1_pd( numberOfBins );
+  int bins[8];
+
+  unsigned long i = 0;
+  while ( i + 8 <= length )
+    {
+    const __m256 v = _mm256_loadu_ps( row + i );
+    const __m256 value = _mm256_set1_ps( row[i] );
+    if ( _mm256_movemask_ps( _mm256_cmp_ps( v, value, _CMP_EQ_OQ ) ) == 0xff )
+      {
+      // a run of one value, counted in one go
+      unsigned long end = i + 8;
+      while ( end + 8 <= length &&
+              _mm256_movemask_ps( _mm256_cmp_ps( _mm256_loadu_ps( row + end ), value, _CMP_EQ_OQ ) ) == 0xff )
+        {
+        end += 8;
+        }
+      copies[0][BinNumber( row[i], imageMin, binMultiplier, numberOfBins )] += end - i;
+      i = end;
+      continue;
+      }
+    const __m256 c = _mm256_max_ps( v, vmin );
+    const __m256 d = _mm256_sub_ps( c, vmin );
+    const __m256d lo = _mm256_min_pd( _mm256_round_pd(
+      _mm256_mul_pd( _mm256_cvtps_pd( _mm256_castps256_ps128( d ) ), vmul ),
+      _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC ), vbinsd );
+    const __m256d hi = _mm256_min_pd( _mm256_round_pd(
+      _mm256_mul_pd( _mm256_cvtps_pd( _mm256_extractf128_ps( d, 1 ) ), vmul ),
+      _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC ), vbinsd );
+    __m256i b = _mm256_inserti128_si256(
+      _mm256_castsi128_si256( _mm256_cvttpd_epi32( lo ) ),
+      _mm256_cvttpd_epi32( hi ), 1 );
+    b = _mm256_sub_epi32( b, vone );
+    b = _mm256_andnot_si256(
+      _mm256_castps_si256( _mm256_cmp_ps( c, vmin, _CMP_EQ_OQ ) ), b );
+    b = _mm256_add_epi32( b, _mm256_cmpeq_epi32( b, vbins ) );
+    _mm256_storeu_si256( (__m256i *) bins, b );
+    copies[0][bins[0]] += 1.0;
+    copies[1][bins[1]] += 1.0;
+    copies[2][bins[2]] += 1.0;
+    copies[3][bins[3]] += 1.0;
+    copies[0][bins[4]] += 1.0;
+    copies[1][bins[5]] += 1.0;
+    copies[2][bins[6]] += 1.0;
+    copies[3][bins[7]] += 1.0;
+    i += 8;
+    }
+  return i;
+}
+
+__attribute__((target("avx512f")))
+inline unsigned long FillAVX512(const float * row, unsigned long length,
+                                float imageMin, double binMultiplier,
+                                int numberOfBins, double ** copies)
+{
+  const __m512  vmin = _mm512_set1_ps( imageMin );
+  const __m512d vmul = _mm512_set1_pd( binMultiplier );
+  const __m512i vone = _mm512_set1_epi32( 1 );
+  const __m512i vbins = _mm512_set1_epi32( numberOfBins );
+  const __m512d vbinsd = _mm512_set1_pd( numberOfBins );
+  int bins[16];
+
+  unsigned long i = 0;
+  while ( i + 16 <= length )
+    {
+    const __m512 v = _mm512_loadu_ps( row + i );
+    const __m512 value = _mm512_set1_ps( row[i] );
+    if ( _mm512_cmp_ps_mask( v, value, _CMP_EQ_OQ ) == 0xffff )
+      {
+      // a run of one value, counted in one go
+      unsigned long end = i + 16;
+      while ( end + 16 <= length &&
+              _mm512_cmp_ps_mask( _mm512_loadu_ps( row + end ), value, _CMP_EQ_OQ ) == 0xffff )
+        {
+        end += 16;
+        }
+      copies[0][BinNumber( row[i], imageMin, binMultiplier, numberOfBins )] += end - i;
+      i = end;
+      continue;
+      }
+    const __m512 c = _mm512_max_ps( v, vmin );
+    const __m512 d = _mm512_sub_ps( c, vmin );
+    const __m256 dlo = _mm512_castps512_ps256( d );
+    const __m256 dhi = _mm256_castpd_ps( _mm512_extractf64x4_pd( _mm512_castps_pd( d ), 1 ) );
+    const __m512d lo = _mm512_min_pd( _mm512_roundscale_pd( _mm512_mul_pd( _mm512_cvtps_pd( dlo ), vmul ),
+                                                            _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC ), vbinsd );
+    const __m512d hi = _mm512_min_pd( _mm512_roundscale_pd( _mm512_mul_pd( _mm512_cvtps_pd( dhi ), vmul ),
+                                                            _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC ), vbinsd );
+    __m512i b = _mm512_inserti64x4(
+      _mm512_castsi256_si512( _mm512_cvttpd_epi32( lo ) ),
+      _mm512_cvttpd_epi32( hi ), 1 );
+    b = _mm512_sub_epi32( b, vone );
+    b = _mm512_maskz_mov_epi32( (__mmask16) ~_mm512_cmp_ps_mask( c, vmin, _CMP_EQ_OQ ), b );
+    b = _mm512_mask_sub_epi32( b, _mm512_cmpeq_epi32_mask( b, vbins ), b, vone );
+    _mm512_storeu_si512( (void *) bins, b );
+    copies[0][bins[0]] += 1.0;
+    copies[1][bins[1]] += 1.0;
+    copies[2][bins[2]] += 1.0;
+    copies[3][bins[3]] += 1.0;
+    copies[0][bins[4]] += 1.0;
+    copies[1][bins[5]] += 1.0;
+    copies[2][bins[6]] += 1.0;
+    copies[3][bins[7]] += 1.0;
+    copies[0][bins[8]] += 1.0;
+    copies[1][bins[9]] += 1.0;
+    copies[2][bins[10]] += 1.0;
+    copies[3][bins[11]] += 1.0;
+    copies[0][bins[12]] += 1.0;
+    copies[1][bins[13]] += 1.0;
+    copies[2][bins[14]] += 1.0;
+    copies[3][bins[15]] += 1.0;
+    i += 16;
+    }
+  return i;
+}
+
+__attribute__((target("sse4.1,popcnt")))
+inline unsigned long CountSSE41(const float * row, unsigned long length,
+                                float value, unsigned long & count)
+{
+  const __m128 v = _mm_set1_ps( value );
+  unsigned long i = 0;
+  for ( ; i + 4 <= length; i += 4 )
+    {
+    count += __builtin_popcount( _mm_movemask_ps( _mm_cmpeq_ps( _mm_loadu_ps( row + i ), v ) ) );
+    }
+  return i;
+}
+
+__attribute__((target("avx2,popcnt")))
+inline unsigned long CountAVX2(const float * row, unsigned long length,
+                               float value, unsigned long & count)
+{
+  const __m256 v = _mm256_set1_ps( value );
+  unsigned long i = 0;
+  for ( ; i + 8 <= length; i += 8 )
+    {
+    count += __builtin_popcount( _mm256_movemask_ps(
+      _mm256_cmp_ps( _mm256_loadu_ps( row + i ), v, _CMP_EQ_OQ ) ) );
+    }
+  return i;
+}
+
+__attribute__((target("avx512f,popcnt")))
+inline unsigned long CountAVX512(const float * row, unsigned long length,
+                                 float value, unsigned long & count)
+{
+  const __m512 v = _mm512_set1_ps( value );
+  unsigned long i = 0;
+  for ( ; i + 16 <= length; i += 16 )
+    {
+    count += __builtin_popcount( _mm512_cmp_ps_mask( _mm512_loadu_ps( row + i ), v, _CMP_EQ_OQ ) );
+    }
+  return i;
+}
+
+__attribute__((target("sse4.1")))
+inline unsigned long PackSSE41(const float * row, unsigned long length,
+                               float lower, float upper, unsigned int * words)
+{
+  const __m128 vlower = _mm_set1_ps( lower );
+  const __m128 vupper = _mm_set1_ps( upper );
+  unsigned long i = 0;
+  for ( ; i + 32 <= length; i += 32 )
+    {
+    unsigned int word = 0;
+    for ( unsigned int k = 0; k < 32; k += 4 )
+      {
+      const __m128 v = _mm_loadu_ps( row + i + k );
+      word |= (unsigned int) _mm_movemask_ps(
+        _mm_and_ps( _mm_cmpge_ps( v, vlower ), _mm_cmple_ps( v, vupper ) ) ) << k;
+      }
+    words[i / 32] = word;
+    }
+  return i;
+}
+
+__attribute__((target("avx2")))
+inline unsigned long PackAVX2(const float * row, unsigned long length,
+                              float lower, float upper, unsigned int * words)
+{
+  const __m256 vlower = _mm256_set1_ps( lower );
+  const __m256 vupper = _mm256_set1_ps( upper );
+  unsigned long i = 0;
+  for ( ; i + 32 <= length; i += 32 )
+    {
+    unsigned int word = 0;
+    for ( unsigned int k = 0; k < 32; k += 8 )
+      {
+      const __m256 v = _mm256_loadu_ps( row + i + k );
+      word |= (unsigned int) _mm256_movemask_ps(
+        _mm256_and_ps( _mm256_cmp_ps( v, vlower, _CMP_GE_OQ ),
+                       _mm256_cmp_ps( v, vupper, _CMP_LE_OQ ) ) ) << k;
+      }
+    words[i / 32] = word;
+    }
+  return i;
+}
+
+__attribute__((target("avx512f")))
+inline unsigned long PackAVX512(const float * row, unsigned long length,
+                                float lower, float upper, unsigned int * words)
+{
+  const __m512 vlower = _mm512_set1_ps( lower );
+  const __m512 vupper = _mm512_set1_ps( upper );
+  unsigned long i = 0;
+  for ( ; i + 32 <= length; i += 32 )
+    {
+    const __m512 v0 = _mm512_loadu_ps( row + i );
+    const __m512 v1 = _mm512_loadu_ps( row + i + 16 );
+    const unsigned int m0 = _mm512_mask_cmp_ps_mask(
+      _mm512_cmp_ps_mask( v0, vlower, _CMP_GE_OQ ), v0, vupper, _CMP_LE_OQ );
+    const unsigned int m1 = _mm512_mask_cmp_ps_mask(
+      _mm512_cmp_ps_mask( v1, vlower, _CMP_GE_OQ ), v1, vupper, _CMP_LE_OQ );
+    words[i / 32] = m0 | ( m1 << 16 );
+    }
+  return i;
+}
+
+#endif
+
+/** Bin the leading values of a row of pixels with a vector kernel,
+ * into the NumberOfCopies histograms of copies, and return how many
+ * were binned. The remainder of the row, and rows of other pixel
+ * types, are left to the scalar code. */
+template <class TPixel>
+inline unsigned long FillRow(KernelType, const TPixel *, unsigned long,
+                             TPixel, double, unsigned long, double **)
+{
+  return 0;
+}
+
+inline unsigned long FillRow(KernelType kernel, const float * row,
+                             unsigned long length, float imageMin,
+                             double binMultiplier, unsigned long numberOfBins,
+                             double ** copies)
+{
+#ifdef ITK_THRESHOLD_HISTOGRAM_SIMD
+  // bins are computed as 32 bit integers
+  if ( numberOfBins < 0x7fffffffUL )
+    {
+    switch ( kernel )
+      {
+      case AVX512:
+        return FillAVX512( row, length, imageMin, binMultiplier,
+                           (int) numberOfBins, copies );
+      case AVX2:
+        return FillAVX2( row, length, imageMin, binMultiplier,
+                         (int) numberOfBins, copies );
+      case SSE41:
+        return FillSSE41( row, length, imageMin, binMultiplier,
+                          (int) numberOfBins, copies );
+      default:
+        break;
+      }
+    }
+#endif
+  return 0;
+}
+
+/** Number of pixels of a row equal to value. */
+template <class TPixel>
+inline unsigned long CountValue(KernelType, const TPixel * row,
+                                unsigned long length, TPixel value)
+{
+  return std::count( row, row + length, value );
+}
+
+inline unsigned long CountValue(KernelType kernel, const float * row,
+                                unsigned long length, float value)
+{
+  unsigned long count = 0;
+  unsigned long i = 0;
+#ifdef ITK_THRESHOLD_HISTOGRAM_SIMD
+  switch ( kernel )
+    {
+    case AVX512:
+      i = CountAVX512( row, length, value, count );
+      break;
+    case AVX2:
+      i = CountAVX2( row, length, value, count );
+      break;
+    case SSE41:
+      i = CountSSE41( row, length, value, count );
+      break;
+    default:
+      break;
+    }
+#endif
+  return count + std::count( row + i, row + length, value );
+}
+
+/** Write into words the bits of a row, set where lower <= row[x] <=
+ * upper. Every word of the row is written, the bits past its end are
+ * cleared. */
+template <class TPixel>
+inline void PackRow(KernelType, const TPixel * row, unsigned long length,
+                    TPixel lower, TPixel upper, unsigned int * words,
+                    unsigned long start = 0)
+{
+  for ( unsigned long i = start; i < length; i += 32 )
+    {
+    unsigned int word = 0;
+    for ( unsigned int k = 0; k < 32 && i + k < length; k++ )
+      {
+      if ( lower <= row[i + k] && row[i + k] <= upper )
+        {
+        word |= 1u << k;
+        }
+      }
+    words[i / 32] = word;
+    }
+}
+
+inline void PackRow(KernelType kernel, const float * row, unsigned long length,
+                    float lower, float upper, unsigned int * words)
+{
+  unsigned long i = 0;
+#ifdef ITK_THRESHOLD_HISTOGRAM_SIMD
+  switch ( kernel )
+    {
+    case AVX512:
+      i = PackAVX512( row, length, lower, upper, words );
+      break;
+    case AVX2:
+      i = PackAVX2( row, length, lower, upper, words );
+      break;
+    case SSE41:
+      i = PackSSE41( row, length, lower, upper, words );
+      break;
+    default:
+      break;
+    }
+#endif
+  PackRow<float>( kernel, row, length, lower, upper, words, i );
+}
+
+} // end namespace ThresholdHistogramFill
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef __itkThresholdScratchArray_h
+#define __itkThresholdScratchArray_h
+
+#include <vector>
+#include <algorithm>
+
+namespace itk
+{
+
+/** \class ThresholdScratchArray
+ * \brief Working array of the threshold criteria, kept on the stack
+ * for small histograms.
+ *
+ * The criteria need a few arrays as long as the histogram (cumulative
+ * sums, normalised frequencies, lookup tables) on every call. Arrays
+ * of up to VStackSize elements live in the object itself, so the
+ * common 8 bit case of 256 bins is solved without touching the heap,
+ * which matters when many small regions are thresholded. Longer
+ * arrays fall back to a std::vector. The interface is the part of
+ * std::vector the criteria use.
+ *
+ * \author Richard Beare
+ * \ingroup Operators
+ */
+template <class T, unsigned int VStackSize>
+class ThresholdScratchArray
+{
+public:
+  typedef T              value_type;
+  typedef T *            iterator;
+  typedef const T *      const_iterator;
+
+  /** Array of size elements set to value. */
+  explicit ThresholdScratchArray(unsigned long size = 0, const T & value = T())
+  {
+    this->resize( size, value );
+  }
+
+  /** Change the number of elements. All of them are set to value. */
+  void resize(unsigned long size, const T & value = T())
+  {
+    m_Size = size;
+    if ( size <= VStackSize )
+      {
+      m_Data = m_Stack;
+      }
+    else
+      {
+      m_Heap.resize( size );
+      m_Data = &m_Heap[0];
+      }
+    std::fill( m_Data, m_Data + size, value );
+  }
+
+  unsigned long size() const { return m_Size; }
+
+  T & operator[](unsigned long i) { return m_Data[i]; }
+  const T & operator[](unsigned long i) const { return m_Data[i]; }
+
+  iterator begin() { return m_Data; }
+  iterator end() { return m_Data + m_Size; }
+  const_iterator begin() const { return m_Data; }
+  const_iterator end() const { return m_Data + m_Size; }
+
+private:
+  ThresholdScratchArray(const ThresholdScratchArray &); //purposely not implemented
+  void operator=(const ThresholdScratchArray &); //purposely not implemented
+
+  T                 m_Stack[VStackSize];
+  std::vector<T>    m_Heap;
+  T *               m_Data;
+  unsigned long     m_Size;
+};
+
+} // end namespace itk
+
+#endif
@@ -2,14 +2,12 @@
 #define __itkTriangleThresholdImageCalculator_txx
 
 #include "itkTriangleThresholdImageCalculator.h"
-#include "itkImageRegionConstIteratorWithIndex.h"
-#include "itkMinimumMaximumImageCalculator.h"
 
 #include "vnl/vnl_math.h"
 
 namespace itk
-{ 
-    
+{
+
 /**
  * Constructor
  */
@@ -17,12 +15,8 @@ template<class TInputImage>
 TriangleThresholdImageCalculator<TInputImage>
 ::TriangleThresholdImageCalculator()
 {
-  m_Image = NULL;
-  m_Threshold = NumericTraits<PixelType>::Zero;
-  m_NumberOfHistogramBins = 128;
-  m_RegionSetByUser = false;
-  m_LowThresh=0.01;
-  m_HighThresh=0.99;
+  m_LowThresh = 0.01;
+  m_HighThresh = 0.99;
 }
 
 
@@ -30,91 +24,40 @@ TriangleThresholdImageCalculator<TInputImage>
  * Compute the Triangle's threshold
  */
 template<class TInputImage>
-void
+bool
 TriangleThresholdImageCalculator<TInputImage>
-::Compute(void)
+::ComputeThresholdFromHistogram(const HistogramType & histogram,
+                                PixelType & threshold) const
 {
-
-  unsigned int j;
-
-  if ( !m_Image ) { return; }
-  if( !m_RegionSetByUser )
+  if ( histogram.GetSparse() )
     {
-    m_Region = m_Image->GetRequestedRegion();
+    // the triangle is measured over every bin, empty or not
+    HistogramType dense;
+    histogram.Expand( dense );
+    return this->ComputeThresholdFromHistogram( dense, threshold );
     }
 
-  double totalPixels = (double) m_Region.GetNumberOfPixels();
-  if ( totalPixels == 0 ) { return; }
-
-
-  // compute image max and min
-  typedef MinimumMaximumImageCalculator<TInputImage> RangeCalculator;
-  typename RangeCalculator::Pointer rangeCalculator = RangeCalculator::New();
-  rangeCalculator->SetImage( m_Image );
-  rangeCalculator->Compute();
 
-  PixelType imageMin = rangeCalculator->GetMinimum();
-  PixelType imageMax = rangeCalculator->GetMaximum();
+  unsigned int j;
 
-  if ( imageMin >= imageMax )
-    {
-    m_Threshold = imageMin;
-    return;
-    }
+  const std::vector<double> & relativeFrequency = histogram.GetFrequencies();
+  const std::vector<double> & position = histogram.GetPositions();
+  const unsigned int size = relativeFrequency.size();
 
-  // create a histogram
-  std::vector<double> relativeFrequency;
-  std::vector<double> cumSum;
-  std::vector<double> triangle;
-  relativeFrequency.resize( m_NumberOfHistogramBins );
-  cumSum.resize( m_NumberOfHistogramBins );
-  triangle.resize( m_NumberOfHistogramBins );
+  ScratchArrayType cumSum;
+  ScratchArrayType triangle;
+  cumSum.resize( size );
+  triangle.resize( size );
 
-  std::fill(relativeFrequency.begin(), relativeFrequency.end(), 0.0);
   std::fill(cumSum.begin(), cumSum.end(), 0.0);
   std::fill(triangle.begin(), triangle.end(), 0.0);
 
-  // for ( j = 0; j < m_NumberOfHistogramBins; j++ )
-  //   {
-  //   relativeFrequency[j] = 0.0;
-  //   cumSum[j]=0.0;
-  //   }
-
-  double binMultiplier = (double) m_NumberOfHistogramBins /
-    (double) ( imageMax - imageMin );
-
-  typedef ImageRegionConstIteratorWithIndex<TInputImage> Iterator;
-  Iterator iter( m_Image, m_Region );
-
-  while ( !iter.IsAtEnd() )
-    {
-    unsigned int binNumber;
-    PixelType value = iter.Get();
-
-    if ( value == imageMin ) 
-      {
-      binNumber = 0;
-      }
-    else
-      {
-      binNumber = (unsigned int) vcl_ceil((value - imageMin) * binMultiplier ) - 1;
-      if ( binNumber == m_NumberOfHistogramBins ) // in case of rounding errors
-        {
-        binNumber -= 1;
-        }
-      }
-
-    relativeFrequency[binNumber] += 1.0;
-    ++iter;
-
-    }
-
   if (this->GetDebug())
     {
-    for (unsigned i = 0;i < m_NumberOfHistogramBins; i++)
+    for (unsigned i = 0;i < size; i++)
       {
       double count = relativeFrequency[i];
-      double bin = ( imageMin + ( i + 1 ) / binMultiplier );
+      double bin = ( histogram.GetMinimum() + ( position[i] + 1 ) / histogram.GetBinMultiplier() );
       std::cout << bin << "," << count << std::endl;
       }
     }
@@ -124,7 +67,7 @@ TriangleThresholdImageCalculator<TInputImage>
   double Mx = itk::NumericTraits<double>::min();
   unsigned long MxIdx=0;
 
-  for ( j = 0; j < m_NumberOfHistogramBins; j++ )
+  for ( j = 0; j < size; j++ )
     {
     //std::cout << relativeFrequency[j] << std::endl;
     if (relativeFrequency[j] > Mx)
@@ -136,17 +79,17 @@ TriangleThresholdImageCalculator<TInputImage>
 
 
   cumSum[0]=relativeFrequency[0];
-  for ( j = 1; j < m_NumberOfHistogramBins; j++ )
+  for ( j = 1; j < size; j++ )
     {
     cumSum[j] = relativeFrequency[j] + cumSum[j-1];
     }
 
 
-  double total = cumSum[m_NumberOfHistogramBins - 1];
+  double total = cumSum[size - 1];
   // find 1% and 99% levels
   double onePC = total * m_LowThresh;
   unsigned onePCIdx=0;
-  for (j=0; j < m_NumberOfHistogramBins; j++ )
+  for (j=0; j < size; j++ )
     {
     if (cumSum[j] > onePC)
       {
@@ -156,8 +99,8 @@ TriangleThresholdImageCalculator<TInputImage>
     }
 
   double nnPC = total * m_HighThresh;
-  unsigned nnPCIdx=m_NumberOfHistogramBins;
-  for (j=0; j < m_NumberOfHistogramBins; j++ )
+  unsigned nnPCIdx=size;
+  for (j=0; j < size; j++ )
     {
     if (cumSum[j] > nnPC)
       {
@@ -166,58 +109,45 @@ TriangleThresholdImageCalculator<TInputImage>
       }
     }
 
+  // positions of the peak and the 1% and 99% levels
+  double MxPos = position[MxIdx];
+  double onePCPos = position[onePCIdx];
+  double nnPCPos = (nnPCIdx < size) ? position[nnPCIdx] : histogram.GetNumberOfBins();
 
-  
   // figure out which way we are looking - we want to construct our
   // line between the max index and the further of 1% and 99%
   unsigned ThreshIdx=0;
-  if (fabs((float)MxIdx - (float)onePCIdx) > fabs((float)MxIdx - (float)nnPCIdx))
+  if (fabs((float)MxPos - (float)onePCPos) > fabs((float)MxPos - (float)nnPCPos))
     {
     // line to 1 %
-    double slope = Mx/(MxIdx - onePCIdx);
+    double slope = Mx/(MxPos - onePCPos);
     for (unsigned k=onePCIdx; k<MxIdx; k++)
       {
-      float line = (slope*(k-onePCIdx));
+      float line = (slope*(position[k]-onePCPos));
       triangle[k]= line - relativeFrequency[k];
       // std::cout << relativeFrequency[k] << "," << line << "," << triangle[k] << std::endl;
       }
 
-    ThreshIdx = onePCIdx + std::distance(&(triangle[onePCIdx]), std::max_element(&(triangle[onePCIdx]), &(triangle[MxIdx]))) ;
+    ThreshIdx = onePCIdx + std::distance(triangle.begin() + onePCIdx, std::max_element(triangle.begin() + onePCIdx, triangle.begin() + MxIdx)) ;
     }
   else
     {
     // line to 99 %
-    double slope = -Mx/(nnPCIdx - MxIdx);
+    double slope = -Mx/(nnPCPos - MxPos);
     for (unsigned k=MxIdx; k < nnPCIdx; k++)
       {
-      float line = (slope*(k-MxIdx) + Mx);
+      float line = (slope*(position[k]-MxPos) + Mx);
       triangle[k]= line - relativeFrequency[k];
 //      std::cout << relativeFrequency[k] << "," << line << "," << triangle[k] << std::endl;
       }
-    ThreshIdx = MxIdx + std::distance(&(triangle[MxIdx]), std::max_element(&(triangle[MxIdx]), &(triangle[nnPCIdx]))) ;
+    ThreshIdx = MxIdx + std::distance(triangle.begin() + MxIdx, std::max_element(triangle.begin() + MxIdx, triangle.begin() + nnPCIdx)) ;
     }
 
-  m_Threshold = static_cast<PixelType>( imageMin + 
-                                        ( ThreshIdx + 1 ) / binMultiplier );
+  threshold = histogram.EntryToUpperThreshold( ThreshIdx );
+  return true;
 
-
-  // for (unsigned k = 0; k < m_NumberOfHistogramBins ; k++)
-  //   {
-  //   std::cout << relativeFrequency[k] << std::endl;
-  //   }
-
-}
-
-template<class TInputImage>
-void
-TriangleThresholdImageCalculator<TInputImage>
-::SetRegion( const RegionType & region )
-{
-  m_Region = region;
-  m_RegionSetByUser = true;
 }
 
-  
 template<class TInputImage>
 void
 TriangleThresholdImageCalculator<TInputImage>
@@ -225,9 +155,8 @@ TriangleThresholdImageCalculator<TInputImage>
 {
   Superclass::PrintSelf(os,indent);
 
-  os << indent << "Threshold: " << m_Threshold << std::endl;
-  os << indent << "NumberOfHistogramBins: " << m_NumberOfHistogramBins << std::endl;
-  os << indent << "Image: " << m_Image.GetPointer() << std::endl;
+  os << indent << "LowThresh: " << m_LowThresh << std::endl;
+  os << indent << "HighThresh: " << m_HighThresh << std::endl;
 }
 
 } // end namespace itk
@@ -0,0 +1,554 @@
+#ifndef __mappedio_h_
+#define __mappedio_h_
+
+// Reading of uncompressed MetaImage (.mha, or .mhd with its raw file)
+// and raw NRRD (.nrrd, .nhdr) files by mapping them in memory. The
+// thresholds are then computed on the pixels where they lie in the
+// file: the operating system reads them ahead of the passes over the
+// image, and they stay in the page cache instead of being copied into
+// a buffer of the process.
+//
+// readImMapped() maps the file when its pixels can be used as they
+// are: the pixel type of the file is that of the image, in the byte
+// order of the machine, with a single component, and the pixels start
+// at a multiple of the pixel size into the file. An .mha file whose
+// header length doesn't suit the pixel size, as any other file, is
+// read with readIm() instead.
+
+#include "ioutils.h"
+#include "itkMappedImageContainer.h"
+#include <itkByteSwapper.h>
+#include <itksys/SystemTools.hxx>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cmath>
+
+// Where the pixels of a file are and what they are.
+struct MappedFileInfo
+{
+  std::string                DataFile;
+  long                       Offset;     // -1 when the pixels end the file
+  std::vector<unsigned long> Size;
+  std::vector<double>        Spacing;
+  std::vector<double>        Origin;
+  std::vector<double>        Direction;  // the axis vectors in turn
+  unsigned                   ComponentSize;
+  bool                       Integer;
+  bool                       Signed;
+  bool                       BigEndian;
+};
+
+inline std::string trimHeaderString(const std::string & s)
+{
+  const char * blanks = " \t\r\n";
+  std::string::size_type first = s.find_first_not_of(blanks);
+  if (first == std::string::npos)
+    {
+    return std::string();
+    }
+  return s.substr(first, s.find_last_not_of(blanks) - first + 1);
+}
+
+// The data file named in a header, relative to the header.
+inline std::string headerDataFile(const std::string & header, const std::string & file)
+{
+  if (itksys::SystemTools::FileIsFullPath(file.c_str()))
+    {
+    return file;
+    }
+  std::string path = itksys::SystemTools::GetFilenamePath(header);
+  return path.empty() ? file : path + "/" + file;
+}
+
+inline void setComponent(MappedFileInfo & info, unsigned size, bool integer, bool isSigned)
+{
+  info.ComponentSize = size;
+  info.Integer = integer;
+  info.Signed = isSigned;
+}
+
+// Fill in what the header leaves out, and check that the rest agrees.
+inline bool completeFileInfo(MappedFileInfo & info, unsigned dim)
+{
+  if (dim == 0 || info.Size.size() != dim || info.ComponentSize == 0 ||
+      info.DataFile.empty())
+    {
+    return false;
+    }
+  if (info.Spacing.size() != dim)
+    {
+    info.Spacing.assign(dim, 1.0);
+    }
+  if (info.Origin.size() != dim)
+    {
+    info.Origin.assign(dim, 0.0);
+    }
+  if (info.Direction.size() != dim * dim)
+    {
+    info.Direction.assign(dim * dim, 0.0);
+    for (unsigned i = 0; i < dim; i++)
+      {
+      info.Direction[i * dim + i] = 1.0;
+      }
+    }
+  return true;
+}
+
+inline bool readMetaImageHeader(const std::string & filename, MappedFileInfo & info)
+{
+  static const char * types[] = { "MET_UCHAR", "MET_CHAR", "MET_USHORT", "MET_SHORT",
+                                  "MET_UINT", "MET_INT", "MET_ULONG_LONG", "MET_LONG_LONG",
+                                  "MET_FLOAT", "MET_DOUBLE" };
+  static const unsigned sizes[] = { 1, 1, 2, 2, 4, 4, 8, 8, 4, 8 };
+
+  std::ifstream in(filename.c_str(), std::ios::binary);
+  if (!in)
+    {
+    return false;
+    }
+
+  setComponent(info, 0, false, false);
+  info.BigEndian = false;
+  unsigned dim = 0;
+  long headerSize = 0;
+  std::vector<double> elementSize;
+  std::string line;
+  while (std::getline(in, line))
+    {
+    std::string::size_type equal = line.find('=');
+    if (equal == std::string::npos)
+      {
+      return false;
+      }
+    const std::string key = trimHeaderString(line.substr(0, equal));
+    const std::string value = trimHeaderString(line.substr(equal + 1));
+    std::istringstream values(value);
+    double number;
+    unsigned long length;
+
+    if (key == "NDims")
+      {
+      values >> dim;
+      }
+    else if (key == "DimSize")
+      {
+      while (values >> length)
+        {
+        info.Size.push_back(length);
+        }
+      }
+    else if (key == "ElementType")
+      {
+      for (unsigned t = 0; t < sizeof(sizes) / sizeof(sizes[0]); t++)
+        {
+        if (value == types[t])
+          {
+          setComponent(info, sizes[t], t < 8, t % 2 == 1 || t >= 8);
+          }
+        }
+      }
+    else if (key == "ElementSpacing")
+      {
+      while (values >> number)
+        {
+        info.Spacing.push_back(number);
+        }
+      }
+    else if (key == "ElementSize")
+      {
+      while (values >> number)
+        {
+        elementSize.push_back(number);
+        }
+      }
+    else if (key == "Offset" || key == "Position" || key == "Origin")
+      {
+      while (values >> number)
+        {
+        info.Origin.push_back(number);
+        }
+      }
+    else if (key == "TransformMatrix" || key == "Rotation" || key == "Orientation")
+      {
+      while (values >> number)
+        {
+        info.Direction.push_back(number);
+        }
+      }
+    else if (key == "BinaryDataByteOrderMSB" || key == "ElementByteOrderMSB")
+      {
+      info.BigEndian = ( value == "True" || value == "true" || value == "1" );
+      }
+    else if (key == "CompressedData")
+      {
+      if (value == "True" || value == "true" || value == "1")
+        {
+        return false;
+        }
+      }
+    else if (key == "ElementNumberOfChannels")
+      {
+      if (value != "1")
+        {
+        return false;
+        }
+      }
+    else if (key == "HeaderSize")
+      {
+      values >> headerSize;
+      }
+    else if (key == "ElementDataFile")
+      {
+      // the last field of the header
+      if (value == "LOCAL")
+        {
+        info.DataFile = filename;
+        info.Offset = (long)in.tellg();
+        }
+      else if (value.find_first_of(" %") != std::string::npos)
+        {
+        // a list of files or a pattern
+        return false;
+        }
+      else
+        {
+        info.DataFile = headerDataFile(filename, value);
+        info.Offset = headerSize;
+        }
+      break;
+      }
+    }
+
+  if (info.Spacing.empty())
+    {
+    info.Spacing = elementSize;
+    }
+  return completeFileInfo(info, dim);
+}
+
+// Numbers of a NRRD vector, such as (1.2,0,0).
+inline bool readNrrdVector(std::istream & in, std::vector<double> & vec)
+{
+  std::string text;
+  if (!(in >> text) || text.size() < 2 || text[0] != '(' ||
+      text[text.size() - 1] != ')')
+    {
+    return false;
+    }
+  for (std::string::size_type i = 0; i < text.size(); i++)
+    {
+    if (text[i] == '(' || text[i] == ')' || text[i] == ',')
+      {
+      text[i] = ' ';
+      }
+    }
+  std::istringstream values(text);
+  double number;
+  while (values >> number)
+    {
+    vec.push_back(number);
+    }
+  return true;
+}
+
+inline bool readNrrdHeader(const std::string & filename, MappedFileInfo & info)
+{
+  std::ifstream in(filename.c_str(), std::ios::binary);
+  std::string line;
+  if (!in || !std::getline(in, line) || line.compare(0, 7, "NRRD000") != 0)
+    {
+    return false;
+    }
+
+  setComponent(info, 0, false, false);
+  info.BigEndian = false;
+  unsigned dim = 0;
+  long byteSkip = 0;
+  bool haveDirections = false;
+  bool rasSpace = false;
+  bool lasSpace = false;
+  while (std::getline(in, line))
+    {
+    line = trimHeaderString(line);
+    if (line.empty())
+      {
+      // the end of the header, the pixels follow if they are attached
+      break;
+      }
+    if (line[0] == '#' || line.find(":=") != std::string::npos)
+      {
+      continue;
+      }
+    std::string::size_type colon = line.find(": ");
+    if (colon == std::string::npos)
+      {
+      return false;
+      }
+    const std::string field = line.substr(0, colon);
+    const std::string desc = trimHeaderString(line.substr(colon + 2));
+    std::istringstream values(desc);
+    double number;
+    unsigned long length;
+
+    if (field == "dimension")
+      {
+      values >> dim;
+      }
+    else if (field == "type")
+      {
+      if (desc == "uchar" || desc == "unsigned char" || desc == "uint8" || desc == "uint8_t")
+        setComponent(info, 1, true, false);
+      else if (desc == "signed char" || desc == "int8" || desc == "int8_t")
+        setComponent(info, 1, true, true);
+      else if (desc == "ushort" || desc == "unsigned short" || desc == "unsigned short int" ||
+               desc == "uint16" || desc == "uint16_t")
+        setComponent(info, 2, true, false);
+      else if (desc == "short" || desc == "short int" || desc == "signed short" ||
+               desc == "signed short int" || desc == "int16" || desc == "int16_t")
+        setComponent(info, 2, true, true);
+      else if (desc == "uint" || desc == "unsigned int" || desc == "uint32" || desc == "uint32_t")
+        setComponent(info, 4, true, false);
+      else if (desc == "int" || desc == "signed int" || desc == "int32" || desc == "int32_t")
+        setComponent(info, 4, true, true);
+      else if (desc == "float")
+        setComponent(info, 4, false, true);
+      else if (desc == "double")
+        setComponent(info, 8, false, true);
+      else
+        return false;
+      }
+    else if (field == "sizes")
+      {
+      while (values >> length)
+        {
+        info.Size.push_back(length);
+        }
+      }
+    else if (field == "endian")
+      {
+      info.BigEndian = ( desc == "big" );
+      }
+    else if (field == "encoding")
+      {
+      if (desc != "raw")
+        {
+        return false;
+        }
+      }
+    else if (field == "kinds")
+      {
+      // a single component per pixel
+      std::string kind;
+      while (values >> kind)
+        {
+        if (kind != "domain" && kind != "space" && kind != "time")
+          {
+          return false;
+          }
+        }
+      }
+    else if (field == "spacings")
+      {
+      while (values >> number)
+        {
+        info.Spacing.push_back(number);
+        }
+      }
+    else if (field == "space")
+      {
+      rasSpace = ( desc == "right-anterior-superior" || desc == "RAS" );
+      lasSpace = ( desc == "left-anterior-superior" || desc == "LAS" );
+      }
+    else if (field == "space directions")
+      {
+      std::vector<double> axis;
+      for (unsigned d = 0; d < dim; d++)
+        {
+        axis.clear();
+        if (!readNrrdVector(values, axis) || axis.size() != dim)
+          {
+          return false;
+          }
+        double norm = 0;
+        for (unsigned k = 0; k < dim; k++)
+          {
+          norm += axis[k] * axis[k];
+          }
+        norm = std::sqrt(norm);
+        if (norm == 0)
+          {
+          return false;
+          }
+        info.Spacing.push_back(norm);
+        for (unsigned k = 0; k < dim; k++)
+          {
+          info.Direction.push_back(axis[k] / norm);
+          }
+        }
+      haveDirections = true;
+      }
+    else if (field == "space origin")
+      {
+      if (!readNrrdVector(values, info.Origin))
+        {
+        return false;
+        }
+      }
+    else if (field == "data file" || field == "datafile")
+      {
+      if (desc.find_first_of(" %") != std::string::npos)
+        {
+        return false;
+        }
+      info.DataFile = headerDataFile(filename, desc);
+      }
+    else if (field == "byte skip" || field == "byteskip")
+      {
+      values >> byteSkip;
+      }
+    else if (field == "line skip" || field == "lineskip")
+      {
+      if (desc != "0")
+        {
+        return false;
+        }
+      }
+    }
+
+  if (haveDirections && info.Spacing.size() > dim)
+    {
+    // spacings given as well as space directions
+    info.Spacing.erase(info.Spacing.begin(), info.Spacing.end() - dim);
+    }
+
+  // ITK uses LPS coordinates
+  if (rasSpace || lasSpace)
+    {
+    for (unsigned d = 0; d < info.Direction.size(); d += dim)
+      {
+      for (unsigned k = rasSpace ? 0 : 1; k < 2 && k < dim; k++)
+        {
+        info.Direction[d + k] = -info.Direction[d + k];
+        }
+      }
+    for (unsigned k = rasSpace ? 0 : 1; k < 2 && k < info.Origin.size(); k++)
+      {
+      info.Origin[k] = -info.Origin[k];
+      }
+    }
+
+  if (info.DataFile.empty())
+    {
+    info.DataFile = filename;
+    info.Offset = byteSkip < 0 ? -1 : (long)in.tellg() + byteSkip;
+    }
+  else
+    {
+    info.Offset = byteSkip;
+    }
+  return completeFileInfo(info, dim);
+}
+
+// The header of a mappable file, if the file is one.
+inline bool readMappedFileInfo(const std::string & filename, MappedFileInfo & info)
+{
+  const std::string ext = itksys::SystemTools::LowerCase(
+    itksys::SystemTools::GetFilenameLastExtension(filename));
+  if (ext == ".mha" || ext == ".mhd")
+    {
+    return readMetaImageHeader(filename, info);
+    }
+  if (ext == ".nrrd" || ext == ".nhdr")
+    {
+    return readNrrdHeader(filename, info);
+    }
+  return false;
+}
+
+// Map the pixels of the file as an image, or return 0 when they can't
+// be used as they are.
+template <class TImage>
+typename TImage::Pointer mapIm(std::string filename)
+{
+  typedef typename TImage::PixelType PixelType;
+  typedef typename TImage::PixelContainer PixelContainerType;
+  typedef typename itk::MappedImageContainer<
+    typename PixelContainerType::ElementIdentifier, PixelType> ContainerType;
+  const unsigned dim = TImage::ImageDimension;
+
+  MappedFileInfo info;
+  if (!readMappedFileInfo(filename, info))
+    {
+    return 0;
+    }
+
+  const unsigned fileDim = info.Size.size();
+  const bool integer = itk::NumericTraits<PixelType>::is_integer;
+  if (fileDim > dim || info.ComponentSize != sizeof(PixelType) ||
+      info.Integer != integer ||
+      ( integer && info.Signed != itk::NumericTraits<PixelType>::is_signed ) ||
+      ( sizeof(PixelType) > 1 &&
+        info.BigEndian != itk::ByteSwapper<PixelType>::SystemIsBigEndian() ))
+    {
+    return 0;
+    }
+
+  typename TImage::SizeType size;
+  typename TImage::SpacingType spacing;
+  typename TImage::PointType origin;
+  typename TImage::DirectionType direction;
+  direction.SetIdentity();
+  unsigned long count = 1;
+  for (unsigned i = 0; i < dim; i++)
+    {
+    size[i] = i < fileDim ? info.Size[i] : 1;
+    spacing[i] = i < fileDim ? info.Spacing[i] : 1.0;
+    origin[i] = i < fileDim ? info.Origin[i] : 0.0;
+    count *= size[i];
+    }
+  for (unsigned i = 0; i < fileDim; i++)
+    {
+    for (unsigned j = 0; j < fileDim; j++)
+      {
+      direction[j][i] = info.Direction[i * fileDim + j];
+      }
+    }
+
+  long offset = info.Offset;
+  if (offset < 0)
+    {
+    offset = (long)itksys::SystemTools::FileLength(info.DataFile.c_str())
+      - (long)( count * sizeof(PixelType) );
+    }
+  typename ContainerType::Pointer container = ContainerType::New();
+  if (offset < 0 || !container->Map(info.DataFile.c_str(), offset, count))
+    {
+    return 0;
+    }
+
+  typename TImage::Pointer result = TImage::New();
+  result->SetRegions(size);
+  result->SetSpacing(spacing);
+  result->SetOrigin(origin);
+  result->SetDirection(direction);
+  result->SetPixelContainer(container);
+  return result;
+}
+
+// Map the file if its pixels can be used as they are, read it
+// otherwise.
+template <class TImage>
+typename TImage::Pointer readImMapped(std::string filename)
+{
+  typename TImage::Pointer result = mapIm<TImage>(filename);
+  if (result)
+    {
+    return result;
+    }
+  return readIm<TImage>(filename);
+}
+
+#endif
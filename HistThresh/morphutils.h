@@ -1,8 +1,14 @@
 // A collection of utilities to support morphological operations. All
-// structuring element sizes are in mm.
+// structuring element sizes are in mm. The MM helpers use a box by
+// default, or a polygon approximating a ball when given a number of
+// lines (see getKernel).
 //
 // This file includes the slightly dodgy practice of a global vector to
-// store filter classes and hence permit streaming to continue
+// store filter classes and hence permit streaming to continue. The
+// Lazy versions of the helpers return the output of a filter kept in
+// that vector (see filterstack.h) instead of a finished image, so
+// that chains of them can be updated, or streamed with streamIm(), as
+// a single pipeline. Call clearStack() when the chain is done.
 #ifndef __morphutils_h
 #define __morphutils_h
 
@@ -14,6 +20,8 @@
 #include "itkMorphologicalGradientImageFilter.h"
 //#include "itkConnectedComponentImageFilter5.h"
 #include <itkSubtractImageFilter.h>
+#include "itkRunLengthMask.h"
+#include "filterstack.h"
 #include <itkNumericTraits.h>
 
 
@@ -44,9 +52,65 @@ void fixRadius(int &xrad, int &yrad, int &zrad)
     zrad = xrad;
 }
 
+template <class TImage>
+typename TImage::SizeType getVoxelRadius(int xrad, int yrad, int zrad)
+{
+  fixRadius(xrad, yrad, zrad);
+  typename TImage::SizeType result;
+  result[0] = xrad;
+  result[1] = yrad;
+  if (TImage::ImageDimension > 2)
+    result[2] = zrad;
+  return result;
+}
+
+// The structuring element of the MM helpers. With lines == 0 it is
+// the box of radius rad. Otherwise it is the polygon of that many
+// periodic lines approximating the ellipsoid of radius rad.
+// FlatStructuringElement::Poly only builds polygons in 2D, and in 3D
+// for some numbers of lines, leaving the element empty otherwise, so
+// those cases throw an exception instead. Both decompose into lines,
+// which the VHGW algorithm processes at a cost per voxel that does not
+// depend on the radius.
+template <class TImage>
+itk::FlatStructuringElement< TImage::ImageDimension >
+getKernel(typename TImage::SizeType rad, unsigned lines)
+{
+  typedef typename itk::FlatStructuringElement< TImage::ImageDimension > SRType;
+  if (lines == 0)
+    return SRType::Box(rad);
+  if (TImage::ImageDimension != 2 && TImage::ImageDimension != 3)
+    {
+    itkGenericExceptionMacro(<< "Polygon structuring elements are only available in 2D and 3D, not in "
+                             << TImage::ImageDimension << "D");
+    }
+  SRType kernel = SRType::Poly(rad, lines);
+  if (kernel.GetLines().empty())
+    {
+    itkGenericExceptionMacro(<< "No polygon structuring element of " << lines
+                             << " lines in " << TImage::ImageDimension
+                             << "D, see FlatStructuringElement::Poly");
+    }
+  return kernel;
+}
+
+// connect a kernel filter to input without updating it
+template <class TFilter, class TImage>
+typename TImage::Pointer connectKernelFilter(const typename TImage::Pointer input,
+					     typename TFilter::KernelType kernel)
+{
+  typename TFilter::Pointer filt = TFilter::New();
+  filt->SetInput(input);
+  filt->SetKernel(kernel);
+  filt->SetAlgorithm(TFilter::VHGW);
+  AddToStack(filt);
+  return(filt->GetOutput());
+}
+
 template <class TImage>
 typename TImage::Pointer doErodeMM(const typename TImage::Pointer input, float xrad, 
-				   float yrad=-1, float zrad=-1)
+				   float yrad=-1, float zrad=-1,
+				   unsigned lines=0)
 {
   const unsigned int dim = TImage::ImageDimension;
   typedef typename itk::FlatStructuringElement< dim > SRType;
@@ -55,7 +119,7 @@ typename TImage::Pointer doErodeMM(const typename TImage::Pointer input, float x
   typename SRType::RadiusType rad = getRadius<TImage>(xrad, yrad, zrad, input->GetSpacing());
   SRType kernel;
 
-  kernel = SRType::Box(rad);
+  kernel = getKernel<TImage>(rad, lines);
 
   typedef typename itk::GrayscaleErodeImageFilter<TImage, TImage, SRType> FiltType;
   typename FiltType::Pointer filt = FiltType::New();
@@ -204,7 +268,8 @@ typename TImage::Pointer doGradient(const typename TImage::Pointer input, int xr
 
 template <class TImage>
 typename TImage::Pointer doDilateMM(const typename TImage::Pointer input, float xrad, 
-				    float yrad=-1, float zrad=-1)
+				    float yrad=-1, float zrad=-1,
+				    unsigned lines=0)
 {
   const unsigned int dim = TImage::ImageDimension;
   typedef typename itk::FlatStructuringElement< dim > SRType;
@@ -213,7 +278,7 @@ typename TImage::Pointer doDilateMM(const typename TImage::Pointer input, float
   typename SRType::RadiusType rad = getRadius<TImage>(xrad, yrad, zrad, input->GetSpacing());
   SRType kernel;
 
-  kernel = SRType::Box(rad);
+  kernel = getKernel<TImage>(rad, lines);
 
   typedef typename itk::GrayscaleDilateImageFilter<TImage, TImage, SRType> FiltType;
   typename FiltType::Pointer filt = FiltType::New();
@@ -231,7 +296,8 @@ typename TImage::Pointer doDilateMM(const typename TImage::Pointer input, float
 
 template <class TImage>
 typename TImage::Pointer doOpeningMM(const typename TImage::Pointer input, float xrad, 
-				     float yrad=-1, float zrad=-1)
+				     float yrad=-1, float zrad=-1,
+				     unsigned lines=0)
 {
   const unsigned int dim = TImage::ImageDimension;
   typedef typename itk::FlatStructuringElement< dim > SRType;
@@ -239,7 +305,7 @@ typename TImage::Pointer doOpeningMM(const typename TImage::Pointer input, float
   typename SRType::RadiusType rad = getRadius<TImage>(xrad, yrad, zrad, input->GetSpacing());
   SRType kernel;
 
-  kernel = SRType::Box(rad);
+  kernel = getKernel<TImage>(rad, lines);
 
   typedef typename itk::GrayscaleMorphologicalOpeningImageFilter<TImage, TImage, SRType> FiltType;
   typename FiltType::Pointer filt = FiltType::New();
@@ -343,7 +409,8 @@ typename TImage::Pointer doGradientOuterMM(const typename TImage::Pointer input,
 
 template <class TImage>
 typename TImage::Pointer doClosingMM(const typename TImage::Pointer input, float xrad, 
-				     float yrad=-1, float zrad=-1)
+				     float yrad=-1, float zrad=-1,
+				     unsigned lines=0)
 {
   const unsigned int dim = TImage::ImageDimension;
   typedef typename itk::FlatStructuringElement< dim > SRType;
@@ -351,7 +418,7 @@ typename TImage::Pointer doClosingMM(const typename TImage::Pointer input, float
   typename SRType::RadiusType rad = getRadius<TImage>(xrad, yrad, zrad, input->GetSpacing());
   SRType kernel;
 
-  kernel = SRType::Box(rad);
+  kernel = getKernel<TImage>(rad, lines);
 
   typedef typename itk::GrayscaleMorphologicalClosingImageFilter<TImage, TImage, SRType> FiltType;
   typename FiltType::Pointer filt = FiltType::New();
@@ -385,6 +452,169 @@ typename TImage::Pointer doBlackTopHatMM(const typename TImage::Pointer input, f
 //   return(sub->GetOutput());
 }
 
+////////////////////////////////////////////////////////////////////
+// Lazy versions, returning the output of a filter on the stack
+template <class TImage>
+typename TImage::Pointer doErodeLazy(const typename TImage::Pointer input, int xrad,
+				     int yrad=-1, int zrad=-1)
+{
+  typedef typename itk::FlatStructuringElement< TImage::ImageDimension > SRType;
+  typedef typename itk::GrayscaleErodeImageFilter<TImage, TImage, SRType> FiltType;
+  return(connectKernelFilter<FiltType, TImage>(input, SRType::Box(getVoxelRadius<TImage>(xrad, yrad, zrad))));
+}
+
+template <class TImage>
+typename TImage::Pointer doDilateLazy(const typename TImage::Pointer input, int xrad,
+				      int yrad=-1, int zrad=-1)
+{
+  typedef typename itk::FlatStructuringElement< TImage::ImageDimension > SRType;
+  typedef typename itk::GrayscaleDilateImageFilter<TImage, TImage, SRType> FiltType;
+  return(connectKernelFilter<FiltType, TImage>(input, SRType::Box(getVoxelRadius<TImage>(xrad, yrad, zrad))));
+}
+
+template <class TImage>
+typename TImage::Pointer doOpeningLazy(const typename TImage::Pointer input, int xrad,
+				       int yrad=-1, int zrad=-1)
+{
+  typedef typename itk::FlatStructuringElement< TImage::ImageDimension > SRType;
+  typedef typename itk::GrayscaleMorphologicalOpeningImageFilter<TImage, TImage, SRType> FiltType;
+  return(connectKernelFilter<FiltType, TImage>(input, SRType::Box(getVoxelRadius<TImage>(xrad, yrad, zrad))));
+}
+
+template <class TImage>
+typename TImage::Pointer doClosingLazy(const typename TImage::Pointer input, int xrad,
+				       int yrad=-1, int zrad=-1)
+{
+  typedef typename itk::FlatStructuringElement< TImage::ImageDimension > SRType;
+  typedef typename itk::GrayscaleMorphologicalClosingImageFilter<TImage, TImage, SRType> FiltType;
+  return(connectKernelFilter<FiltType, TImage>(input, SRType::Box(getVoxelRadius<TImage>(xrad, yrad, zrad))));
+}
+
+template <class TImage>
+typename TImage::Pointer doGradientLazy(const typename TImage::Pointer input, int xrad,
+					int yrad=-1, int zrad=-1)
+{
+  typedef typename itk::FlatStructuringElement< TImage::ImageDimension > SRType;
+  typedef typename itk::MorphologicalGradientImageFilter<TImage, TImage, SRType> FiltType;
+  return(connectKernelFilter<FiltType, TImage>(input, SRType::Box(getVoxelRadius<TImage>(xrad, yrad, zrad))));
+}
+
+// The MM versions only need the spacing of the input, which is known
+// without computing the pixels. lines is as for getKernel.
+template <class TImage>
+typename TImage::Pointer doErodeMMLazy(const typename TImage::Pointer input, float xrad,
+				       float yrad=-1, float zrad=-1,
+				       unsigned lines=0)
+{
+  typedef typename itk::FlatStructuringElement< TImage::ImageDimension > SRType;
+  typedef typename itk::GrayscaleErodeImageFilter<TImage, TImage, SRType> FiltType;
+  input->UpdateOutputInformation();
+  return(connectKernelFilter<FiltType, TImage>(input, getKernel<TImage>(getRadius<TImage>(xrad, yrad, zrad, input->GetSpacing()), lines)));
+}
+
+template <class TImage>
+typename TImage::Pointer doDilateMMLazy(const typename TImage::Pointer input, float xrad,
+					float yrad=-1, float zrad=-1,
+					unsigned lines=0)
+{
+  typedef typename itk::FlatStructuringElement< TImage::ImageDimension > SRType;
+  typedef typename itk::GrayscaleDilateImageFilter<TImage, TImage, SRType> FiltType;
+  input->UpdateOutputInformation();
+  return(connectKernelFilter<FiltType, TImage>(input, getKernel<TImage>(getRadius<TImage>(xrad, yrad, zrad, input->GetSpacing()), lines)));
+}
+
+template <class TImage>
+typename TImage::Pointer doOpeningMMLazy(const typename TImage::Pointer input, float xrad,
+					 float yrad=-1, float zrad=-1,
+					 unsigned lines=0)
+{
+  typedef typename itk::FlatStructuringElement< TImage::ImageDimension > SRType;
+  typedef typename itk::GrayscaleMorphologicalOpeningImageFilter<TImage, TImage, SRType> FiltType;
+  input->UpdateOutputInformation();
+  return(connectKernelFilter<FiltType, TImage>(input, getKernel<TImage>(getRadius<TImage>(xrad, yrad, zrad, input->GetSpacing()), lines)));
+}
+
+template <class TImage>
+typename TImage::Pointer doClosingMMLazy(const typename TImage::Pointer input, float xrad,
+					 float yrad=-1, float zrad=-1,
+					 unsigned lines=0)
+{
+  typedef typename itk::FlatStructuringElement< TImage::ImageDimension > SRType;
+  typedef typename itk::GrayscaleMorphologicalClosingImageFilter<TImage, TImage, SRType> FiltType;
+  input->UpdateOutputInformation();
+  return(connectKernelFilter<FiltType, TImage>(input, getKernel<TImage>(getRadius<TImage>(xrad, yrad, zrad, input->GetSpacing()), lines)));
+}
+
+////////////////////////////////////////////////////////////////////
+// Morphology on run length masks, working on the runs without
+// making an image. TMask is an itk::RunLengthMask. The input is left
+// untouched.
+template <class TMask>
+typename TMask::Pointer doErodeRLE(const typename TMask::Pointer input, int xrad,
+				   int yrad=-1, int zrad=-1,
+				   typename TMask::StructuringElementType shape = TMask::Box)
+{
+  typename TMask::Pointer result = TMask::New();
+  result->DeepCopy(input);
+  result->Erode(getVoxelRadius<TMask>(xrad, yrad, zrad), shape);
+  return(result);
+}
+
+template <class TMask>
+typename TMask::Pointer doDilateRLE(const typename TMask::Pointer input, int xrad,
+				    int yrad=-1, int zrad=-1,
+				    typename TMask::StructuringElementType shape = TMask::Box)
+{
+  typename TMask::Pointer result = TMask::New();
+  result->DeepCopy(input);
+  result->Dilate(getVoxelRadius<TMask>(xrad, yrad, zrad), shape);
+  return(result);
+}
+
+template <class TMask>
+typename TMask::Pointer doOpeningRLE(const typename TMask::Pointer input, int xrad,
+				     int yrad=-1, int zrad=-1,
+				     typename TMask::StructuringElementType shape = TMask::Box)
+{
+  typename TMask::Pointer result = TMask::New();
+  result->DeepCopy(input);
+  result->Opening(getVoxelRadius<TMask>(xrad, yrad, zrad), shape);
+  return(result);
+}
+
+template <class TMask>
+typename TMask::Pointer doClosingRLE(const typename TMask::Pointer input, int xrad,
+				     int yrad=-1, int zrad=-1,
+				     typename TMask::StructuringElementType shape = TMask::Box)
+{
+  typename TMask::Pointer result = TMask::New();
+  result->DeepCopy(input);
+  result->Closing(getVoxelRadius<TMask>(xrad, yrad, zrad), shape);
+  return(result);
+}
+
+template <class TMask>
+typename TMask::Pointer doOpeningRLEMM(const typename TMask::Pointer input, float xrad,
+				       float yrad=-1, float zrad=-1,
+				       typename TMask::StructuringElementType shape = TMask::Box)
+{
+  typename TMask::Pointer result = TMask::New();
+  result->DeepCopy(input);
+  result->Opening(getRadius<TMask>(xrad, yrad, zrad, input->GetSpacing()), shape);
+  return(result);
+}
+
+template <class TMask>
+typename TMask::Pointer doClosingRLEMM(const typename TMask::Pointer input, float xrad,
+				       float yrad=-1, float zrad=-1,
+				       typename TMask::StructuringElementType shape = TMask::Box)
+{
+  typename TMask::Pointer result = TMask::New();
+  result->DeepCopy(input);
+  result->Closing(getRadius<TMask>(xrad, yrad, zrad, input->GetSpacing()), shape);
+  return(result);
+}
+
 ////////////////////////////////////////////////////////////////////
 template <class LImage>
 void fillRegion(typename LImage::Pointer im, typename LImage::RegionType region,                typename LImage::PixelType value)
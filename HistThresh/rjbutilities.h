@@ -1,46 +1,45 @@
 #ifndef _RJBUTILITIES_H
 #define _RJBUTILITIES_H
 
-#include "itkLabelImageToStatisticsLabelMapFilter.h"
+#include "itkMaskQuantileImageFilter.h"
 #include "itkLabelStatisticsImageFilter.h"
 #include <itkBinaryThresholdImageFilter.h>
 #include <itkResampleImageFilter.h>
 #include <itkIdentityTransform.h>
 #include <itkLinearInterpolateImageFunction.h>
 #include <itkNearestNeighborInterpolateImageFunction.h>
+#include "filterstack.h"
+
+// The Lazy versions of the helpers return the output of a filter kept
+// on the filter stack (see filterstack.h) instead of a finished image,
+// so that they can be chained with those of morphutils.h and the
+// chain updated, or streamed, in one go.
 
 #if 1
 /////////////////////////////////////////////////////////
 template <class RawIm, class MaskIm, class RealType>
 std::vector<RealType>
 computeMaskQuantiles(typename RawIm::Pointer raw, typename MaskIm::Pointer mask, 
-		     std::vector<RealType> quantiles)
+		     std::vector<RealType> quantiles, bool approximate=false)
 {
-  // robust rescaling based on median and IQR
-  typedef typename itk::LabelImageToStatisticsLabelMapFilter <MaskIm, RawIm> LabStatsType;
+  // quantiles of the voxels of label 1, in one pass. The approximate
+  // version uses a sketch of bounded relative error instead of keeping
+  // the values.
+  typedef typename itk::MaskQuantileImageFilter <RawIm, MaskIm> QuantType;
   
-  typename LabStatsType::Pointer statsfilt = LabStatsType::New();
-  statsfilt->SetFeatureImage(raw);
-  statsfilt->SetInput(mask);
-  statsfilt->Update();
-
-  // typename LabStatsType::RealType Mn = statsfilt->GetMinimum(1);
-  // typename LabStatsType::RealType Mx = statsfilt->GetMaximum(1);
-
-  //statsfilt->SetHistogramParameters(100, Mn, Mx);
-  statsfilt->SetComputeHistogram(true);
-  statsfilt->Modified();
-  statsfilt->Update();
-
-  // the output image is actually a label map
-  typename LabStatsType::OutputImageType * labelMap = statsfilt->GetOutput();
-  const typename LabStatsType::LabelObjectType * labelObject = labelMap->GetLabelObject( 1 );
-  const typename LabStatsType::LabelObjectType::HistogramType * hist = labelObject->GetHistogram();
+  typename QuantType::Pointer quantfilt = QuantType::New();
+  quantfilt->SetInput(raw);
+  quantfilt->SetLabelInput(mask);
+  quantfilt->AddLabel(1);
+  quantfilt->SetQuantiles(std::vector<double>(quantiles.begin(), quantiles.end()));
+  quantfilt->SetUseSketch(approximate);
+  quantfilt->Update();
 
+  std::vector<double> q = quantfilt->GetQuantiles(1);
   std::vector<RealType> result;
-  for (unsigned K=0;K<quantiles.size();K++)
+  for (unsigned K=0;K<q.size();K++)
     {
-    result.push_back((RealType)hist->Quantile(0, quantiles[K]));
+    result.push_back((RealType)q[K]);
     }
   return(result);
 }
@@ -105,9 +104,44 @@ typename MaskIm::Pointer doThresh2(typename RawIm::Pointer raw, float threshVal,
   return(result);
 }
 
+/////////////////////////////////////////////////////////
+template <class RawIm, class MaskIm>
+typename MaskIm::Pointer doThreshLazy(typename RawIm::Pointer raw, float threshVal, float scale = 1.0)
+{
+  typedef typename itk::BinaryThresholdImageFilter<RawIm, MaskIm> ThreshType;
+  typename ThreshType::Pointer wthresh = ThreshType::New();
+  wthresh->SetInput(raw);
+  // take into account spm's scaling
+  wthresh->SetUpperThreshold((typename RawIm::PixelType)(threshVal * scale));
+  wthresh->SetLowerThreshold(0);
+  wthresh->SetInsideValue(0);
+  wthresh->SetOutsideValue(1);
+  AddToStack(wthresh);
+  return(wthresh->GetOutput());
+}
+
+/////////////////////////////////////////////////////////
+template <class RawIm, class MaskIm>
+typename MaskIm::Pointer doThresh2Lazy(typename RawIm::Pointer raw, float threshVal, float scale = 1.0)
+{
+  typedef typename itk::BinaryThresholdImageFilter<RawIm, MaskIm> ThreshType;
+  typename ThreshType::Pointer wthresh = ThreshType::New();
+  wthresh->SetInput(raw);
+  // take into account spm's scaling
+  wthresh->SetUpperThreshold((typename RawIm::PixelType)(threshVal * scale));
+  wthresh->SetLowerThreshold(0);
+  wthresh->SetInsideValue(1);
+  wthresh->SetOutsideValue(0);
+  AddToStack(wthresh);
+  return(wthresh->GetOutput());
+}
+
 ///////////////////////////////////////////////////
+// set up, without updating, the resampler used by resampleIm. Only
+// the information of the input is needed.
 template  <class RawIm>
-typename RawIm::Pointer resampleIm(typename RawIm::Pointer input, typename RawIm::SpacingType NewSpacing, int interp=1)
+typename itk::ResampleImageFilter<RawIm, RawIm>::Pointer
+makeResampler(typename RawIm::Pointer input, typename RawIm::SpacingType NewSpacing, int interp)
 {
   const int dim = RawIm::ImageDimension;
   typedef typename RawIm::PixelType PixelType;
@@ -116,7 +150,7 @@ typename RawIm::Pointer resampleIm(typename RawIm::Pointer input, typename RawIm
   typedef typename itk::IdentityTransform< double, dim >  TransformType;
   typename ResampleFilterType::Pointer resampler = ResampleFilterType::New();
 
-  input->Update();
+  input->UpdateOutputInformation();
 
   typename TransformType::Pointer transform = TransformType::New();
   transform->SetIdentity();
@@ -176,15 +210,33 @@ typename RawIm::Pointer resampleIm(typename RawIm::Pointer input, typename RawIm
   resampler->SetOutputStartIndex ( idx );
   resampler->SetOutputDirection(input->GetDirection());
   resampler->SetInput(input);
+  return(resampler);
+}
+
+template  <class RawIm>
+typename RawIm::Pointer resampleIm(typename RawIm::Pointer input, typename RawIm::SpacingType NewSpacing, int interp=1)
+{
+  typename itk::ResampleImageFilter<RawIm, RawIm>::Pointer resampler =
+    makeResampler<RawIm>(input, NewSpacing, interp);
   typename RawIm::Pointer result = resampler->GetOutput();
   result->Update();
   result->DisconnectPipeline();
   return(result);
 }
 
+template  <class RawIm>
+typename RawIm::Pointer resampleImLazy(typename RawIm::Pointer input, typename RawIm::SpacingType NewSpacing, int interp=1)
+{
+  typename itk::ResampleImageFilter<RawIm, RawIm>::Pointer resampler =
+    makeResampler<RawIm>(input, NewSpacing, interp);
+  AddToStack(resampler);
+  return(resampler->GetOutput());
+}
+
 ///////////////////////////////////////////////////
 template  <class RawIm>
-typename RawIm::Pointer resampleIm(typename RawIm::Pointer input, typename RawIm::Pointer exampleIm, int interp=1)
+typename itk::ResampleImageFilter<RawIm, RawIm>::Pointer
+makeResampler(typename RawIm::Pointer input, typename RawIm::Pointer exampleIm, int interp)
 {
   const int dim = RawIm::ImageDimension;
   typedef typename RawIm::PixelType PixelType;
@@ -193,8 +245,6 @@ typename RawIm::Pointer resampleIm(typename RawIm::Pointer input, typename RawIm
   typedef typename itk::IdentityTransform< double, dim >  TransformType;
   typename ResampleFilterType::Pointer resampler = ResampleFilterType::New();
 
-  input->Update();
-
   typename TransformType::Pointer transform = TransformType::New();
   transform->SetIdentity();
   resampler->SetTransform( transform );
@@ -220,11 +270,28 @@ typename RawIm::Pointer resampleIm(typename RawIm::Pointer input, typename RawIm
   resampler->SetDefaultPixelValue( 0 );
 
   resampler->SetInput(input);
+  return(resampler);
+}
+
+template  <class RawIm>
+typename RawIm::Pointer resampleIm(typename RawIm::Pointer input, typename RawIm::Pointer exampleIm, int interp=1)
+{
+  typename itk::ResampleImageFilter<RawIm, RawIm>::Pointer resampler =
+    makeResampler<RawIm>(input, exampleIm, interp);
   typename RawIm::Pointer result = resampler->GetOutput();
   result->Update();
   result->DisconnectPipeline();
   return(result);
 }
 
+template  <class RawIm>
+typename RawIm::Pointer resampleImLazy(typename RawIm::Pointer input, typename RawIm::Pointer exampleIm, int interp=1)
+{
+  typename itk::ResampleImageFilter<RawIm, RawIm>::Pointer resampler =
+    makeResampler<RawIm>(input, exampleIm, interp);
+  AddToStack(resampler);
+  return(resampler->GetOutput());
+}
+
 
 #endif
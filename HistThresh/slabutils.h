@@ -0,0 +1,332 @@
+#ifndef __slabutils_h_
+#define __slabutils_h_
+
+// Thresholding of a large volume by several processes, each handling a
+// slab along the last axis, coordinating only through files in a
+// shared directory. See thresholdSlabs.cxx for the driver.
+//
+// A worker goes through the steps below in order. The steps that need
+// the files of the other workers wait for them, so the workers can run
+// concurrently on any hosts, or one after the other step by step in a
+// single process.
+//
+//   1. publishSlabRange: save the intensity range of the slab, unless
+//      the range of the volume is given.
+//   2. agreeSlabRange: wait for every range and take their union, so
+//      that all the slabs are binned on the same edges.
+//   3. publishSlabHistogram: save the histogram of the slab.
+//   4. reduceSlabHistograms (worker 0 only): merge the histograms and
+//      save the threshold of the whole volume, or a failure marker if
+//      there is none.
+//   5. readSlabThreshold and writeSlabMask: binarize the slab. Every
+//      worker fails if worker 0 found no threshold.
+//
+// Files are published by renaming, so a partially written file is never
+// picked up.
+
+#include "ioutils.h"
+
+#include <itkRegionOfInterestImageFilter.h>
+#include <itkBinaryThresholdImageFilter.h>
+#include <itkMinimumMaximumImageCalculator.h>
+#include <itksys/SystemTools.hxx>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+
+typedef itk::Image<unsigned char, 3> SlabMaskType;
+typedef itk::Image<float, 3> SlabImageType;
+
+// Content of the threshold file when worker 0 found no threshold.
+const char * const SlabFailureMarker = "failed";
+
+struct SlabOptions
+{
+  std::string Input;
+  std::string OutputPattern;
+  std::string SharedDir;
+  unsigned    Workers;
+  unsigned    Worker;
+  unsigned long Bins;
+  double      Timeout;
+  bool        FixedRange;
+  float       Minimum;
+  float       Maximum;
+};
+
+inline std::string sharedFile(const SlabOptions & opts, const char * name, unsigned worker)
+{
+  std::ostringstream path;
+  path << opts.SharedDir << "/" << name << "-" << worker;
+  return path.str();
+}
+
+// Publish a file written under a temporary name.
+inline bool publish(const std::string & tmp, const std::string & path)
+{
+  return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+// Wait for a file to appear in the shared directory.
+inline bool waitFor(const std::string & path, double timeout)
+{
+  double waited = 0;
+  while (!itksys::SystemTools::FileExists(path.c_str()))
+    {
+    if (waited > timeout)
+      {
+      std::cerr << "Timed out waiting for " << path << std::endl;
+      return false;
+      }
+    itksys::SystemTools::Delay(200);
+    waited += 0.2;
+    }
+  return true;
+}
+
+// Read the slab of the worker: the last axis that isn't flat is split
+// into equal slabs. The reader streams the slab when the file format
+// allows it.
+inline SlabImageType::Pointer readSlab(const SlabOptions & opts)
+{
+  // only the header is read here
+  typedef itk::ImageFileReader<SlabImageType> ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(opts.Input.c_str());
+  reader->UpdateOutputInformation();
+  SlabImageType::RegionType whole = reader->GetOutput()->GetLargestPossibleRegion();
+
+  unsigned axis = SlabImageType::ImageDimension - 1;
+  while (axis > 0 && whole.GetSize(axis) == 1)
+    {
+    axis--;
+    }
+  unsigned long length = whole.GetSize(axis);
+  if (length < opts.Workers)
+    {
+    std::cerr << "More workers than slices" << std::endl;
+    return 0;
+    }
+  unsigned long first = (length * opts.Worker) / opts.Workers;
+  unsigned long last = (length * (opts.Worker + 1)) / opts.Workers;
+  SlabImageType::RegionType slabRegion = whole;
+  slabRegion.SetIndex(axis, whole.GetIndex(axis) + first);
+  slabRegion.SetSize(axis, last - first);
+
+  typedef itk::RegionOfInterestImageFilter<SlabImageType, SlabImageType> ROIType;
+  ROIType::Pointer roi = ROIType::New();
+  roi->SetInput(reader->GetOutput());
+  roi->SetRegionOfInterest(slabRegion);
+  SlabImageType::Pointer slab = roi->GetOutput();
+  slab->Update();
+  slab->DisconnectPipeline();
+  return slab;
+}
+
+inline bool publishSlabRange(const SlabOptions & opts, const SlabImageType * slab)
+{
+  typedef itk::MinimumMaximumImageCalculator<SlabImageType> RangeType;
+  RangeType::Pointer range = RangeType::New();
+  range->SetImage(slab);
+  range->Compute();
+
+  std::string rangeFile = sharedFile(opts, "range", opts.Worker);
+  std::ofstream out((rangeFile + ".tmp").c_str());
+  out << std::setprecision(9) << range->GetMinimum() << " "
+      << range->GetMaximum() << std::endl;
+  out.close();
+  if (!out || !publish(rangeFile + ".tmp", rangeFile))
+    {
+    std::cerr << "Can't publish " << rangeFile << std::endl;
+    return false;
+    }
+  return true;
+}
+
+// The union of the ranges of all the slabs.
+inline bool agreeSlabRange(const SlabOptions & opts, float & minimum, float & maximum)
+{
+  for (unsigned w = 0; w < opts.Workers; w++)
+    {
+    std::string rangeFile = sharedFile(opts, "range", w);
+    if (!waitFor(rangeFile, opts.Timeout))
+      {
+      return false;
+      }
+    float low, high;
+    std::ifstream in(rangeFile.c_str());
+    if (!(in >> low >> high))
+      {
+      std::cerr << "Can't read " << rangeFile << std::endl;
+      return false;
+      }
+    minimum = w == 0 ? low : std::min(minimum, low);
+    maximum = w == 0 ? high : std::max(maximum, high);
+    }
+  return true;
+}
+
+template <class TCalculator>
+bool publishSlabHistogram(TCalculator * calculator, const SlabOptions & opts,
+                          const SlabImageType * slab)
+{
+  typename TCalculator::HistogramType histogram;
+  calculator->ComputeHistogram(slab, slab->GetLargestPossibleRegion(), histogram);
+  std::string histFile = sharedFile(opts, "hist", opts.Worker);
+  histogram.Write(histFile + ".tmp");
+  if (!publish(histFile + ".tmp", histFile))
+    {
+    std::cerr << "Can't publish " << histFile << std::endl;
+    return false;
+    }
+  return true;
+}
+
+// Merge the histograms of all the slabs and publish the threshold.
+// Histograms on different bins are each rebinned once, onto the union
+// of their ranges, rather than at every merge, so that the result
+// doesn't depend on the order of the workers.
+template <class TCalculator>
+bool reduceSlabHistograms(TCalculator * calculator, const SlabOptions & opts)
+{
+  typedef typename TCalculator::HistogramType HistogramType;
+
+  std::vector<HistogramType> parts(opts.Workers);
+  bool exact = true;
+  for (unsigned w = 0; w < opts.Workers; w++)
+    {
+    std::string partFile = sharedFile(opts, "hist", w);
+    if (!waitFor(partFile, opts.Timeout))
+      {
+      return false;
+      }
+    parts[w].Read(partFile);
+    exact = exact && parts[w].GetExact();
+    }
+
+  HistogramType merged;
+  if (!exact)
+    {
+    typename HistogramType::ValueType minimum = parts[0].GetMinimum();
+    typename HistogramType::ValueType maximum = parts[0].GetMaximum();
+    for (unsigned w = 1; w < opts.Workers; w++)
+      {
+      minimum = std::min(minimum, parts[w].GetMinimum());
+      maximum = std::max(maximum, parts[w].GetMaximum());
+      }
+    merged.Initialize(minimum, maximum, parts[0].GetNumberOfBins());
+    }
+  for (unsigned w = 0; w < opts.Workers; w++)
+    {
+    merged.Merge(parts[w]);
+    }
+
+  // without a threshold the failure marker is published instead, so
+  // that the other workers stop rather than wait or binarize
+  typename TCalculator::ResultType result = calculator->ComputeThreshold(merged);
+  if (!result.Valid)
+    {
+    std::cerr << "No threshold found" << std::endl;
+    }
+  std::string thresholdFile = opts.SharedDir + "/threshold";
+  std::ofstream out((thresholdFile + ".tmp").c_str());
+  if (result.Valid)
+    {
+    out << std::setprecision(17) << (double)result.Threshold << " "
+        << merged.GetTotalFrequency() << std::endl;
+    }
+  else
+    {
+    out << SlabFailureMarker << std::endl;
+    }
+  out.close();
+  if (!out || !publish(thresholdFile + ".tmp", thresholdFile))
+    {
+    std::cerr << "Can't publish " << thresholdFile << std::endl;
+    return false;
+    }
+  if (!result.Valid)
+    {
+    return false;
+    }
+  std::cout << "Threshold: " << (float)result.Threshold << " from "
+            << merged.GetTotalFrequency() << " voxels" << std::endl;
+  return true;
+}
+
+// Read the threshold published by worker 0. Returns false on a timeout
+// or if worker 0 found no threshold.
+inline bool readSlabThreshold(const SlabOptions & opts, double & threshold)
+{
+  std::string thresholdFile = opts.SharedDir + "/threshold";
+  if (!waitFor(thresholdFile, opts.Timeout))
+    {
+    return false;
+    }
+  std::ifstream in(thresholdFile.c_str());
+  std::string word;
+  if (!(in >> word) || word == SlabFailureMarker)
+    {
+    std::cerr << "No threshold in " << thresholdFile << std::endl;
+    return false;
+    }
+  std::istringstream value(word);
+  return static_cast<bool>(value >> threshold);
+}
+
+inline void writeSlabMask(const SlabOptions & opts, SlabImageType * slab, double threshold)
+{
+  typedef itk::BinaryThresholdImageFilter<SlabImageType, SlabMaskType> BinariserType;
+  BinariserType::Pointer binariser = BinariserType::New();
+  binariser->SetInput(slab);
+  binariser->SetLowerThreshold(itk::NumericTraits<float>::NonpositiveMin());
+  binariser->SetUpperThreshold(static_cast<float>(threshold));
+  binariser->SetInsideValue(0);
+  binariser->SetOutsideValue(1);
+
+  char outName[4096];
+  std::sprintf(outName, opts.OutputPattern.c_str(), opts.Worker);
+  writeIm<SlabMaskType>(binariser->GetOutput(), outName);
+}
+
+// All the steps of a worker.
+template <class TCalculator>
+int runSlabWorker(TCalculator * calculator, const SlabOptions & opts)
+{
+  SlabImageType::Pointer slab = readSlab(opts);
+  if (!slab)
+    {
+    return(EXIT_FAILURE);
+    }
+
+  float minimum = opts.Minimum, maximum = opts.Maximum;
+  if (!opts.FixedRange &&
+      !(publishSlabRange(opts, slab) && agreeSlabRange(opts, minimum, maximum)))
+    {
+    return(EXIT_FAILURE);
+    }
+  calculator->SetHistogramRange(minimum, maximum);
+
+  if (!publishSlabHistogram(calculator, opts, slab))
+    {
+    return(EXIT_FAILURE);
+    }
+  if (opts.Worker == 0 && !reduceSlabHistograms(calculator, opts))
+    {
+    return(EXIT_FAILURE);
+    }
+
+  double threshold;
+  if (!readSlabThreshold(opts, threshold))
+    {
+    return(EXIT_FAILURE);
+    }
+  writeSlabMask(opts, slab, threshold);
+  return(EXIT_SUCCESS);
+}
+
+#endif
@@ -0,0 +1,118 @@
+#include "ioutils.h"
+
+#include "itkLiThresholdImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <itkSmartPointer.h>
+#include <cmath>
+namespace itk
+{
+    template <typename T>
+    class Instance : public T::Pointer {
+    public:
+        Instance() : SmartPointer<T>( T::New() ) {}
+    };
+}
+
+const unsigned dim = 3;
+typedef itk::Image<unsigned char, dim> LabImType;
+typedef itk::Image<float, dim> RawImType;
+typedef itk::LiThresholdImageFilter<RawImType, LabImType> FilterType;
+
+bool nearlyEqual(double a, double b)
+{
+  return std::fabs(a - b) <= 1e-6 * (1.0 + std::fabs(b));
+}
+
+unsigned long countMismatches(const LabImType * a, const LabImType * b)
+{
+  unsigned long mismatches = 0;
+  itk::ImageRegionConstIterator<LabImType> aIt(a, a->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<LabImType> bIt(b, a->GetLargestPossibleRegion());
+  for (; !aIt.IsAtEnd(); ++aIt, ++bIt)
+    {
+    if (aIt.Get() != bIt.Get())
+      {
+      mismatches++;
+      }
+    }
+  return mismatches;
+}
+
+// Threshold with the background found in several ways, in the threaded
+// pass that skips the blocks of background, and check the threshold,
+// the mask and the statistics against thresholding without it.
+int main(int argc, char * argv[])
+{
+  RawImType::Pointer raw = readIm<RawImType>(argv[1]);
+
+  itk::Instance <FilterType> Reference;
+  Reference->SetInput(raw);
+  Reference->SetOutsideValue(0);
+  Reference->SetInsideValue(1);
+  Reference->ComputeStatisticsOn();
+  Reference->Update();
+  LabImType::Pointer reference = Reference->GetOutput();
+  reference->DisconnectPipeline();
+  writeIm<LabImType>(reference, argv[2]);
+
+  // 0 is the background of the test image; the maximum is rarely found
+  // in a whole block and gets the OutsideValue
+  const float backgrounds[] = { 0, 255 };
+  const int threads[] = { 1, 3 };
+  bool ok = true;
+  for (unsigned mode = 0; mode < 3; mode++)
+    {
+    for (unsigned t = 0; t < 2; t++)
+      {
+      for (unsigned s = 0; s < 2; s++)
+        {
+        itk::Instance <FilterType> Thresh;
+        Thresh->SetInput(raw);
+        Thresh->SetOutsideValue(0);
+        Thresh->SetInsideValue(1);
+        Thresh->SetNumberOfThreads(threads[t]);
+        Thresh->SetComputeStatistics(s == 1);
+        if (mode < 2)
+          {
+          Thresh->UseBackgroundValueOn();
+          Thresh->SetBackgroundValue(backgrounds[mode]);
+          }
+        else
+          {
+          Thresh->AutomaticBackgroundValueOn();
+          }
+        Thresh->Update();
+
+        unsigned long mismatches = countMismatches(reference, Thresh->GetOutput());
+        bool same = Thresh->GetThreshold() == Reference->GetThreshold()
+          && mismatches == 0;
+        if (s == 1)
+          {
+          same = same
+            && Thresh->GetInsideCount() == Reference->GetInsideCount()
+            && Thresh->GetOutsideCount() == Reference->GetOutsideCount()
+            && nearlyEqual(Thresh->GetInsideMean(), Reference->GetInsideMean())
+            && nearlyEqual(Thresh->GetOutsideMean(), Reference->GetOutsideMean())
+            && nearlyEqual(Thresh->GetInsideVariance(), Reference->GetInsideVariance())
+            && nearlyEqual(Thresh->GetOutsideVariance(), Reference->GetOutsideVariance())
+            && Thresh->GetInsideBoundingBox() == Reference->GetInsideBoundingBox();
+          }
+        if (!same)
+          {
+          std::cout << "Background "
+                    << (mode < 2 ? "value " : "automatic ") << (mode < 2 ? backgrounds[mode] : 0)
+                    << ", " << threads[t] << " threads, statistics " << s
+                    << ": threshold " << Thresh->GetThreshold()
+                    << ", " << mismatches << " mismatches" << std::endl;
+          ok = false;
+          }
+        }
+      }
+    }
+
+  std::cout << "Li threshold: " << Reference->GetThreshold()
+            << (ok ? ", same with the background" : ", different with the background")
+            << std::endl;
+  return(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,64 @@
+#include "ioutils.h"
+
+#include "itkLiThresholdImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <itkSmartPointer.h>
+namespace itk
+{
+    template <typename T>
+    class Instance : public T::Pointer {
+    public:
+        Instance() : SmartPointer<T>( T::New() ) {}
+    };
+}
+
+
+
+// Threshold into a bit mask and check it against the standard output.
+int main(int argc, char * argv[])
+{
+  const unsigned dim = 3;
+  typedef itk::Image<unsigned char, dim> LabImType;
+  typedef itk::Image<float, dim> RawImType;
+
+  RawImType::Pointer raw = readIm<RawImType>(argv[1]);
+
+  typedef itk::LiThresholdImageFilter<RawImType, LabImType> FilterType;
+  itk::Instance <FilterType> Thresh;
+  Thresh->SetInput(raw);
+  Thresh->SetOutsideValue(1);
+  Thresh->SetInsideValue(0);
+  Thresh->Update();
+  LabImType::Pointer reference = Thresh->GetOutput();
+  reference->DisconnectPipeline();
+
+  itk::Instance <FilterType> BitThresh;
+  BitThresh->SetInput(raw);
+  BitThresh->SetOutsideValue(1);
+  BitThresh->SetInsideValue(0);
+  BitThresh->UseBitMaskOutputOn();
+  BitThresh->Update();
+  FilterType::BitMaskType * mask = BitThresh->GetBitMask();
+
+  LabImType::Pointer unpacked = mask->GetImage();
+  writeIm<LabImType>(unpacked, argv[2]);
+
+  unsigned long mismatches = 0;
+  itk::ImageRegionConstIterator<LabImType> refIt(reference, reference->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<LabImType> maskIt(unpacked, reference->GetLargestPossibleRegion());
+  for (; !refIt.IsAtEnd(); ++refIt, ++maskIt)
+    {
+    if (refIt.Get() != maskIt.Get())
+      {
+      mismatches++;
+      }
+    }
+
+  std::cout << "Li threshold: " << BitThresh->GetThreshold()
+            << " bit mask: " << mask->GetBufferSize() << " bytes, "
+            << mask->GetNumberOfSetBits() << " inside, "
+            << mismatches << " mismatches" << std::endl;
+
+  return(mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,90 @@
+#include "ioutils.h"
+
+#include "itkLiThresholdImageFilter.h"
+#include "itkImageRegionIterator.h"
+
+#include <itkSmartPointer.h>
+#include <cmath>
+namespace itk
+{
+    template <typename T>
+    class Instance : public T::Pointer {
+    public:
+        Instance() : SmartPointer<T>( T::New() ) {}
+    };
+}
+
+// Add a few hot pixels to the image and check that with a clipped
+// histogram range the Li threshold stays close to that of the clean
+// image, with the same number of bins.
+int main(int argc, char * argv[])
+{
+  const unsigned dim = 3;
+  typedef itk::Image<unsigned char, dim> LabImType;
+  typedef itk::Image<float, dim> RawImType;
+
+  RawImType::Pointer raw = readIm<RawImType>(argv[1]);
+
+  typedef itk::LiThresholdImageFilter<RawImType, LabImType> FilterType;
+  itk::Instance <FilterType> Clean;
+  Clean->SetInput(raw);
+  Clean->SetNumberOfHistogramBins(256);
+  Clean->Update();
+
+  RawImType::Pointer hot = RawImType::New();
+  hot->SetRegions(raw->GetLargestPossibleRegion());
+  hot->CopyInformation(raw);
+  hot->Allocate();
+  itk::ImageRegionConstIterator<RawImType> rit(raw, raw->GetLargestPossibleRegion());
+  itk::ImageRegionIterator<RawImType> hit(hot, raw->GetLargestPossibleRegion());
+  for (unsigned long i = 0; !rit.IsAtEnd(); ++rit, ++hit, ++i)
+    {
+    hit.Set(i % 5003 == 0 ? 100000.0f : rit.Get());
+    }
+
+  itk::Instance <FilterType> Unclipped;
+  Unclipped->SetInput(hot);
+  Unclipped->SetNumberOfHistogramBins(256);
+  Unclipped->Update();
+
+  itk::Instance <FilterType> Clipped;
+  Clipped->SetInput(hot);
+  Clipped->SetNumberOfHistogramBins(256);
+  Clipped->ClipHistogramRangeOn();
+  Clipped->SetOutsideValue(1);
+  Clipped->SetInsideValue(0);
+  writeIm<LabImType>(Clipped->GetOutput(), argv[2]);
+
+  std::cout << "Li threshold, clean: " << Clean->GetThreshold()
+            << " hot pixels: " << Unclipped->GetThreshold()
+            << " hot pixels, clipped range: " << Clipped->GetThreshold()
+            << std::endl;
+
+  // percentiles set the wrong way round are taken in order, and equal
+  // ones leave the range alone
+  itk::Instance <FilterType> Swapped;
+  Swapped->SetInput(hot);
+  Swapped->SetNumberOfHistogramBins(256);
+  Swapped->ClipHistogramRangeOn();
+  Swapped->SetLowerRangePercentile(Clipped->GetUpperRangePercentile());
+  Swapped->SetUpperRangePercentile(Clipped->GetLowerRangePercentile());
+  Swapped->Update();
+
+  itk::Instance <FilterType> Equal;
+  Equal->SetInput(hot);
+  Equal->SetNumberOfHistogramBins(256);
+  Equal->ClipHistogramRangeOn();
+  Equal->SetLowerRangePercentile(0.5);
+  Equal->SetUpperRangePercentile(0.5);
+  Equal->Update();
+
+  std::cout << "swapped percentiles: " << Swapped->GetThreshold()
+            << " equal percentiles: " << Equal->GetThreshold() << std::endl;
+
+  // the image is 8 bit, so the bins of the clean histogram are about
+  // one grey level wide: accept a few of them
+  bool ok = std::fabs(Clipped->GetThreshold() - Clean->GetThreshold()) <= 4.0
+    && Swapped->GetThreshold() == Clipped->GetThreshold()
+    && Equal->GetThreshold() == Unclipped->GetThreshold();
+  return(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,123 @@
+#include "ioutils.h"
+
+#include "itkLiThresholdImageFilter.h"
+#include "itkMinimumMaximumImageCalculator.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <itkSmartPointer.h>
+namespace itk
+{
+    template <typename T>
+    class Instance : public T::Pointer {
+    public:
+        Instance() : SmartPointer<T>( T::New() ) {}
+    };
+}
+
+// Give the range of the image to the filter, so that it doesn't
+// compute it, and check that the threshold is unchanged. Then give a
+// range narrower than the image, and check that the pixels outside it
+// are counted in the edge bins, or left out with ClampToHistogramRange
+// off, and that an empty range falls back to the range of the image.
+int main(int argc, char * argv[])
+{
+  const unsigned dim = 3;
+  typedef itk::Image<unsigned char, dim> LabImType;
+  typedef itk::Image<float, dim> RawImType;
+
+  RawImType::Pointer raw = readIm<RawImType>(argv[1]);
+
+  typedef itk::MinimumMaximumImageCalculator<RawImType> RangeType;
+  itk::Instance <RangeType> Range;
+  Range->SetImage(raw);
+  Range->Compute();
+
+  typedef itk::LiThresholdImageFilter<RawImType, LabImType> FilterType;
+  itk::Instance <FilterType> Computed;
+  Computed->SetInput(raw);
+  Computed->Update();
+
+  itk::Instance <FilterType> Fixed;
+  Fixed->SetInput(raw);
+  Fixed->SetHistogramRange(Range->GetMinimum(), Range->GetMaximum());
+  Fixed->SetOutsideValue(1);
+  Fixed->SetInsideValue(0);
+  writeIm<LabImType>(Fixed->GetOutput(), argv[2]);
+
+  std::cout << "Li threshold: " << Computed->GetThreshold()
+            << " with the range [" << Range->GetMinimum() << ", "
+            << Range->GetMaximum() << "] given: " << Fixed->GetThreshold()
+            << std::endl;
+  bool ok = Fixed->GetThreshold() == Computed->GetThreshold();
+
+  // the middle half of the range
+  const float quarter = ( Range->GetMaximum() - Range->GetMinimum() ) / 4;
+  const float lower = Range->GetMinimum() + quarter;
+  const float upper = Range->GetMaximum() - quarter;
+  double below = 0, above = 0;
+  itk::ImageRegionConstIterator<RawImType> it(raw, raw->GetLargestPossibleRegion());
+  for (; !it.IsAtEnd(); ++it)
+    {
+    below += ( it.Get() < lower );
+    above += ( it.Get() > upper );
+    }
+
+  typedef FilterType::CalculatorType::HistogramType HistogramType;
+  itk::Instance <FilterType> Clamped;
+  Clamped->SetInput(raw);
+  Clamped->SetHistogramRange(lower, upper);
+  Clamped->Update();
+  HistogramType clamped;
+  Clamped->GetCalculator()->ComputeHistogram(raw, raw->GetLargestPossibleRegion(), clamped);
+
+  itk::Instance <FilterType> Dropped;
+  Dropped->SetInput(raw);
+  Dropped->SetHistogramRange(lower, upper);
+  Dropped->ClampToHistogramRangeOff();
+  Dropped->Update();
+  HistogramType dropped;
+  Dropped->GetCalculator()->ComputeHistogram(raw, raw->GetLargestPossibleRegion(), dropped);
+
+  // both span the given range, and only differ by the pixels outside
+  // it, in the edge bins
+  const unsigned long last = clamped.GetSize() - 1;
+  bool edges = clamped.GetMinimum() == lower && clamped.GetMaximum() == upper
+    && dropped.GetMinimum() == lower && dropped.GetMaximum() == upper
+    && clamped.GetSize() == dropped.GetSize()
+    && clamped.GetTotalFrequency() == raw->GetLargestPossibleRegion().GetNumberOfPixels()
+    && dropped.GetTotalFrequency() == clamped.GetTotalFrequency() - below - above
+    && clamped.GetFrequencies()[0] - dropped.GetFrequencies()[0] == below
+    && clamped.GetFrequencies()[last] - dropped.GetFrequencies()[last] == above;
+  for (unsigned long i = 1; i < last; i++)
+    {
+    edges = edges && clamped.GetFrequencies()[i] == dropped.GetFrequencies()[i];
+    }
+  std::cout << "Range [" << lower << ", " << upper << "]: " << below << " pixels below, "
+            << above << " above, " << ( edges ? "in the edge bins" : "miscounted" )
+            << std::endl;
+  ok = ok && edges && below > 0 && above > 0;
+
+  // the thresholds are those of the histograms, and leaving out the
+  // pixels outside the range moves it
+  const FilterType::CalculatorType * calculator = Clamped->GetCalculator();
+  std::cout << "Li threshold, pixels outside in the edge bins: " << Clamped->GetThreshold()
+            << ", left out: " << Dropped->GetThreshold() << std::endl;
+  ok = ok && Clamped->GetThreshold() == calculator->ComputeThreshold(clamped).Threshold
+    && Dropped->GetThreshold() == calculator->ComputeThreshold(dropped).Threshold
+    && Clamped->GetThreshold() != Dropped->GetThreshold();
+
+  // an empty range is that of the image
+  itk::Instance <FilterType> Empty;
+  Empty->SetInput(raw);
+  Empty->SetHistogramRange(upper, lower);
+  Empty->Update();
+  const FilterType::InputPixelType empty = Empty->GetThreshold();
+  Empty->SetHistogramRange(lower, lower);
+  Empty->Update();
+  std::cout << "Li threshold, empty ranges: " << empty << ", "
+            << Empty->GetThreshold() << std::endl;
+  ok = ok && empty == Computed->GetThreshold()
+    && Empty->GetThreshold() == Computed->GetThreshold();
+
+  return(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
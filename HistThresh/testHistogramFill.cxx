@@ -0,0 +1,126 @@
+#include "ioutils.h"
+
+#include "itkLiThresholdImageCalculator.h"
+#include "itkImageRegionIterator.h"
+
+#include <vector>
+#include <cmath>
+
+using itk::ThresholdHistogramFill::KernelType;
+using itk::ThresholdHistogramFill::MaximumKernel;
+
+const unsigned dim = 3;
+typedef itk::Image<float, dim> RawImType;
+
+// An image of long runs of a few values, half of it a background of
+// 0, or the image with noise added so that hardly two neighbours are
+// equal.
+template <class TPixel>
+typename itk::Image<TPixel, dim>::Pointer makeImage(RawImType * raw, bool runs, double scale, double offset)
+{
+  typedef itk::Image<TPixel, dim> ImageType;
+  typename ImageType::Pointer image = ImageType::New();
+  image->SetRegions(raw->GetLargestPossibleRegion());
+  image->Allocate();
+
+  itk::ImageRegionConstIterator<RawImType> rit(raw, raw->GetLargestPossibleRegion());
+  itk::ImageRegionIterator<ImageType> it(image, raw->GetLargestPossibleRegion());
+  const unsigned long width = raw->GetLargestPossibleRegion().GetSize(0);
+  unsigned long seed = 12345;
+  for (unsigned long i = 0; !it.IsAtEnd(); ++it, ++rit, ++i)
+    {
+    const unsigned long x = i % width, y = i / width;
+    double value;
+    if (runs)
+      {
+      value = ( y % 2 == 0 || x < width / 2 ) ? 0 : ( ( x / ( 1 + y % 97 ) ) * 37 ) % 251;
+      }
+    else
+      {
+      seed = seed * 1103515245UL + 12345UL;
+      value = rit.Get() + ( ( seed >> 16 ) % 1000 ) / 1000.0;
+      }
+    it.Set(static_cast<TPixel>(value * scale + offset));
+    }
+  return image;
+}
+
+// Check that every kernel the processor supports fills the same
+// histogram as binning every pixel one at a time, with and without the
+// background blocks.
+template <class TPixel>
+bool checkFill(const char * name, typename itk::Image<TPixel, dim>::Pointer image,
+               TPixel background)
+{
+  typedef itk::Image<TPixel, dim> ImageType;
+  typedef itk::LiThresholdImageCalculator<ImageType> CalculatorType;
+  typedef typename CalculatorType::HistogramType HistogramType;
+
+  MaximumKernel() = itk::ThresholdHistogramFill::AVX512;
+  const KernelType widest = itk::ThresholdHistogramFill::GetKernel();
+
+  bool ok = true;
+  for (int blocks = 0; blocks < 2; blocks++)
+    {
+    for (int kernel = itk::ThresholdHistogramFill::Scalar; kernel <= widest; kernel++)
+      {
+      MaximumKernel() = static_cast<KernelType>(kernel);
+      typename CalculatorType::Pointer calc = CalculatorType::New();
+      calc->SetNumberOfHistogramBins(256);
+      calc->SetUseBackgroundValue(blocks);
+      calc->SetBackgroundValue(background);
+
+      HistogramType histogram;
+      calc->ComputeHistogram(image, image->GetLargestPossibleRegion(), histogram);
+
+      const TPixel imageMin = histogram.GetMinimum();
+      const double binMultiplier = histogram.GetBinMultiplier();
+      std::vector<double> reference(histogram.GetSize(), 0.0);
+      itk::ImageRegionConstIterator<ImageType> it(image, image->GetLargestPossibleRegion());
+      for (; !it.IsAtEnd(); ++it)
+        {
+        const TPixel value = it.Get();
+        double bin = 0;
+        if (value > imageMin)
+          {
+          bin = std::min(std::ceil((value - imageMin) * binMultiplier) - 1,
+                         (double)histogram.GetSize() - 1);
+          }
+        reference[(unsigned long)bin] += 1.0;
+        }
+
+      if (histogram.GetFrequencies() != reference)
+        {
+        std::cerr << name << ": the histogram of kernel " << kernel
+                  << (blocks ? " with background blocks" : "")
+                  << " differs from that of the pixels one at a time" << std::endl;
+        ok = false;
+        }
+      }
+    }
+  MaximumKernel() = itk::ThresholdHistogramFill::AVX512;
+  std::cout << name << ": kernels up to " << widest << (ok ? " agree" : " differ")
+            << std::endl;
+  return ok;
+}
+
+int main(int argc, char * argv[])
+{
+  RawImType::Pointer raw = readIm<RawImType>(argv[1]);
+
+  bool ok = true;
+  for (int runs = 0; runs < 2; runs++)
+    {
+    const char * kind = runs ? "runs" : "diverse";
+    std::string name;
+    name = std::string("float, ") + kind;
+    ok = checkFill<float>(name.c_str(), makeImage<float>(raw, runs, 1.37, -10), -10) && ok;
+    name = std::string("double, ") + kind;
+    ok = checkFill<double>(name.c_str(), makeImage<double>(raw, runs, 1.37, -10), -10) && ok;
+    name = std::string("short, ") + kind;
+    ok = checkFill<short>(name.c_str(), makeImage<short>(raw, runs, 100, -1000), -1000) && ok;
+    name = std::string("unsigned char, ") + kind;
+    ok = checkFill<unsigned char>(name.c_str(), makeImage<unsigned char>(raw, runs, 1, 0), 0) && ok;
+    }
+  return(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,122 @@
+#include "ioutils.h"
+
+#include "itkLiThresholdImageCalculator.h"
+
+#include <itkSmartPointer.h>
+#include <fstream>
+#include <cmath>
+namespace itk
+{
+    template <typename T>
+    class Instance : public T::Pointer {
+    public:
+        Instance() : SmartPointer<T>( T::New() ) {}
+    };
+}
+
+
+
+// Threshold an image from the histograms of its two halves, saved to
+// files and merged, as a distributed run would.
+int main(int argc, char * argv[])
+{
+  const unsigned dim = 3;
+  typedef itk::Image<float, dim> RawImType;
+  typedef itk::LiThresholdImageCalculator<RawImType> CalculatorType;
+  typedef CalculatorType::HistogramType HistogramType;
+
+  RawImType::Pointer raw = readIm<RawImType>(argv[1]);
+
+  RawImType::RegionType whole = raw->GetLargestPossibleRegion();
+  RawImType::RegionType top = whole, bottom = whole;
+  top.SetSize(1, whole.GetSize(1) / 2);
+  bottom.SetIndex(1, whole.GetIndex(1) + top.GetSize(1));
+  bottom.SetSize(1, whole.GetSize(1) - top.GetSize(1));
+
+  itk::Instance <CalculatorType> Calc;
+  HistogramType range;
+  Calc->ComputeHistogram(raw, whole, range);
+  const double binWidth = ( (double)range.GetMaximum() - (double)range.GetMinimum() )
+    / Calc->GetNumberOfHistogramBins();
+
+  const char * modes[] = { "Binned", "Sparse", "Exact" };
+  int status = EXIT_SUCCESS;
+  for (int mode = 0; mode < 3; mode++)
+    {
+    // each half on its own range, then on the range of the image
+    for (int shared = 0; shared < 2; shared++)
+      {
+      if (mode == 2 && shared)
+        {
+        continue;
+        }
+      Calc->SetUseSparseHistogram(mode == 1);
+      Calc->SetUseExactHistogram(mode == 2);
+      Calc->SetUseFixedHistogramRange(shared);
+      if (shared)
+        {
+        Calc->SetHistogramRange(range.GetMinimum(), range.GetMaximum());
+        }
+
+      HistogramType part;
+      Calc->ComputeHistogram(raw, top, part);
+      part.Write(argv[2]);
+      Calc->ComputeHistogram(raw, bottom, part);
+      part.Write(argv[3]);
+
+      HistogramType merged, other;
+      merged.Read(argv[2]);
+      other.Read(argv[3]);
+      merged.Merge(other);
+
+      float full = Calc->ComputeThreshold(raw, whole).Threshold;
+      float fromParts = Calc->ComputeThreshold(merged).Threshold;
+      std::cout << modes[mode] << (shared ? ", shared range," : "")
+                << " Li threshold: " << full
+                << " from merged histograms: " << fromParts
+                << " (" << merged.GetTotalFrequency() << " voxels)" << std::endl;
+
+      if (std::fabs(merged.GetTotalFrequency() - whole.GetNumberOfPixels()) > 1e-6 * whole.GetNumberOfPixels())
+        {
+        status = EXIT_FAILURE;
+        }
+      // exact histograms, and binned ones on the same bins, merge
+      // without loss. Rebinning spreads counts over neighbouring bins.
+      if (mode == 2 || shared)
+        {
+        if (full != fromParts)
+          {
+          status = EXIT_FAILURE;
+          }
+        }
+      else if (std::fabs(full - fromParts) > 2 * binWidth)
+        {
+        status = EXIT_FAILURE;
+        }
+      }
+    }
+
+  // a header claiming more entries than the file holds is refused
+  // before anything is allocated
+  {
+  std::ofstream bad(argv[2], std::ios::out | std::ios::binary);
+  unsigned int header[2] = { 1, 2 };
+  double counts[5] = { 0, 1, 128, 1e15, 0 };
+  bad.write("ITKTHIST", 8);
+  bad.write(reinterpret_cast<const char *>(header), sizeof(header));
+  bad.write(reinterpret_cast<const char *>(counts), sizeof(counts));
+  }
+  try
+    {
+    HistogramType corrupt;
+    corrupt.Read(argv[2]);
+    std::cerr << "A corrupt histogram file was read" << std::endl;
+    status = EXIT_FAILURE;
+    }
+  catch(itk::ExceptionObject &ex)
+    {
+    std::cout << "Corrupt file refused: " << ex.GetDescription() << std::endl;
+    }
+
+  return(status);
+}
@@ -0,0 +1,191 @@
+#include "ioutils.h"
+
+#include "itkHuangThresholdImageCalculator.h"
+#include "itkIntermodesThresholdImageCalculator.h"
+#include "itkIsoDataThresholdImageCalculator.h"
+#include "itkKittlerIllingworthThresholdImageCalculator.h"
+#include "itkLiThresholdImageCalculator.h"
+#include "itkMaxEntropyThresholdImageCalculator.h"
+#include "itkMomentsThresholdImageCalculator.h"
+#include "itkRenyiEntropyThresholdImageCalculator.h"
+#include "itkShanbhagThresholdImageCalculator.h"
+#include "itkTriangleThresholdImageCalculator.h"
+#include "itkYenThresholdImageCalculator.h"
+#include "itkMeanThresholdImageCalculator.h"
+#include "itkIJOtsuThresholdImageCalculator.h"
+#include "itkPercentileThresholdImageCalculator.h"
+#include "itkIJIsoDataThresholdImageCalculator.h"
+#include "itkImageRegionIterator.h"
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+const unsigned dim = 3;
+typedef itk::Image<float, dim> RawImType;
+typedef itk::Image<short, dim> ImType;
+
+// The image quantized to Levels values, Step apart. A few of the levels
+// are left empty, so that the sparse histogram has gaps.
+const unsigned long Levels = 64;
+const short Base = 100;
+const short Step = 7;
+
+ImType::Pointer quantize(RawImType * raw)
+{
+  ImType::Pointer image = ImType::New();
+  image->SetRegions(raw->GetLargestPossibleRegion());
+  image->Allocate();
+
+  itk::ImageRegionConstIterator<RawImType> rit(raw, raw->GetLargestPossibleRegion());
+  itk::ImageRegionIterator<ImType> it(image, raw->GetLargestPossibleRegion());
+  float minimum = rit.Get(), maximum = rit.Get();
+  for (; !rit.IsAtEnd(); ++rit)
+    {
+    minimum = std::min(minimum, rit.Get());
+    maximum = std::max(maximum, rit.Get());
+    }
+  for (rit.GoToBegin(); !it.IsAtEnd(); ++it, ++rit)
+    {
+    unsigned long level = static_cast<unsigned long>(
+      ( rit.Get() - minimum ) / ( maximum - minimum ) * ( Levels - 1 ) + 0.5 );
+    if (level % 9 == 4)
+      {
+      level--;
+      }
+    it.Set(static_cast<short>(Base + Step * level));
+    }
+  // both ends of the range are occupied
+  image->GetBufferPointer()[0] = Base;
+  image->GetBufferPointer()[1] = Base + Step * ( Levels - 1 );
+  return image;
+}
+
+// Index, among the sorted distinct values of the image, of the largest
+// value at or below t.
+long valueIndex(const std::vector<short> & values, short t)
+{
+  return std::upper_bound(values.begin(), values.end(), t) - values.begin() - 1;
+}
+
+// Threshold the quantized image in the three histogram modes. The dense
+// and sparse histograms have one bin per level, so the sparse one must
+// give the same threshold. The exact histogram has one entry per
+// occupied level, at the position of its bin, so it must give one of
+// the values of the image rather than a bin edge, and split the levels
+// within levelTolerance of where the dense histogram splits them. The
+// criteria evaluated at a position keep the level at that position in
+// exact mode, whereas the bin at that position is above the dense
+// threshold, hence a tolerance of one level.
+template <class TCalculator>
+bool checkModes(const char * name, TCalculator * calc, const ImType * image,
+                const std::vector<short> & values, long levelTolerance)
+{
+  const ImType::RegionType region = image->GetLargestPossibleRegion();
+
+  calc->SetNumberOfHistogramBins(Levels);
+  const short dense = calc->ComputeThreshold(image, region).Threshold;
+  calc->UseSparseHistogramOn();
+  const short sparse = calc->ComputeThreshold(image, region).Threshold;
+  calc->UseSparseHistogramOff();
+  calc->UseExactHistogramOn();
+  calc->SetNumberOfHistogramBins(Levels - 1);
+  const short exact = calc->ComputeThreshold(image, region).Threshold;
+
+  const long exactIndex = valueIndex(values, exact);
+  const bool isValue = exactIndex >= 0 && values[exactIndex] == exact;
+  const long shift = exactIndex - valueIndex(values, dense);
+
+  std::cout << name << ": dense " << dense << ", sparse " << sparse
+            << ", exact " << exact << " (" << shift << " levels)" << std::endl;
+
+  bool ok = true;
+  if (dense != sparse)
+    {
+    std::cerr << name << ": the sparse threshold differs from the dense one" << std::endl;
+    ok = false;
+    }
+  if (!isValue)
+    {
+    std::cerr << name << ": the exact threshold is not a value of the image" << std::endl;
+    ok = false;
+    }
+  if (std::abs(shift) > levelTolerance)
+    {
+    std::cerr << name << ": the exact threshold is " << shift
+              << " levels from the dense one" << std::endl;
+    ok = false;
+    }
+  return ok;
+}
+
+template <class TCalculator>
+bool checkMethod(const char * name, const ImType * image,
+                 const std::vector<short> & values, long levelTolerance)
+{
+  typename TCalculator::Pointer calc = TCalculator::New();
+  return checkModes(name, calc.GetPointer(), image, values, levelTolerance);
+}
+
+bool checkMinimum(const char * name, const ImType * image,
+                  const std::vector<short> & values, long levelTolerance)
+{
+  itk::IntermodesThresholdImageCalculator<ImType>::Pointer calc =
+    itk::IntermodesThresholdImageCalculator<ImType>::New();
+  calc->SetUseInterMode(false);
+  return checkModes(name, calc.GetPointer(), image, values, levelTolerance);
+}
+
+typedef bool (*CheckFunctionType)(const char *, const ImType *,
+                                  const std::vector<short> &, long);
+
+struct MethodEntry
+{
+  const char *      Name;
+  CheckFunctionType Check;
+  long              LevelTolerance;
+};
+
+// Triangle draws its line over every bin, the empty ones too, which an
+// exact histogram doesn't have, so its exact threshold is only checked
+// to be a value of the image.
+const MethodEntry Methods[] = {
+  { "Huang", &checkMethod<itk::HuangThresholdImageCalculator<ImType> >, 1 },
+  { "Intermodes", &checkMethod<itk::IntermodesThresholdImageCalculator<ImType> >, 1 },
+  { "Minimum", &checkMinimum, 1 },
+  { "IsoData", &checkMethod<itk::IsoDataThresholdImageCalculator<ImType> >, 1 },
+  { "KittlerIllingworth", &checkMethod<itk::KittlerIllingworthThresholdImageCalculator<ImType> >, 1 },
+  { "Li", &checkMethod<itk::LiThresholdImageCalculator<ImType> >, 1 },
+  { "MaxEntropy", &checkMethod<itk::MaxEntropyThresholdImageCalculator<ImType> >, 1 },
+  { "Moments", &checkMethod<itk::MomentsThresholdImageCalculator<ImType> >, 1 },
+  { "RenyiEntropy", &checkMethod<itk::RenyiEntropyThresholdImageCalculator<ImType> >, 1 },
+  { "Shanbhag", &checkMethod<itk::ShanbhagThresholdImageCalculator<ImType> >, 1 },
+  { "Triangle", &checkMethod<itk::TriangleThresholdImageCalculator<ImType> >, Levels },
+  { "Yen", &checkMethod<itk::YenThresholdImageCalculator<ImType> >, 1 },
+  { "Mean", &checkMethod<itk::MeanThresholdImageCalculator<ImType> >, 1 },
+  { "IJOtsu", &checkMethod<itk::IJOtsuThresholdImageCalculator<ImType> >, 1 },
+  { "Percentile", &checkMethod<itk::PercentileThresholdImageCalculator<ImType> >, 1 },
+  { "IJIsoData", &checkMethod<itk::IJIsoDataThresholdImageCalculator<ImType> >, 1 }
+};
+
+int main(int argc, char * argv[])
+{
+  RawImType::Pointer raw = readIm<RawImType>(argv[1]);
+  ImType::Pointer image = quantize(raw);
+
+  std::set<short> distinct;
+  itk::ImageRegionConstIterator<ImType> it(image, image->GetLargestPossibleRegion());
+  for (; !it.IsAtEnd(); ++it)
+    {
+    distinct.insert(it.Get());
+    }
+  const std::vector<short> values(distinct.begin(), distinct.end());
+
+  bool ok = true;
+  for (unsigned i = 0; i < sizeof(Methods) / sizeof(Methods[0]); i++)
+    {
+    ok = Methods[i].Check(Methods[i].Name, image, values, Methods[i].LevelTolerance) && ok;
+    }
+
+  return(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,73 @@
+#include "ioutils.h"
+#include "morphutils.h"
+
+#include "itkImageRegionConstIterator.h"
+
+// The MM helpers with their default box must give the output of the
+// box structuring element they used before taking a number of lines,
+// a polygon must run, and a polygon that can't be built must be
+// refused.
+int main(int argc, char * argv[])
+{
+  const unsigned dim = 3;
+  typedef itk::Image<unsigned char, dim> ImType;
+  typedef itk::FlatStructuringElement<dim> SRType;
+
+  ImType::Pointer raw = readIm<ImType>(argv[1]);
+
+  typedef itk::GrayscaleMorphologicalOpeningImageFilter<ImType, ImType, SRType> OpeningType;
+  OpeningType::Pointer opening = OpeningType::New();
+  opening->SetInput(raw);
+  opening->SetKernel(SRType::Box(getRadius<ImType>(2, 2, 0, raw->GetSpacing())));
+  opening->SetAlgorithm(OpeningType::VHGW);
+  opening->Update();
+
+  ImType::Pointer boxed = doOpeningMM<ImType>(raw, 2, 2, 0);
+
+  unsigned long mismatches = 0;
+  itk::ImageRegionConstIterator<ImType> oIt(opening->GetOutput(), raw->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<ImType> bIt(boxed, raw->GetLargestPossibleRegion());
+  for (; !oIt.IsAtEnd(); ++oIt, ++bIt)
+    {
+    if (oIt.Get() != bIt.Get())
+      {
+      mismatches++;
+      }
+    }
+
+  // an opening never brightens a pixel
+  typedef itk::Image<unsigned char, 2> PlaneType;
+  PlaneType::Pointer plane = readIm<PlaneType>(argv[1]);
+  PlaneType::Pointer poly = doOpeningMM<PlaneType>(plane, 2, 2, 0, 4);
+  writeIm<PlaneType>(poly, argv[2]);
+  unsigned long brighter = 0;
+  itk::ImageRegionConstIterator<PlaneType> pIt(plane, plane->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<PlaneType> qIt(poly, plane->GetLargestPossibleRegion());
+  for (; !pIt.IsAtEnd(); ++pIt, ++qIt)
+    {
+    if (qIt.Get() > pIt.Get())
+      {
+      brighter++;
+      }
+    }
+
+  typedef itk::Image<unsigned char, 4> VolumesType;
+  VolumesType::SizeType rad;
+  rad.Fill(1);
+  bool refused = false;
+  try
+    {
+    getKernel<VolumesType>(rad, 4);
+    }
+  catch(itk::ExceptionObject &ex)
+    {
+    std::cout << ex << std::endl;
+    refused = true;
+    }
+
+  std::cout << "box: " << mismatches << " mismatches, polygon: "
+            << brighter << " pixels brightened, 4D polygon "
+            << (refused ? "refused" : "accepted") << std::endl;
+
+  return(mismatches == 0 && brighter == 0 && refused ? EXIT_SUCCESS : EXIT_FAILURE);
+}
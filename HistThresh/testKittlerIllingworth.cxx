@@ -1,6 +1,10 @@
 #include "ioutils.h"
 
 #include "itkKittlerIllingworthThresholdImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <cmath>
+#include <set>
 
 #include <itkSmartPointer.h>
 namespace itk
@@ -12,12 +16,83 @@ namespace itk
     };
 }
 
+const unsigned dim = 3;
+typedef itk::Image<short, dim> ShortImType;
+
+// A broad class around 1100 and a small one around 1940, on which the
+// iteration stops on an imaginary threshold.
+ShortImType::Pointer makeDiverging()
+{
+  ShortImType::Pointer image = ShortImType::New();
+  ShortImType::SizeType size;
+  size[0] = 100;
+  size[1] = 100;
+  size[2] = 1;
+  image->SetRegions(size);
+  image->Allocate();
+
+  unsigned long seed = 2;
+  short * buffer = image->GetBufferPointer();
+  for (unsigned long i = 0; i < 10000; i++)
+    {
+    double u[2];
+    for (unsigned k = 0; k < 2; k++)
+      {
+      seed = seed * 1103515245UL + 12345UL;
+      u[k] = ( ( seed >> 16 ) % 10000 + 0.5 ) / 10000.0;
+      }
+    double value;
+    if (i % 100 < 3)
+      {
+      value = 1850 + 175 * u[0];
+      }
+    else if (i % 100 < 50)
+      {
+      value = 1075 + 60 * std::sqrt(-2 * std::log(u[0])) * std::cos(6.2831853 * u[1]);
+      }
+    else
+      {
+      value = 950 + 330 * u[0];
+      }
+    buffer[i] = static_cast<short>(value);
+    }
+  return image;
+}
 
+// The threshold found when the iteration doesn't converge is still a
+// pixel value of the image, one of its values with the exact histogram.
+bool checkDiverging()
+{
+  ShortImType::Pointer image = makeDiverging();
+  std::set<short> values;
+  itk::ImageRegionConstIterator<ShortImType> it(image, image->GetLargestPossibleRegion());
+  for (; !it.IsAtEnd(); ++it)
+    {
+    values.insert(it.Get());
+    }
 
+  typedef itk::KittlerIllingworthThresholdImageCalculator<ShortImType> CalculatorType;
+  bool ok = true;
+  for (int exact = 0; exact < 2; exact++)
+    {
+    CalculatorType::Pointer calc = CalculatorType::New();
+    calc->SetImage(image);
+    calc->SetUseExactHistogram(exact);
+    calc->Compute();
+    const short threshold = calc->GetThreshold();
+    const bool inRange = *values.begin() <= threshold && threshold <= *values.rbegin();
+    const bool isValue = values.count(threshold) > 0;
+    std::cout << "KittlerIllingworth threshold, not converging"
+              << (exact ? ", exact histogram: " : ": ") << threshold
+              << " in [" << *values.begin() << ", " << *values.rbegin() << "]"
+              << std::endl;
+    ok = ok && inRange && ( !exact || isValue );
+    }
+  return ok;
+}
 
 int main(int argc, char * argv[])
 {
-  const unsigned dim = 3;
   typedef itk::Image<unsigned char, dim> LabImType;
   typedef itk::Image<float, dim> RawImType;
 
@@ -31,8 +106,7 @@ int main(int argc, char * argv[])
 
   writeIm<LabImType>(Thr->GetOutput(), argv[2]);
   std::cout << "KittlerIllingworth threshold: " << (float)Thr->GetThreshold() << std::endl;
-  
 
-  return(EXIT_SUCCESS);
+  return(checkDiverging() ? EXIT_SUCCESS : EXIT_FAILURE);
 }
 
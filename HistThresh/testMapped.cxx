@@ -0,0 +1,54 @@
+#include "mappedio.h"
+
+#include "itkLiThresholdImageFilter.h"
+
+#include <itkSmartPointer.h>
+namespace itk
+{
+    template <typename T>
+    class Instance : public T::Pointer {
+    public:
+        Instance() : SmartPointer<T>( T::New() ) {}
+    };
+}
+
+// Write the image as a MetaImage header and raw file, map it, and
+// check that the Li threshold of the mapped pixels is that of the
+// pixels read from the file.
+int main(int argc, char * argv[])
+{
+  const unsigned dim = 3;
+  typedef itk::Image<unsigned char, dim> LabImType;
+  typedef itk::Image<float, dim> RawImType;
+  typedef itk::MappedImageContainer<RawImType::PixelContainer::ElementIdentifier,
+                                    RawImType::PixelType> ContainerType;
+
+  RawImType::Pointer raw = readIm<RawImType>(argv[1]);
+  writeIm<RawImType>(raw, argv[2]);
+
+  RawImType::Pointer mapped = readImMapped<RawImType>(argv[2]);
+  if (!dynamic_cast<ContainerType *>(mapped->GetPixelContainer()))
+    {
+    std::cerr << argv[2] << " was read, not mapped" << std::endl;
+    return(EXIT_FAILURE);
+    }
+
+  typedef itk::LiThresholdImageFilter<RawImType, LabImType> FilterType;
+  itk::Instance <FilterType> Read;
+  Read->SetInput(readIm<RawImType>(argv[2]));
+  Read->SetNumberOfHistogramBins(256);
+  Read->Update();
+
+  itk::Instance <FilterType> Mapped;
+  Mapped->SetInput(mapped);
+  Mapped->SetNumberOfHistogramBins(256);
+  Mapped->SetOutsideValue(1);
+  Mapped->SetInsideValue(0);
+  writeIm<LabImType>(Mapped->GetOutput(), argv[3]);
+
+  std::cout << "Li threshold, read: " << Read->GetThreshold()
+            << " mapped: " << Mapped->GetThreshold() << std::endl;
+
+  bool ok = Mapped->GetThreshold() == Read->GetThreshold();
+  return(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,129 @@
+#include "ioutils.h"
+
+#include "itkMultiThresholdImageFilter.h"
+#include "itkMaxEntropyThresholdImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <itkSmartPointer.h>
+namespace itk
+{
+    template <typename T>
+    class Instance : public T::Pointer {
+    public:
+        Instance() : SmartPointer<T>( T::New() ) {}
+    };
+}
+
+template <class TFilter>
+bool increasing(const TFilter * filter)
+{
+  for (unsigned i = 1; i < filter->GetThresholds().size(); i++)
+    {
+    if ( !( filter->GetThresholds()[i - 1] < filter->GetThresholds()[i] ) )
+      {
+      std::cerr << "Thresholds don't increase" << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+int main(int argc, char * argv[])
+{
+  const unsigned dim = 3;
+  typedef itk::Image<unsigned char, dim> LabImType;
+  typedef itk::Image<float, dim> RawImType;
+
+  RawImType::Pointer raw = readIm<RawImType>(argv[1]);
+
+  typedef itk::MultiThresholdImageFilter<RawImType, LabImType > FilterType;
+  itk::Instance <FilterType> Thr;
+  Thr->SetInput(raw);
+  Thr->SetNumberOfThresholds(3);
+  Thr->SetLabelOffset(1);
+
+  writeIm<LabImType>(Thr->GetOutput(), argv[2]);
+  std::cout << "MaxEntropy thresholds:";
+  for (unsigned i = 0; i < Thr->GetThresholds().size(); i++)
+    std::cout << " " << (float)Thr->GetThresholds()[i];
+  std::cout << std::endl;
+
+  Thr->SetCriterion(FilterType::CalculatorType::Li);
+  writeIm<LabImType>(Thr->GetOutput(), argv[3]);
+  std::cout << "Li thresholds:";
+  for (unsigned i = 0; i < Thr->GetThresholds().size(); i++)
+    std::cout << " " << (float)Thr->GetThresholds()[i];
+  std::cout << std::endl;
+  bool ok = increasing<FilterType>(Thr);
+
+  // on the exact histogram every label is one of the classes found, so
+  // none of them is empty
+  Thr->SetCriterion(FilterType::CalculatorType::MaxEntropy);
+  Thr->UseExactHistogramOn();
+  Thr->SetLabelOffset(0);
+  Thr->Update();
+  std::cout << "MaxEntropy thresholds, exact histogram:";
+  for (unsigned i = 0; i < Thr->GetThresholds().size(); i++)
+    std::cout << " " << (float)Thr->GetThresholds()[i];
+  std::cout << std::endl;
+  ok = ok && increasing<FilterType>(Thr);
+  std::vector<unsigned long> counts(Thr->GetNumberOfThresholds() + 1, 0);
+  itk::ImageRegionConstIterator<LabImType> lit(Thr->GetOutput(),
+                                               Thr->GetOutput()->GetLargestPossibleRegion());
+  for (; !lit.IsAtEnd(); ++lit)
+    {
+    if (lit.Get() < counts.size())
+      counts[lit.Get()]++;
+    }
+  for (unsigned i = 0; i < counts.size(); i++)
+    {
+    if (counts[i] == 0)
+      {
+      std::cerr << "Label " << i << " is empty" << std::endl;
+      ok = false;
+      }
+    }
+
+  // a single MaxEntropy threshold is that of the MaxEntropy method
+  Thr->UseExactHistogramOff();
+  Thr->SetNumberOfThresholds(1);
+  Thr->SetNumberOfHistogramBins(128);
+  Thr->Update();
+  itk::Instance <itk::MaxEntropyThresholdImageFilter<RawImType, LabImType> > Single;
+  Single->SetInput(raw);
+  Single->SetNumberOfHistogramBins(128);
+  Single->Update();
+  std::cout << "MaxEntropy threshold: " << (float)Thr->GetThresholds()[0]
+            << " single threshold method: " << (float)Single->GetThreshold()
+            << std::endl;
+  ok = ok && Thr->GetThresholds()[0] == Single->GetThreshold();
+
+  // the histogram options reach the calculator: with a fixed range
+  // narrower than the image, the pixels outside it left out, and with a
+  // clipped range, it is still that of the MaxEntropy method
+  Thr->SetHistogramRange(20, 200);
+  Thr->ClampToHistogramRangeOff();
+  Thr->Update();
+  Single->SetHistogramRange(20, 200);
+  Single->ClampToHistogramRangeOff();
+  Single->Update();
+  std::cout << "MaxEntropy threshold in [20, 200]: " << (float)Thr->GetThresholds()[0]
+            << " single threshold method: " << (float)Single->GetThreshold()
+            << std::endl;
+  ok = ok && Thr->GetThresholds()[0] == Single->GetThreshold();
+
+  Thr->UseFixedHistogramRangeOff();
+  Thr->ClipHistogramRangeOn();
+  Thr->SetUpperRangePercentile(0.9);
+  Thr->Update();
+  Single->UseFixedHistogramRangeOff();
+  Single->ClipHistogramRangeOn();
+  Single->SetUpperRangePercentile(0.9);
+  Single->Update();
+  std::cout << "MaxEntropy threshold, clipped range: " << (float)Thr->GetThresholds()[0]
+            << " single threshold method: " << (float)Single->GetThreshold()
+            << std::endl;
+  ok = ok && Thr->GetThresholds()[0] == Single->GetThreshold();
+
+  return(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
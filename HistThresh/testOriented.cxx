@@ -0,0 +1,58 @@
+#include "ioutils.h"
+
+#include "itkLiThresholdImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <itkSmartPointer.h>
+namespace itk
+{
+    template <typename T>
+    class Instance : public T::Pointer {
+    public:
+        Instance() : SmartPointer<T>( T::New() ) {}
+    };
+}
+
+// Threshold the image as it lies in the file and reorient the mask,
+// and check that the threshold and mask are those of the reoriented
+// image.
+int main(int argc, char * argv[])
+{
+  const unsigned dim = 3;
+  typedef itk::Image<unsigned char, dim> LabImType;
+  typedef itk::Image<float, dim> RawImType;
+  const itk::SpatialOrientation::ValidCoordinateOrientationFlags direction =
+    itk::SpatialOrientation::ITK_COORDINATE_ORIENTATION_PIR;
+
+  typedef itk::LiThresholdImageFilter<RawImType, LabImType> FilterType;
+  itk::Instance <FilterType> Oriented;
+  Oriented->SetInput(readImOriented<RawImType>(argv[1], direction));
+  Oriented->SetNumberOfHistogramBins(256);
+  Oriented->SetOutsideValue(1);
+  Oriented->SetInsideValue(0);
+  Oriented->Update();
+
+  itk::Instance <FilterType> Native;
+  Native->SetNumberOfHistogramBins(256);
+  Native->SetOutsideValue(1);
+  Native->SetInsideValue(0);
+  LabImType::Pointer mask = thresholdImOriented<FilterType>(argv[1], direction, Native);
+  writeIm<LabImType>(mask, argv[2]);
+
+  std::cout << "Li threshold, reoriented image: " << Oriented->GetThreshold()
+            << " reoriented mask: " << Native->GetThreshold() << std::endl;
+
+  bool ok = Native->GetThreshold() == Oriented->GetThreshold() &&
+    mask->GetLargestPossibleRegion() == Oriented->GetOutput()->GetLargestPossibleRegion();
+  if (ok)
+    {
+    itk::ImageRegionConstIterator<LabImType> mit(mask, mask->GetLargestPossibleRegion());
+    itk::ImageRegionConstIterator<LabImType> oit(Oriented->GetOutput(),
+                                                 mask->GetLargestPossibleRegion());
+    for (; ok && !mit.IsAtEnd(); ++mit, ++oit)
+      {
+      ok = mit.Get() == oit.Get();
+      }
+    }
+  return(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,131 @@
+#include "ioutils.h"
+
+#include "itkLiThresholdImageFilter.h"
+#include "itkMaskQuantileImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+
+#include <itkSmartPointer.h>
+#include <algorithm>
+#include <cmath>
+namespace itk
+{
+    template <typename T>
+    class Instance : public T::Pointer {
+    public:
+        Instance() : SmartPointer<T>( T::New() ) {}
+    };
+}
+
+const unsigned dim = 3;
+typedef itk::Image<unsigned char, dim> LabImType;
+typedef itk::Image<float, dim> RawImType;
+
+// Quantiles of both classes, exact and from the sketch, checked
+// against those of the sorted values.
+template <class TImage>
+bool checkQuantiles(TImage * raw, LabImType * labels,
+                    const std::vector<double> & quantiles, const char * name)
+{
+  typedef typename TImage::PixelType PixelType;
+  typedef itk::MaskQuantileImageFilter<TImage, LabImType> QuantType;
+  itk::Instance <QuantType> Exact;
+  Exact->SetInput(raw);
+  Exact->SetLabelInput(labels);
+  Exact->SetQuantiles(quantiles);
+  Exact->Update();
+
+  itk::Instance <QuantType> Sketch;
+  Sketch->SetInput(raw);
+  Sketch->SetLabelInput(labels);
+  Sketch->SetQuantiles(quantiles);
+  Sketch->UseSketchOn();
+  Sketch->Update();
+
+  // the values of each class, sorted
+  std::vector<PixelType> values[2];
+  itk::ImageRegionConstIterator<TImage> rit(raw, raw->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<LabImType> lit(labels, raw->GetLargestPossibleRegion());
+  for (; !rit.IsAtEnd(); ++rit, ++lit)
+    {
+    values[lit.Get()].push_back(rit.Get());
+    }
+
+  bool ok = true;
+  const double accuracy = Sketch->GetRelativeAccuracy();
+  for (unsigned label = 0; label < 2; label++)
+    {
+    std::vector<PixelType> & v = values[label];
+    std::sort(v.begin(), v.end());
+    ok = ok && Exact->GetCount(label) == v.size();
+    if (v.empty())
+      {
+      continue;
+      }
+    std::vector<double> e = Exact->GetQuantiles(label);
+    std::vector<double> s = Sketch->GetQuantiles(label);
+    for (unsigned K = 0; K < quantiles.size(); K++)
+      {
+      const double position = quantiles[K] * (v.size() - 1);
+      const unsigned long low = (unsigned long)position;
+      const unsigned long high = std::min<unsigned long>(low + 1, v.size() - 1);
+      const double lowValue = v[low];
+      const double expected = lowValue + (position - low) * ((double)v[high] - lowValue);
+      ok = ok && std::fabs(e[K] - expected) <= 1e-6 * (1.0 + std::fabs(expected));
+
+      // the sketch value is near the value of rank low
+      ok = ok && std::fabs(s[K] - lowValue) <= accuracy * std::fabs(lowValue) + 1e-6;
+
+      std::cout << name << " label " << label << " quantile " << quantiles[K]
+                << ": " << e[K] << " sketch " << s[K] << std::endl;
+      }
+    }
+  return ok;
+}
+
+// The quantiles of the classes of the Li threshold, for float pixels,
+// for unsigned char pixels and for signed 16 bit pixels, the last two
+// counted in histograms.
+int main(int argc, char * argv[])
+{
+  RawImType::Pointer raw = readIm<RawImType>(argv[1]);
+
+  typedef itk::LiThresholdImageFilter<RawImType, LabImType> FilterType;
+  itk::Instance <FilterType> Thresh;
+  Thresh->SetInput(raw);
+  Thresh->SetOutsideValue(0);
+  Thresh->SetInsideValue(1);
+  Thresh->Update();
+  writeIm<LabImType>(Thresh->GetOutput(), argv[2]);
+
+  std::vector<double> quantiles;
+  quantiles.push_back(0.0);
+  quantiles.push_back(0.05);
+  quantiles.push_back(0.25);
+  quantiles.push_back(0.5);
+  quantiles.push_back(0.75);
+  quantiles.push_back(0.95);
+  quantiles.push_back(1.0);
+
+  typedef itk::Image<unsigned char, dim> ByteImType;
+  ByteImType::Pointer bytes = readIm<ByteImType>(argv[1]);
+
+  // spread over negative and positive values, as for CT
+  typedef itk::Image<short, dim> ShortImType;
+  ShortImType::Pointer shorts = ShortImType::New();
+  shorts->CopyInformation(raw.GetPointer());
+  shorts->SetRegions(raw->GetLargestPossibleRegion());
+  shorts->Allocate();
+  itk::ImageRegionConstIterator<RawImType> rit(raw, raw->GetLargestPossibleRegion());
+  itk::ImageRegionIterator<ShortImType> sit(shorts, raw->GetLargestPossibleRegion());
+  for (; !rit.IsAtEnd(); ++rit, ++sit)
+    {
+    sit.Set(static_cast<short>(16 * rit.Get() - 1024));
+    }
+
+  bool ok = checkQuantiles<RawImType>(raw, Thresh->GetOutput(), quantiles, "float");
+  ok = checkQuantiles<ByteImType>(bytes, Thresh->GetOutput(), quantiles, "uchar") && ok;
+  ok = checkQuantiles<ShortImType>(shorts, Thresh->GetOutput(), quantiles, "short") && ok;
+
+  return(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
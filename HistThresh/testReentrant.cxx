@@ -0,0 +1,153 @@
+#include "ioutils.h"
+
+#include "itkLiThresholdImageCalculator.h"
+#include "itkHuangThresholdImageCalculator.h"
+#include "itkIJOtsuThresholdImageCalculator.h"
+#include <itkMultiThreader.h>
+
+#include <algorithm>
+#include <vector>
+
+const unsigned dim = 3;
+typedef itk::Image<float, dim> RawImType;
+typedef RawImType::RegionType RegionType;
+
+const unsigned Threads = 4;
+const unsigned Repeats = 8;
+
+// Bands of the image along its longest axis, and bands twice as wide
+// overlapping them, so that the threads read the same pixels.
+std::vector<RegionType> makeRegions(const RawImType * image)
+{
+  const RegionType whole = image->GetLargestPossibleRegion();
+  unsigned axis = 0;
+  for (unsigned d = 1; d < dim; d++)
+    {
+    if (whole.GetSize(d) > whole.GetSize(axis))
+      {
+      axis = d;
+      }
+    }
+  const unsigned long bands = 8;
+  const unsigned long width = std::max(whole.GetSize(axis) / bands, 1UL);
+
+  std::vector<RegionType> regions;
+  for (unsigned span = 1; span <= 2; span++)
+    {
+    for (unsigned long start = 0; start + span * width <= whole.GetSize(axis); start += width)
+      {
+      RegionType region = whole;
+      region.SetIndex(axis, whole.GetIndex(axis) + start);
+      region.SetSize(axis, span * width);
+      regions.push_back(region);
+      }
+    }
+  regions.push_back(whole);
+  return regions;
+}
+
+// One calculator shared by the threads, each thresholding its share of
+// the regions Repeats times.
+template <class TCalculator>
+struct SharedRun
+{
+  const TCalculator *                                 Calculator;
+  const RawImType *                                   Image;
+  const std::vector<RegionType> *                     Regions;
+  std::vector<typename TCalculator::ResultType>       Results;
+};
+
+template <class TCalculator>
+ITK_THREAD_RETURN_TYPE thresholdRegions(void * arg)
+{
+  itk::MultiThreader::ThreadInfoStruct * info =
+    static_cast<itk::MultiThreader::ThreadInfoStruct *>(arg);
+  SharedRun<TCalculator> * run = static_cast<SharedRun<TCalculator> *>(info->UserData);
+  const unsigned long count = run->Regions->size();
+  for (unsigned r = 0; r < Repeats; r++)
+    {
+    for (unsigned long i = info->ThreadID; i < count; i += info->NumberOfThreads)
+      {
+      run->Results[r * count + i] =
+        run->Calculator->ComputeThreshold(run->Image, (*run->Regions)[i]);
+      }
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+// Threshold the regions with calc from several threads at once, and
+// compare with Compute() run on each region in turn by a calculator
+// with the same settings. The threshold of calc must not change.
+template <class TCalculator>
+bool checkReentrant(const char * name, TCalculator * calc, TCalculator * serial,
+                    const RawImType * image, const std::vector<RegionType> & regions)
+{
+  calc->SetImage(image);
+  calc->Compute();
+  const float before = calc->GetThreshold();
+
+  SharedRun<TCalculator> run;
+  run.Calculator = calc;
+  run.Image = image;
+  run.Regions = &regions;
+  run.Results.resize(Repeats * regions.size());
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads(Threads);
+  threader->SetSingleMethod(thresholdRegions<TCalculator>, &run);
+  threader->SingleMethodExecute();
+
+  serial->SetImage(image);
+  unsigned long mismatches = 0;
+  for (unsigned long i = 0; i < regions.size(); i++)
+    {
+    serial->SetRegion(regions[i]);
+    serial->Compute();
+    for (unsigned r = 0; r < Repeats; r++)
+      {
+      const typename TCalculator::ResultType & result = run.Results[r * regions.size() + i];
+      if (!result.Valid || result.Threshold != serial->GetThreshold())
+        {
+        mismatches++;
+        }
+      }
+    }
+
+  const bool unchanged = calc->GetThreshold() == before;
+  std::cout << name << ": " << regions.size() << " regions on "
+            << threader->GetNumberOfThreads() << " threads, "
+            << mismatches << " mismatches, threshold "
+            << (unchanged ? "unchanged" : "changed") << std::endl;
+  return mismatches == 0 && unchanged;
+}
+
+int main(int argc, char * argv[])
+{
+  RawImType::Pointer raw = readIm<RawImType>(argv[1]);
+  const std::vector<RegionType> regions = makeRegions(raw);
+
+  bool ok = true;
+  {
+  typedef itk::LiThresholdImageCalculator<RawImType> CalculatorType;
+  CalculatorType::Pointer calc = CalculatorType::New(), serial = CalculatorType::New();
+  ok = checkReentrant("Li", calc.GetPointer(), serial.GetPointer(), raw, regions) && ok;
+  }
+  {
+  typedef itk::HuangThresholdImageCalculator<RawImType> CalculatorType;
+  CalculatorType::Pointer calc = CalculatorType::New(), serial = CalculatorType::New();
+  calc->SetNumberOfHistogramBins(4096);
+  calc->UseSparseHistogramOn();
+  serial->SetNumberOfHistogramBins(4096);
+  serial->UseSparseHistogramOn();
+  ok = checkReentrant("Huang, sparse", calc.GetPointer(), serial.GetPointer(), raw, regions) && ok;
+  }
+  {
+  typedef itk::IJOtsuThresholdImageCalculator<RawImType> CalculatorType;
+  CalculatorType::Pointer calc = CalculatorType::New(), serial = CalculatorType::New();
+  calc->UseExactHistogramOn();
+  serial->UseExactHistogramOn();
+  ok = checkReentrant("IJOtsu, exact", calc.GetPointer(), serial.GetPointer(), raw, regions) && ok;
+  }
+
+  return(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,129 @@
+#include "ioutils.h"
+#include "morphutils.h"
+
+#include "itkLiThresholdImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <itkSmartPointer.h>
+namespace itk
+{
+    template <typename T>
+    class Instance : public T::Pointer {
+    public:
+        Instance() : SmartPointer<T>( T::New() ) {}
+    };
+}
+
+template <class TImage>
+unsigned long countMismatches(typename TImage::Pointer a, typename TImage::Pointer b)
+{
+  unsigned long mismatches = 0;
+  itk::ImageRegionConstIterator<TImage> aIt(a, a->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<TImage> bIt(b, a->GetLargestPossibleRegion());
+  for (; !aIt.IsAtEnd(); ++aIt, ++bIt)
+    {
+    if (aIt.Get() != bIt.Get())
+      {
+      mismatches++;
+      }
+    }
+  return mismatches;
+}
+
+// Opening of a binary image with the cross structuring element of the
+// run length masks: the voxels that differ from the centre along at
+// most one axis.
+template <class TImage>
+typename TImage::Pointer doOpeningCross(const typename TImage::Pointer input,
+                                        typename TImage::SizeType rad)
+{
+  typedef typename itk::FlatStructuringElement< TImage::ImageDimension > SRType;
+  SRType kernel;
+  kernel.SetRadius(rad);
+  for (unsigned long i = 0; i < kernel.Size(); i++)
+    {
+    typename SRType::OffsetType offset = kernel.GetOffset(i);
+    unsigned axes = 0;
+    for (unsigned d = 0; d < TImage::ImageDimension; d++)
+      {
+      if (offset[d] != 0)
+        {
+        axes++;
+        }
+      }
+    kernel[i] = axes <= 1;
+    }
+
+  typedef typename itk::GrayscaleMorphologicalOpeningImageFilter<TImage, TImage, SRType> FiltType;
+  typename FiltType::Pointer filt = FiltType::New();
+  filt->SetInput(input);
+  filt->SetKernel(kernel);
+  typename TImage::Pointer result = filt->GetOutput();
+  result->Update();
+  result->DisconnectPipeline();
+  return(result);
+}
+
+// Threshold into a run length mask, check it against the standard
+// output and check the run length erosion, dilation and cross opening
+// against the grayscale filters.
+int main(int argc, char * argv[])
+{
+  const unsigned dim = 3;
+  typedef itk::Image<unsigned char, dim> LabImType;
+  typedef itk::Image<float, dim> RawImType;
+
+  RawImType::Pointer raw = readIm<RawImType>(argv[1]);
+
+  typedef itk::LiThresholdImageFilter<RawImType, LabImType> FilterType;
+  itk::Instance <FilterType> Thresh;
+  Thresh->SetInput(raw);
+  Thresh->SetOutsideValue(0);
+  Thresh->SetInsideValue(1);
+  Thresh->Update();
+  LabImType::Pointer reference = Thresh->GetOutput();
+  reference->DisconnectPipeline();
+
+  itk::Instance <FilterType> RunThresh;
+  RunThresh->SetInput(raw);
+  RunThresh->SetOutsideValue(0);
+  RunThresh->SetInsideValue(1);
+  RunThresh->UseRunLengthOutputOn();
+  RunThresh->Update();
+  typedef FilterType::RunLengthMaskType MaskType;
+  MaskType::Pointer mask = RunThresh->GetRunLengthMask();
+
+  unsigned long mismatches = countMismatches<LabImType>(reference, mask->GetImage());
+
+  MaskType::Pointer eroded = doErodeRLE<MaskType>(mask, 2, 2, 0);
+  mismatches += countMismatches<LabImType>(doErode<LabImType>(reference, 2, 2, 0),
+                                           eroded->GetImage());
+  MaskType::Pointer dilated = doDilateRLE<MaskType>(mask, 2, 2, 0);
+  mismatches += countMismatches<LabImType>(doDilate<LabImType>(reference, 2, 2, 0),
+                                           dilated->GetImage());
+
+  MaskType::Pointer opened = doOpeningRLE<MaskType>(mask, 2, 2, 0, MaskType::Cross);
+  LabImType::SizeType rad;
+  rad[0] = 2;
+  rad[1] = 2;
+  rad[2] = 0;
+  mismatches += countMismatches<LabImType>(doOpeningCross<LabImType>(reference, rad),
+                                           opened->GetImage());
+  writeIm<LabImType>(opened->GetImage(), argv[2]);
+
+  // a cross with a different radius along each axis
+  MaskType::Pointer unequal = doOpeningRLE<MaskType>(mask, 3, 1, 1, MaskType::Cross);
+  rad[0] = 3;
+  rad[1] = 1;
+  rad[2] = 1;
+  mismatches += countMismatches<LabImType>(doOpeningCross<LabImType>(reference, rad),
+                                           unequal->GetImage());
+
+  std::cout << "Li threshold: " << RunThresh->GetThreshold()
+            << " run length mask: " << mask->GetNumberOfRuns() << " runs, "
+            << mask->GetBufferSize() << " bytes, "
+            << mask->GetNumberOfSetPixels() << " inside, "
+            << mismatches << " mismatches" << std::endl;
+
+  return(mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
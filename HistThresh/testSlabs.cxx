@@ -0,0 +1,71 @@
+#include "slabutils.h"
+
+#include "itkLiThresholdImageCalculator.h"
+
+// Run the steps of three slab workers one after the other, as
+// concurrent processes would, and check that the threshold they agree
+// on is that of the whole image.
+int main(int argc, char * argv[])
+{
+  typedef itk::LiThresholdImageCalculator<SlabImageType> CalculatorType;
+
+  SlabOptions opts;
+  opts.Input = argv[1];
+  opts.OutputPattern = argv[2];
+  opts.SharedDir = argv[3];
+  opts.Workers = 3;
+  opts.Bins = 128;
+  opts.Timeout = 10;
+  opts.FixedRange = false;
+  itksys::SystemTools::RemoveADirectory(opts.SharedDir.c_str());
+  itksys::SystemTools::MakeDirectory(opts.SharedDir.c_str());
+
+  std::vector<SlabImageType::Pointer> slabs;
+  for (opts.Worker = 0; opts.Worker < opts.Workers; opts.Worker++)
+    {
+    slabs.push_back(readSlab(opts));
+    if (!slabs.back() || !publishSlabRange(opts, slabs.back()))
+      {
+      return(EXIT_FAILURE);
+      }
+    }
+
+  CalculatorType::Pointer calc = CalculatorType::New();
+  calc->SetNumberOfHistogramBins(opts.Bins);
+  for (opts.Worker = 0; opts.Worker < opts.Workers; opts.Worker++)
+    {
+    float minimum, maximum;
+    if (!agreeSlabRange(opts, minimum, maximum))
+      {
+      return(EXIT_FAILURE);
+      }
+    calc->SetHistogramRange(minimum, maximum);
+    if (!publishSlabHistogram(calc.GetPointer(), opts, slabs[opts.Worker]))
+      {
+      return(EXIT_FAILURE);
+      }
+    }
+
+  opts.Worker = 0;
+  double threshold;
+  if (!reduceSlabHistograms(calc.GetPointer(), opts) ||
+      !readSlabThreshold(opts, threshold))
+    {
+    return(EXIT_FAILURE);
+    }
+  for (opts.Worker = 0; opts.Worker < opts.Workers; opts.Worker++)
+    {
+    writeSlabMask(opts, slabs[opts.Worker], threshold);
+    }
+
+  SlabImageType::Pointer raw = readIm<SlabImageType>(argv[1]);
+  CalculatorType::Pointer single = CalculatorType::New();
+  single->SetNumberOfHistogramBins(opts.Bins);
+  float whole = single->ComputeThreshold(raw, raw->GetLargestPossibleRegion()).Threshold;
+
+  std::cout << "Li threshold, " << opts.Workers << " slabs: " << (float)threshold
+            << " whole image: " << whole << std::endl;
+
+  bool ok = static_cast<float>(threshold) == whole;
+  return(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,117 @@
+#include "ioutils.h"
+
+#include "itkLiThresholdImageFilter.h"
+#include "itkLabelStatisticsImageFilter.h"
+#include "itkStreamingImageFilter.h"
+
+#include <itkSmartPointer.h>
+#include <cmath>
+namespace itk
+{
+    template <typename T>
+    class Instance : public T::Pointer {
+    public:
+        Instance() : SmartPointer<T>( T::New() ) {}
+    };
+}
+
+bool nearlyEqual(double a, double b)
+{
+  return std::fabs(a - b) <= 1e-6 * (1.0 + std::fabs(b));
+}
+
+const unsigned dim = 3;
+typedef itk::Image<unsigned char, dim> LabImType;
+typedef itk::Image<float, dim> RawImType;
+typedef itk::LiThresholdImageFilter<RawImType, LabImType> FilterType;
+
+bool sameStatistics(const FilterType * a, const FilterType * b)
+{
+  return a->GetInsideCount() == b->GetInsideCount()
+    && a->GetOutsideCount() == b->GetOutsideCount()
+    && nearlyEqual(a->GetInsideMean(), b->GetInsideMean())
+    && nearlyEqual(a->GetOutsideMean(), b->GetOutsideMean())
+    && nearlyEqual(a->GetInsideVariance(), b->GetInsideVariance())
+    && nearlyEqual(a->GetOutsideVariance(), b->GetOutsideVariance())
+    && a->GetInsideBoundingBox() == b->GetInsideBoundingBox();
+}
+
+// Gather the class statistics while thresholding and check them
+// against the LabelStatisticsImageFilter run on the mask, then check
+// that writing a mask or streaming the output gives the same ones.
+int main(int argc, char * argv[])
+{
+
+  RawImType::Pointer raw = readIm<RawImType>(argv[1]);
+
+  itk::Instance <FilterType> Thresh;
+  Thresh->SetInput(raw);
+  Thresh->SetOutsideValue(0);
+  Thresh->SetInsideValue(1);
+  Thresh->ComputeStatisticsOn();
+  Thresh->Update();
+  writeIm<LabImType>(Thresh->GetOutput(), argv[2]);
+
+  typedef itk::LabelStatisticsImageFilter<RawImType, LabImType> StatsType;
+  itk::Instance <StatsType> Stats;
+  Stats->SetInput(raw);
+  Stats->SetLabelInput(Thresh->GetOutput());
+  Stats->Update();
+
+  bool ok = Thresh->GetInsideCount() == (unsigned long)Stats->GetCount(1)
+    && Thresh->GetOutsideCount() == (unsigned long)Stats->GetCount(0)
+    && nearlyEqual(Thresh->GetInsideMean(), Stats->GetMean(1))
+    && nearlyEqual(Thresh->GetOutsideMean(), Stats->GetMean(0))
+    && nearlyEqual(Thresh->GetInsideVariance(), Stats->GetVariance(1))
+    && nearlyEqual(Thresh->GetOutsideVariance(), Stats->GetVariance(0))
+    && Thresh->GetInsideBoundingBox() == Stats->GetRegion(1);
+
+  for (unsigned output = 0; output < 2; output++)
+    {
+    itk::Instance <FilterType> MaskThresh;
+    MaskThresh->SetInput(raw);
+    MaskThresh->SetOutsideValue(0);
+    MaskThresh->SetInsideValue(1);
+    MaskThresh->ComputeStatisticsOn();
+    MaskThresh->SetUseBitMaskOutput(output == 0);
+    MaskThresh->SetUseRunLengthOutput(output == 1);
+    MaskThresh->Update();
+    if (!sameStatistics(MaskThresh, Thresh))
+      {
+      std::cout << (output == 0 ? "Bit" : "Run length")
+                << " mask statistics differ" << std::endl;
+      ok = false;
+      }
+    }
+
+  // the statistics are of the whole image even when the output is
+  // requested in pieces
+  itk::Instance <FilterType> StreamedThresh;
+  StreamedThresh->SetInput(raw);
+  StreamedThresh->SetOutsideValue(0);
+  StreamedThresh->SetInsideValue(1);
+  StreamedThresh->ComputeStatisticsOn();
+  typedef itk::StreamingImageFilter<LabImType, LabImType> StreamerType;
+  itk::Instance <StreamerType> Streamer;
+  Streamer->SetInput(StreamedThresh->GetOutput());
+  Streamer->SetNumberOfStreamDivisions(4);
+  Streamer->Update();
+  if (!sameStatistics(StreamedThresh, Thresh))
+    {
+    std::cout << "Streamed statistics differ" << std::endl;
+    ok = false;
+    }
+
+  std::cout << "Li threshold: " << Thresh->GetThreshold()
+            << " inside: " << Thresh->GetInsideCount()
+            << " pixels, volume " << Thresh->GetInsideVolume()
+            << ", mean " << Thresh->GetInsideMean()
+            << ", variance " << Thresh->GetInsideVariance()
+            << " outside: " << Thresh->GetOutsideCount()
+            << " pixels, mean " << Thresh->GetOutsideMean()
+            << ", variance " << Thresh->GetOutsideVariance()
+            << " bounding box: " << Thresh->GetInsideBoundingBox().GetIndex()
+            << " " << Thresh->GetInsideBoundingBox().GetSize() << std::endl;
+
+  return(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
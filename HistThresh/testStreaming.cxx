@@ -0,0 +1,64 @@
+#include "ioutils.h"
+#include "morphutils.h"
+
+#include "itkLiThresholdImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+
+// Open and close a thresholded image with the Lazy helpers, writing
+// the result in pieces, and check it against the same chain of
+// finished images. The threshold kept for the pieces must be computed
+// again once the input changes.
+int main(int argc, char * argv[])
+{
+  const unsigned dim = 3;
+  typedef itk::Image<unsigned char, dim> LabImType;
+  typedef itk::Image<float, dim> RawImType;
+
+  RawImType::Pointer raw = readIm<RawImType>(argv[1]);
+
+  typedef itk::LiThresholdImageFilter<RawImType, LabImType> FilterType;
+  FilterType::Pointer thresh = FilterType::New();
+  thresh->SetInput(raw);
+  thresh->SetOutsideValue(0);
+  thresh->SetInsideValue(1);
+
+  LabImType::Pointer lazy = doOpeningMMLazy<LabImType>(thresh->GetOutput(), 2, 2, 0);
+  lazy = doClosingMMLazy<LabImType>(lazy, 2, 2, 0);
+  streamIm<LabImType>(lazy, argv[2], 4);
+  clearStack();
+
+  LabImType::Pointer finished = thresh->GetOutput();
+  finished->Update();
+  finished->DisconnectPipeline();
+  finished = doOpeningMM<LabImType>(finished, 2, 2, 0);
+  finished = doClosingMM<LabImType>(finished, 2, 2, 0);
+
+  LabImType::Pointer streamed = readIm<LabImType>(argv[2]);
+  unsigned long mismatches = 0;
+  itk::ImageRegionConstIterator<LabImType> fIt(finished, finished->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<LabImType> sIt(streamed, finished->GetLargestPossibleRegion());
+  for (; !fIt.IsAtEnd(); ++fIt, ++sIt)
+    {
+    if (fIt.Get() != sIt.Get())
+      {
+      mismatches++;
+      }
+    }
+
+  const float streamedThreshold = thresh->GetThreshold();
+  itk::ImageRegionIterator<RawImType> rIt(raw, raw->GetLargestPossibleRegion());
+  for (; !rIt.IsAtEnd(); ++rIt)
+    {
+    rIt.Set(2 * rIt.Get() + 1);
+    }
+  raw->Modified();
+  thresh->Update();
+  const bool recomputed = thresh->GetThreshold() != streamedThreshold;
+
+  std::cout << "streamed chain: " << mismatches << " mismatches, threshold "
+            << streamedThreshold << " then " << thresh->GetThreshold()
+            << " on the changed input" << std::endl;
+
+  return(mismatches == 0 && recomputed ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,174 @@
+// Threshold every image of a directory, writing the masks under the
+// same names to another directory.
+//
+//   thresholdBatch inputdir outputdir method [readers computers writers [bins]]
+//
+// Reading, thresholding and writing run in separate thread pools
+// connected by bounded queues. Throughput of each stage is printed at
+// the end.
+
+#include "batchutils.h"
+
+#include "itkHuangThresholdImageFilter.h"
+#include "itkIntermodesThresholdImageFilter.h"
+#include "itkIsoDataThresholdImageFilter.h"
+#include "itkKittlerIllingworthThresholdImageFilter.h"
+#include "itkLiThresholdImageFilter.h"
+#include "itkMaxEntropyThresholdImageFilter.h"
+#include "itkMomentsThresholdImageFilter.h"
+#include "itkRenyiEntropyThresholdImageFilter.h"
+#include "itkShanbhagThresholdImageFilter.h"
+#include "itkTriangleThresholdImageFilter.h"
+#include "itkYenThresholdImageFilter.h"
+#include "itkMeanThresholdImageFilter.h"
+#include "itkIJOtsuThresholdImageFilter.h"
+#include "itkPercentileThresholdImageFilter.h"
+#include "itkIJIsoDataThresholdImageFilter.h"
+
+#include <itkDirectory.h>
+#include <itksys/SystemTools.hxx>
+
+#include <cstdlib>
+#include <algorithm>
+
+const unsigned dim = 3;
+typedef itk::Image<unsigned char, dim> LabImType;
+typedef itk::Image<float, dim> RawImType;
+
+template <class TFilter>
+class ThresholdCompute
+{
+public:
+  ThresholdCompute(unsigned long bins) : m_Bins(bins) {}
+
+  LabImType::Pointer operator()(RawImType::Pointer raw) const
+  {
+    typename TFilter::Pointer Thr = TFilter::New();
+    Thr->SetInput(raw);
+    Thr->SetOutsideValue(1);
+    Thr->SetInsideValue(0);
+    Thr->SetNumberOfHistogramBins(m_Bins);
+    Thr->Update();
+    LabImType::Pointer result = Thr->GetOutput();
+    result->DisconnectPipeline();
+    return result;
+  }
+
+private:
+  unsigned long m_Bins;
+};
+
+template <class TFilter>
+BatchStatistics runBatch(const std::vector<std::string> & inputs,
+                         const std::vector<std::string> & outputs,
+                         const BatchOptions & options, unsigned long bins)
+{
+  ThresholdCompute<TFilter> compute(bins);
+  return batchProcess<RawImType, LabImType>(inputs, outputs, compute, options);
+}
+
+#define thresholdBatchMethod(name)                                       \
+  if (method == #name)                                                   \
+    {                                                                    \
+    stats = runBatch<itk::name##ThresholdImageFilter<RawImType, LabImType> >( \
+      inputs, outputs, options, bins);                                   \
+    found = true;                                                        \
+    }
+
+int main(int argc, char * argv[])
+{
+  if (argc < 4)
+    {
+    std::cerr << "Usage: " << argv[0]
+              << " inputdir outputdir method [readers computers writers [bins]]"
+              << std::endl;
+    return(EXIT_FAILURE);
+    }
+
+  std::string inDir = argv[1];
+  std::string outDir = argv[2];
+  std::string method = argv[3];
+
+  BatchOptions options;
+  if (argc > 6)
+    {
+    options.Readers = atoi(argv[4]);
+    options.Computers = atoi(argv[5]);
+    options.Writers = atoi(argv[6]);
+    }
+  unsigned long bins = 128;
+  if (argc > 7)
+    {
+    bins = atol(argv[7]);
+    }
+
+  // the images are processed in parallel, each one by a single thread
+  itk::MultiThreader::SetGlobalDefaultNumberOfThreads(1);
+
+  // list the readable images
+  itk::Directory::Pointer dir = itk::Directory::New();
+  if (!dir->Load(inDir.c_str()))
+    {
+    std::cerr << "Can't read directory " << inDir << std::endl;
+    return(EXIT_FAILURE);
+    }
+  std::vector<std::string> names;
+  for (unsigned long i = 0; i < dir->GetNumberOfFiles(); i++)
+    {
+    std::string name = dir->GetFile(i);
+    std::string path = inDir + "/" + name;
+    if (itksys::SystemTools::FileIsDirectory(path.c_str()))
+      {
+      continue;
+      }
+    itk::ImageIOBase::Pointer imageIO =
+      itk::ImageIOFactory::CreateImageIO(path.c_str(), itk::ImageIOFactory::ReadMode);
+    if (imageIO.IsNotNull())
+      {
+      names.push_back(name);
+      }
+    }
+  std::sort(names.begin(), names.end());
+
+  itksys::SystemTools::MakeDirectory(outDir.c_str());
+  std::vector<std::string> inputs, outputs;
+  for (unsigned i = 0; i < names.size(); i++)
+    {
+    inputs.push_back(inDir + "/" + names[i]);
+    outputs.push_back(outDir + "/" + names[i]);
+    }
+
+  BatchStatistics stats;
+  bool found = false;
+  thresholdBatchMethod(Huang)
+  thresholdBatchMethod(Intermodes)
+  thresholdBatchMethod(IsoData)
+  thresholdBatchMethod(KittlerIllingworth)
+  thresholdBatchMethod(Li)
+  thresholdBatchMethod(MaxEntropy)
+  thresholdBatchMethod(Moments)
+  thresholdBatchMethod(RenyiEntropy)
+  thresholdBatchMethod(Shanbhag)
+  thresholdBatchMethod(Triangle)
+  thresholdBatchMethod(Yen)
+  thresholdBatchMethod(Mean)
+  thresholdBatchMethod(IJOtsu)
+  thresholdBatchMethod(Percentile)
+  thresholdBatchMethod(IJIsoData)
+  if (!found)
+    {
+    std::cerr << "Unknown method " << method << std::endl;
+    return(EXIT_FAILURE);
+    }
+
+  std::cout << method << " on " << inputs.size() << " images with "
+            << options.Readers << " readers, " << options.Computers
+            << " computers, " << options.Writers << " writers" << std::endl;
+  printBatchStatistics(stats, std::cout);
+
+  if (stats.Read.Failures || stats.Compute.Failures || stats.Write.Failures)
+    {
+    return(EXIT_FAILURE);
+    }
+  return(EXIT_SUCCESS);
+}
@@ -0,0 +1,141 @@
+// Threshold one image, in the pixel type and dimension of the file.
+//
+//   thresholdImage input output method [bins [minimum maximum]]
+//
+// The image is not converted to float on reading: 8 and 16 bit images
+// take a half to a quarter of the memory, and are histogrammed through
+// a table of the bin of each value. The mask is written with 1 above the
+// threshold and 0 below it, as by the test programs.
+//
+// Uncompressed MetaImage and raw NRRD files are mapped in memory rather
+// than read, when their pixels can be used as they are (see
+// mappedio.h). The pixels are then read from the file by each pass over
+// the image: the histogram range, the histogram and the mask. Giving
+// the histogram range saves the first of them.
+
+#include "mappedio.h"
+
+#include "itkHuangThresholdImageFilter.h"
+#include "itkIntermodesThresholdImageFilter.h"
+#include "itkIsoDataThresholdImageFilter.h"
+#include "itkKittlerIllingworthThresholdImageFilter.h"
+#include "itkLiThresholdImageFilter.h"
+#include "itkMaxEntropyThresholdImageFilter.h"
+#include "itkMomentsThresholdImageFilter.h"
+#include "itkRenyiEntropyThresholdImageFilter.h"
+#include "itkShanbhagThresholdImageFilter.h"
+#include "itkTriangleThresholdImageFilter.h"
+#include "itkYenThresholdImageFilter.h"
+#include "itkMeanThresholdImageFilter.h"
+#include "itkIJOtsuThresholdImageFilter.h"
+#include "itkPercentileThresholdImageFilter.h"
+#include "itkIJIsoDataThresholdImageFilter.h"
+
+#include <cstdlib>
+
+#define thresholdImageMethod(name)                                       \
+  if (m_Method == #name)                                                 \
+    {                                                                    \
+    return this->Threshold<itk::name##ThresholdImageFilter<TImage, MaskType> >(raw); \
+    }
+
+class ThresholdImage
+{
+public:
+  ThresholdImage(std::string output, std::string method, unsigned long bins) :
+    m_Output(output), m_Method(method), m_Bins(bins), m_FixedRange(false),
+    m_Minimum(0), m_Maximum(0) {}
+
+  void SetHistogramRange(double minimum, double maximum)
+  {
+    m_FixedRange = true;
+    m_Minimum = minimum;
+    m_Maximum = maximum;
+  }
+
+  template <class TImage>
+  int Run(std::string filename)
+  {
+    typedef itk::Image<unsigned char, TImage::ImageDimension> MaskType;
+    typename TImage::Pointer raw = readImMapped<TImage>(filename);
+    if (!raw)
+      {
+      return(EXIT_FAILURE);
+      }
+
+    thresholdImageMethod(Huang)
+    thresholdImageMethod(Intermodes)
+    thresholdImageMethod(IsoData)
+    thresholdImageMethod(KittlerIllingworth)
+    thresholdImageMethod(Li)
+    thresholdImageMethod(MaxEntropy)
+    thresholdImageMethod(Moments)
+    thresholdImageMethod(RenyiEntropy)
+    thresholdImageMethod(Shanbhag)
+    thresholdImageMethod(Triangle)
+    thresholdImageMethod(Yen)
+    thresholdImageMethod(Mean)
+    thresholdImageMethod(IJOtsu)
+    thresholdImageMethod(Percentile)
+    thresholdImageMethod(IJIsoData)
+
+    std::cerr << "Unknown method " << m_Method << std::endl;
+    return(EXIT_FAILURE);
+  }
+
+private:
+  template <class TFilter>
+  int Threshold(typename TFilter::InputImageType::Pointer raw)
+  {
+    typedef typename TFilter::InputPixelType PixelType;
+    typename TFilter::Pointer Thr = TFilter::New();
+    Thr->SetInput(raw);
+    Thr->SetOutsideValue(1);
+    Thr->SetInsideValue(0);
+    Thr->SetNumberOfHistogramBins(m_Bins);
+    if (m_FixedRange)
+      {
+      Thr->SetHistogramRange(static_cast<PixelType>(m_Minimum),
+                             static_cast<PixelType>(m_Maximum));
+      }
+    writeIm<typename TFilter::OutputImageType>(Thr->GetOutput(), m_Output);
+    std::cout << m_Method << " threshold of the "
+              << (unsigned)TFilter::InputImageType::ImageDimension << "D image of "
+              << 8 * sizeof(PixelType) << " bit pixels: "
+              << static_cast<typename itk::NumericTraits<PixelType>::PrintType>(Thr->GetThreshold())
+              << std::endl;
+    return(EXIT_SUCCESS);
+  }
+
+  std::string   m_Output;
+  std::string   m_Method;
+  unsigned long m_Bins;
+  bool          m_FixedRange;
+  double        m_Minimum;
+  double        m_Maximum;
+};
+
+int main(int argc, char * argv[])
+{
+  if (argc < 4)
+    {
+    std::cerr << "Usage: " << argv[0]
+              << " input output method [bins [minimum maximum]]" << std::endl;
+    return(EXIT_FAILURE);
+    }
+
+  ThresholdImage processor(argv[2], argv[3], argc > 4 ? atol(argv[4]) : 128);
+  if (argc > 6)
+    {
+    processor.SetHistogramRange(atof(argv[5]), atof(argv[6]));
+    }
+  try
+    {
+    return dispatchImage(argv[1], processor);
+    }
+  catch(itk::ExceptionObject &ex)
+    {
+    std::cout << ex << std::endl;
+    return(EXIT_FAILURE);
+    }
+}
@@ -0,0 +1,111 @@
+// Threshold a large volume with several processes, each handling a
+// slab along the last axis. Run one process per slab, on any hosts
+// sharing a directory:
+//
+//   thresholdSlabs input output-pattern shareddir method workers worker [bins [timeout [minimum maximum]]]
+//
+// e.g. "thresholdSlabs big.mha mask-%02d.mha /shared/run12 Li 8 3".
+// Every worker saves the intensity range of its slab in the shared
+// directory, and histograms its slab on the union of the ranges, so
+// that all the histograms share the same bins and merge without loss.
+// Worker 0 merges the histograms, computes the threshold of the whole
+// volume and saves it there too, after which every worker binarizes
+// its slab and writes it to output-pattern formatted with its worker
+// number. If no threshold is found, every worker exits with an error
+// instead. Files are published by renaming, so a partially written file
+// is never picked up. Use a new shared directory for each run. When
+// the intensity range of the volume is known, e.g. -1024 3071 for CT,
+// giving it saves every worker a pass over its slab and the wait for
+// the ranges of the others.
+
+#include "slabutils.h"
+
+#include "itkHuangThresholdImageCalculator.h"
+#include "itkIntermodesThresholdImageCalculator.h"
+#include "itkIsoDataThresholdImageCalculator.h"
+#include "itkKittlerIllingworthThresholdImageCalculator.h"
+#include "itkLiThresholdImageCalculator.h"
+#include "itkMaxEntropyThresholdImageCalculator.h"
+#include "itkMomentsThresholdImageCalculator.h"
+#include "itkRenyiEntropyThresholdImageCalculator.h"
+#include "itkShanbhagThresholdImageCalculator.h"
+#include "itkTriangleThresholdImageCalculator.h"
+#include "itkYenThresholdImageCalculator.h"
+#include "itkMeanThresholdImageCalculator.h"
+#include "itkIJOtsuThresholdImageCalculator.h"
+#include "itkPercentileThresholdImageCalculator.h"
+#include "itkIJIsoDataThresholdImageCalculator.h"
+
+#include <cstdlib>
+
+#define thresholdSlabsMethod(name)                                       \
+  if (method == #name)                                                   \
+    {                                                                    \
+    itk::name##ThresholdImageCalculator<SlabImageType>::Pointer calc =   \
+      itk::name##ThresholdImageCalculator<SlabImageType>::New();         \
+    calc->SetNumberOfHistogramBins(opts.Bins);                           \
+    return runSlabWorker(calc.GetPointer(), opts);                       \
+    }
+
+int main(int argc, char * argv[])
+{
+  if (argc < 7)
+    {
+    std::cerr << "Usage: " << argv[0]
+              << " input output-pattern shareddir method workers worker [bins [timeout [minimum maximum]]]"
+              << std::endl;
+    return(EXIT_FAILURE);
+    }
+
+  SlabOptions opts;
+  opts.Input = argv[1];
+  opts.OutputPattern = argv[2];
+  opts.SharedDir = argv[3];
+  std::string method = argv[4];
+  opts.Workers = atoi(argv[5]);
+  opts.Worker = atoi(argv[6]);
+  opts.Bins = argc > 7 ? atol(argv[7]) : 128;
+  opts.Timeout = argc > 8 ? atof(argv[8]) : 3600;
+  opts.FixedRange = argc > 10;
+  opts.Minimum = opts.FixedRange ? atof(argv[9]) : 0;
+  opts.Maximum = opts.FixedRange ? atof(argv[10]) : 0;
+
+  if (opts.Workers < 1 || opts.Worker >= opts.Workers)
+    {
+    std::cerr << "Worker must be between 0 and workers - 1" << std::endl;
+    return(EXIT_FAILURE);
+    }
+  if (opts.FixedRange && opts.Minimum >= opts.Maximum)
+    {
+    std::cerr << "Minimum must be below maximum" << std::endl;
+    return(EXIT_FAILURE);
+    }
+  itksys::SystemTools::MakeDirectory(opts.SharedDir.c_str());
+
+  try
+    {
+    thresholdSlabsMethod(Huang)
+    thresholdSlabsMethod(Intermodes)
+    thresholdSlabsMethod(IsoData)
+    thresholdSlabsMethod(KittlerIllingworth)
+    thresholdSlabsMethod(Li)
+    thresholdSlabsMethod(MaxEntropy)
+    thresholdSlabsMethod(Moments)
+    thresholdSlabsMethod(RenyiEntropy)
+    thresholdSlabsMethod(Shanbhag)
+    thresholdSlabsMethod(Triangle)
+    thresholdSlabsMethod(Yen)
+    thresholdSlabsMethod(Mean)
+    thresholdSlabsMethod(IJOtsu)
+    thresholdSlabsMethod(Percentile)
+    thresholdSlabsMethod(IJIsoData)
+    }
+  catch(itk::ExceptionObject &ex)
+    {
+    std::cout << ex << std::endl;
+    return(EXIT_FAILURE);
+    }
+
+  std::cerr << "Unknown method " << method << std::endl;
+  return(EXIT_FAILURE);
+}